@@ -14,8 +14,6 @@
 #include <thread>
 
 #include "lmrtp/i_rtp_packetizer.h"
-#include "lmrtsp/media_stream.h"
-#include "lmrtsp/rtsp_session.h"
 #include "rtsp_server.h"
 
 using namespace lmshao::lmrtsp;
@@ -60,6 +58,9 @@ int main(int argc, char *argv[])
 
     std::cout << "Initializing RTSP server, listening address: " << ip << ":" << port << std::endl;
 
+    // Handle RTSP requests on one reactor thread per core
+    g_server->SetReactorCount(std::thread::hardware_concurrency());
+
     // Initialize server
     if (!g_server->Init(ip, port)) {
         std::cerr << "RTSP server initialization failed" << std::endl;
@@ -81,26 +82,21 @@ int main(int argc, char *argv[])
                                                              __FUNCTION__, "RTSP server started successfully");
     std::cout << "RTSP server is running, press Ctrl+C to stop server" << std::endl;
 
-    // Main loop to push media data
+    // Register the stream that the main loop publishes
+    auto stream_info = std::make_shared<MediaStreamInfo>();
+    stream_info->stream_path = "/live";
+    stream_info->media_type = "video";
+    stream_info->codec = "H264";
+    g_server->AddMediaStream(stream_info->stream_path, stream_info);
+
+    // Main loop to push media data, delivered to every session playing the stream
     uint32_t timestamp = 0;
     while (true) {
-        auto sessions = g_server->GetSessions();
-        for (auto &session_pair : sessions) {
-            auto session = session_pair.second;
-            const auto &media_streams = session->GetMediaStreams();
-            for (const auto &stream : media_streams) {
-                if (stream->GetState() == StreamState::PLAYING) {
-                    auto rtp_stream = std::dynamic_pointer_cast<RTPStream>(stream);
-                    if (rtp_stream) {
-                        MediaFrame frame;
-                        frame.data.assign(1024, 0xAB);
-                        frame.timestamp = timestamp;
-                        frame.marker = false;
-                        rtp_stream->PushFrame(std::move(frame));
-                    }
-                }
-            }
-        }
+        lmshao::lmrtp::MediaFrame frame;
+        frame.data.assign(1024, 0xAB);
+        frame.timestamp = timestamp;
+        frame.marker = false;
+        g_server->PushFrame(stream_info->stream_path, std::move(frame));
 
         timestamp += 3600; // For 90kHz clock rate, 40ms frame duration
         std::this_thread::sleep_for(std::chrono::milliseconds(40));
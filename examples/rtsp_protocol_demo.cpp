@@ -82,6 +82,11 @@ public:
         return false;
     }
 
+    void OnKeyframeRequested(const std::string &stream_path, const std::string &client_ip) override
+    {
+        std::cout << "[INFO] Keyframe requested by " << client_ip << " for " << stream_path << std::endl;
+    }
+
     void OnError(const std::string &client_ip, int error_code, const std::string &error_message) override
     {
         std::cout << "[ERROR] Error from " << client_ip << " (Code: " << error_code << "): " << error_message
@@ -0,0 +1,88 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTP_FEC_ENCODER_H
+#define LMSHAO_LMRTP_FEC_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace lmshao::lmrtp {
+
+enum class FecScheme {
+    FLEXFEC, // RFC 8627, flexible mask
+    ULPFEC   // RFC 5109, single protection level
+};
+
+struct FecConfig {
+    FecScheme scheme = FecScheme::FLEXFEC;
+    uint8_t payload_type = 0;
+    uint32_t ssrc = 0;    // SSRC of the FEC stream
+    uint8_t columns = 10; // L: consecutive packets covered by one row parity packet
+    uint8_t rows = 1;     // D: rows per block, values above 1 add one column parity packet per column
+};
+
+// XOR parity generator over an L x D block of source packets.
+// Parity is accumulated as packets are added, so source packets are never copied or retained. Every row and column
+// owns one packet buffer allocated up front; FEC packets are built in place and never allocate.
+class FecEncoder {
+public:
+    static constexpr size_t kMaxPacketSize = 1500;
+
+    // Receives a finished FEC packet. The bytes stay valid until the next AddPacket() or Reset().
+    using PacketSink = std::function<void(const uint8_t *data, size_t size)>;
+
+    explicit FecEncoder(const FecConfig &config);
+    ~FecEncoder() = default;
+
+    // Add a serialized source RTP packet in send order.
+    // The FEC packets completed by this packet are handed to sink, ready to be sent after it. Returns their number.
+    size_t AddPacket(const uint8_t *packet, size_t size, const PacketSink &sink);
+
+    // Drop the partially protected block, e.g. after a sequence number discontinuity.
+    void Reset();
+
+    const FecConfig &GetConfig() const { return config_; }
+
+private:
+    struct Parity {
+        uint16_t base = 0;      // Sequence number of the first protected packet
+        uint8_t count = 0;      // Number of protected packets
+        uint8_t stride = 1;     // Sequence number distance between protected packets
+        uint8_t header[2] = {}; // XOR of the first two RTP header octets
+        uint16_t length = 0;    // XOR of the protected lengths
+        uint32_t timestamp = 0; // XOR of the RTP timestamps
+        uint32_t last_timestamp = 0;
+        size_t size = 0; // Longest protected length
+        // Headers are written right before the payload, which starts at kHeaderRoom
+        std::vector<uint8_t> buffer;
+    };
+
+    // RTP header with one CSRC plus the longest FEC header
+    static constexpr size_t kHeaderRoom = 12 + 4 + 24;
+
+    void Accumulate(Parity &parity, const uint8_t *packet, size_t size);
+    // Builds the FEC packet inside parity.buffer and returns where it starts
+    const uint8_t *Finish(Parity &parity, size_t &size);
+    size_t WriteFlexFecHeader(const Parity &parity, uint8_t *out) const;
+    size_t WriteUlpFecHeader(const Parity &parity, uint8_t *out) const;
+
+    FecConfig config_;
+    Parity row_;
+    std::vector<Parity> columns_;
+    size_t index_ = 0;          // Position of the next packet within the block
+    uint16_t sequence_ = 0;     // Sequence number of the next FEC packet
+    uint16_t nextSequence_ = 0; // Expected sequence number of the next source packet
+    uint32_t mediaSsrc_ = 0;
+};
+
+} // namespace lmshao::lmrtp
+
+#endif // LMSHAO_LMRTP_FEC_ENCODER_H
@@ -0,0 +1,158 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTP_RTCP_PACKET_H
+#define LMSHAO_LMRTP_RTCP_PACKET_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lmshao::lmrtp {
+
+// RTCP packet types, see RFC 3550 section 12.1
+enum class RtcpPacketType : uint8_t {
+    SR = 200,
+    RR = 201,
+    SDES = 202,
+    BYE = 203,
+    APP = 204,
+    RTPFB = 205, // Transport layer feedback, RFC 4585
+    PSFB = 206,  // Payload-specific feedback, RFC 4585
+};
+
+// Feedback message types carried in the count field of RTPFB and PSFB packets
+constexpr uint8_t kRtcpFmtGenericNack = 1;
+constexpr uint8_t kRtcpFmtPli = 1; // Picture Loss Indication, RFC 4585 section 6.3.1
+constexpr uint8_t kRtcpFmtFir = 4; // Full Intra Request, RFC 5104 section 4.3.1
+
+// RC is a 5-bit field, so a single SR/RR carries at most 31 report blocks
+constexpr size_t kRtcpMaxReportBlocks = 31;
+
+// Sender information carried by an SR packet.
+struct RtcpSenderInfo {
+    uint32_t ntp_msw = 0;
+    uint32_t ntp_lsw = 0;
+    uint32_t rtp_timestamp = 0;
+    uint32_t packet_count = 0;
+    uint32_t octet_count = 0;
+};
+
+// Reception report block carried by SR and RR packets.
+struct RtcpReportBlock {
+    uint32_t ssrc = 0;                 // SSRC of the source this block reports on
+    uint8_t fraction_lost = 0;         // Fraction lost since the previous report, in 1/256
+    int32_t cumulative_lost = 0;       // Signed 24-bit cumulative number of packets lost
+    uint32_t extended_highest_seq = 0; // Extended highest sequence number received
+    uint32_t jitter = 0;               // Interarrival jitter in RTP timestamp units
+    uint32_t lsr = 0;                  // Middle 32 bits of the NTP timestamp of the last SR
+    uint32_t dlsr = 0;                 // Delay since last SR, in 1/65536 seconds
+};
+
+// Parsed SR or RR packet. Report blocks are stored inline so parsing never allocates.
+struct RtcpReport {
+    uint32_t ssrc = 0; // SSRC of the packet sender
+    bool has_sender_info = false;
+    RtcpSenderInfo sender_info;
+    uint8_t report_count = 0;
+    RtcpReportBlock report_blocks[kRtcpMaxReportBlocks];
+};
+
+// One generic NACK FCI entry, RFC 4585 section 6.2.1
+struct RtcpNack {
+    uint32_t sender_ssrc = 0;
+    uint32_t media_ssrc = 0;
+    uint16_t pid = 0; // Sequence number of the first lost packet
+    uint16_t blp = 0; // Bitmask of lost packets among the 16 following pid
+};
+
+// Listener for the individual packets found in a compound RTCP packet.
+// All pointers passed to the callbacks are only valid for the duration of the call.
+class IRtcpListener {
+public:
+    virtual ~IRtcpListener() = default;
+
+    virtual void OnSenderReport(const RtcpReport &report) {}
+    virtual void OnReceiverReport(const RtcpReport &report) {}
+    virtual void OnSourceDescription(uint32_t ssrc, const char *cname, size_t cname_length) {}
+    virtual void OnBye(uint32_t ssrc) {}
+    virtual void OnNack(const RtcpNack &nack) {}
+    virtual void OnPictureLoss(uint32_t sender_ssrc, uint32_t media_ssrc) {}
+    virtual void OnFullIntraRequest(uint32_t sender_ssrc, uint32_t media_ssrc, uint8_t sequence) {}
+};
+
+// One packet of a compound RTCP packet. body points into the parsed buffer, with padding already removed.
+struct RtcpPacketView {
+    uint8_t packet_type = 0;
+    uint8_t count = 0; // RC, SC or FMT depending on the packet type
+    const uint8_t *body = nullptr;
+    size_t body_size = 0;
+};
+
+// Walks the packets of a compound RTCP packet in place, without copying or allocating.
+class RtcpCompoundReader {
+public:
+    RtcpCompoundReader(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+    // Move to the next packet. Returns false at the end of the buffer or on a malformed packet.
+    bool Next(RtcpPacketView &packet);
+
+    // True once Next() stopped on a malformed packet rather than the end of the buffer.
+    bool Error() const { return error_; }
+
+private:
+    const uint8_t *data_;
+    size_t size_;
+    size_t offset_ = 0;
+    bool error_ = false;
+};
+
+// Writes a compound RTCP packet into a caller-provided buffer.
+// Every Add method returns false and leaves the buffer unchanged if the packet does not fit.
+class RtcpBuilder {
+public:
+    RtcpBuilder(uint8_t *buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+    bool AddSenderReport(uint32_t ssrc, const RtcpSenderInfo &info, const RtcpReportBlock *blocks = nullptr,
+                         size_t block_count = 0);
+    bool AddReceiverReport(uint32_t ssrc, const RtcpReportBlock *blocks, size_t block_count);
+    bool AddSourceDescription(uint32_t ssrc, const char *cname, size_t cname_length);
+    bool AddBye(uint32_t ssrc);
+
+    const uint8_t *Data() const { return buffer_; }
+    size_t Size() const { return size_; }
+
+private:
+    uint8_t *Begin(uint8_t count, RtcpPacketType type, size_t packet_size);
+
+    uint8_t *buffer_;
+    size_t capacity_;
+    size_t size_ = 0;
+};
+
+class RtcpParser {
+public:
+    // Walk a compound RTCP packet and dispatch every recognised packet to the listener.
+    // Returns false if the compound packet is malformed; packets before the error have already been dispatched.
+    static bool Parse(const uint8_t *data, size_t size, IRtcpListener *listener);
+
+    // Returns true if the buffer looks like RTCP rather than RTP (RFC 5761 section 4).
+    static bool IsRtcp(const uint8_t *data, size_t size);
+};
+
+// Current wall-clock time as a 64-bit NTP timestamp (32.32 fixed point).
+uint64_t NtpNow();
+
+// Middle 32 bits of an NTP timestamp, the format used by the LSR and DLSR fields.
+inline uint32_t NtpToCompact(uint64_t ntp)
+{
+    return static_cast<uint32_t>(ntp >> 16);
+}
+
+} // namespace lmshao::lmrtp
+
+#endif // LMSHAO_LMRTP_RTCP_PACKET_H
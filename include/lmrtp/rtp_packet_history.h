@@ -0,0 +1,58 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTP_RTP_PACKET_HISTORY_H
+#define LMSHAO_LMRTP_RTP_PACKET_HISTORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace lmshao::lmrtp {
+
+// Fixed-size ring of recently sent RTP packets, indexed by sequence number, used to answer NACKs.
+// All storage is allocated up front; storing and fetching packets never allocates.
+class RtpPacketHistory {
+public:
+    static constexpr size_t kMaxPacketSize = 1500;
+
+    RtpPacketHistory(uint32_t bitrate, uint32_t history_ms);
+    ~RtpPacketHistory() = default;
+
+    // Number of packets needed to hold history_ms of media at bitrate (bits per second)
+    static size_t CapacityFor(uint32_t bitrate, uint32_t history_ms);
+
+    // Record a serialized RTP packet as sent at now_ms. Packets larger than kMaxPacketSize are not kept.
+    void Put(const uint8_t *packet, size_t size, uint64_t now_ms);
+
+    // Copy the packet with sequence number seq into out, which must hold kMaxPacketSize bytes.
+    // Returns 0 if the packet has left the history window or was already resent within min_interval_ms.
+    size_t GetForResend(uint16_t seq, uint64_t now_ms, uint32_t min_interval_ms, uint8_t *out);
+
+    size_t Capacity() const { return entries_.size(); }
+
+private:
+    struct Entry {
+        uint64_t send_time_ms = 0;
+        uint64_t resend_time_ms = 0;
+        uint16_t seq = 0;
+        uint16_t size = 0;
+        bool valid = false;
+    };
+
+    std::mutex mutex_;
+    uint32_t history_ms_;
+    size_t mask_;
+    std::vector<Entry> entries_;
+    std::vector<uint8_t> storage_;
+};
+
+} // namespace lmshao::lmrtp
+
+#endif // LMSHAO_LMRTP_RTP_PACKET_HISTORY_H
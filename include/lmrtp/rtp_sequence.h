@@ -0,0 +1,102 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTP_RTP_SEQUENCE_H
+#define LMSHAO_LMRTP_RTP_SEQUENCE_H
+
+#include <cstdint>
+
+namespace lmshao::lmrtp {
+
+// True if sequence number a comes after b, allowing for wraparound.
+inline bool IsNewerSequence(uint16_t a, uint16_t b)
+{
+    return a != b && static_cast<uint16_t>(a - b) < 0x8000;
+}
+
+// True if RTP timestamp a comes after b, allowing for wraparound.
+inline bool IsNewerTimestamp(uint32_t a, uint32_t b)
+{
+    return a != b && static_cast<uint32_t>(a - b) < 0x80000000U;
+}
+
+// Signed distance from b to a, e.g. SequenceDelta(2, 65534) == 4.
+inline int16_t SequenceDelta(uint16_t a, uint16_t b)
+{
+    return static_cast<int16_t>(static_cast<uint16_t>(a - b));
+}
+
+// RTP timestamp elapsed_us after a packet stamped timestamp was sent, e.g. for the SR of RFC 3550 section 6.4.1.
+inline uint32_t ExtrapolateTimestamp(uint32_t timestamp, uint64_t elapsed_us, uint32_t clock_rate)
+{
+    uint64_t ticks = elapsed_us / 1000000 * clock_rate + elapsed_us % 1000000 * clock_rate / 1000000;
+    return timestamp + static_cast<uint32_t>(ticks);
+}
+
+// Extends 16-bit sequence numbers with a cycle count, RFC 3550 appendix A.1.
+class SequenceUnwrapper {
+public:
+    // Extended sequence number of seq. Late packets from before a wrap map to the previous cycle.
+    uint32_t Unwrap(uint16_t seq)
+    {
+        if (!initialized_) {
+            initialized_ = true;
+            highest_ = seq;
+            return seq;
+        }
+        if (IsNewerSequence(seq, highest_)) {
+            if (seq < highest_) {
+                cycles_ += 0x10000;
+            }
+            highest_ = seq;
+            return cycles_ | seq;
+        }
+        if (seq > highest_ && cycles_ != 0) {
+            return (cycles_ - 0x10000) | seq;
+        }
+        return cycles_ | seq;
+    }
+
+    // Extended highest sequence number seen so far, as reported in RTCP report blocks.
+    uint32_t ExtendedHighest() const { return cycles_ | highest_; }
+
+private:
+    bool initialized_ = false;
+    uint16_t highest_ = 0;
+    uint32_t cycles_ = 0;
+};
+
+// Interarrival jitter estimate, RFC 3550 section 6.4.1 and appendix A.8.
+class JitterEstimator {
+public:
+    // arrival is the packet's arrival time converted to the RTP clock of the stream.
+    void Update(uint32_t rtp_timestamp, uint32_t arrival)
+    {
+        int32_t transit = static_cast<int32_t>(arrival - rtp_timestamp);
+        if (hasTransit_) {
+            int32_t d = transit - transit_;
+            uint32_t delta = static_cast<uint32_t>(d < 0 ? -d : d);
+            // Kept scaled by 16 so the 1/16 gain does not lose precision
+            jitter_ += delta - ((jitter_ + 8) >> 4);
+        }
+        transit_ = transit;
+        hasTransit_ = true;
+    }
+
+    // Jitter in RTP timestamp units, as reported in RTCP report blocks.
+    uint32_t Jitter() const { return jitter_ >> 4; }
+
+private:
+    bool hasTransit_ = false;
+    int32_t transit_ = 0;
+    uint32_t jitter_ = 0;
+};
+
+} // namespace lmshao::lmrtp
+
+#endif // LMSHAO_LMRTP_RTP_SEQUENCE_H
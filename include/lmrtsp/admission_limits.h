@@ -0,0 +1,28 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_ADMISSION_LIMITS_H
+#define LMSHAO_LMRTSP_ADMISSION_LIMITS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lmshao::lmrtsp {
+
+// Load limits of the server, 0 disables a limit. Refused requests are answered 503 with Retry-After.
+struct AdmissionLimits {
+    size_t max_connections = 0;          // Concurrent control connections
+    uint32_t max_accepts_per_second = 0; // New connections, bursts of up to one second's worth
+    size_t max_sessions_per_client = 0;  // RTSP sessions of one client IP
+    size_t max_playing_per_stream = 0;   // Sessions playing one stream
+    uint32_t retry_after_seconds = 5;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_ADMISSION_LIMITS_H
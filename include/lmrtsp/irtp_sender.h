@@ -12,6 +12,7 @@ struct RTPStatistics {
     uint64_t packets_sent = 0;
     uint64_t bytes_sent = 0;
     uint64_t packets_lost = 0;
+    uint64_t packets_retransmitted = 0;
     uint32_t jitter = 0;
     uint32_t rtt = 0;
     double loss_rate = 0.0;
@@ -31,6 +32,9 @@ struct RTPTransportParams {
     std::string multicast_ip;
     uint8_t ttl = 64;
     uint32_t ssrc = 0;
+    bool interleaved = false; // RTP/AVP/TCP over the RTSP connection
+    uint8_t rtp_channel = 0;
+    uint8_t rtcp_channel = 1;
 };
 
 class IRTPSender {
@@ -9,15 +9,20 @@
 #ifndef LMSHAO_LMRTSP_IRTSP_SERVER_CALLBACK_H
 #define LMSHAO_LMRTSP_IRTSP_SERVER_CALLBACK_H
 
+#include <memory>
 #include <string>
 
+#include "rtsp_continuation.h"
+#include "rtsp_headers.h"
+
 namespace lmshao::lmrtsp {
 
 /**
  * @brief RTSP server callback interface
  *
  * This interface defines callback methods for RTSP server to notify
- * upper layer applications about various events.
+ * upper layer applications about various events. Events run on the network
+ * thread unless RTSPServer::SetCallbackExecutor() moves them to an executor.
  */
 class IRTSPServerCallback {
 public:
@@ -43,6 +48,23 @@ public:
      */
     virtual void OnStreamRequested(const std::string &stream_path, const std::string &client_ip) = 0;
 
+    /**
+     * @brief Offer to finish a DESCRIBE or SETUP request later
+     * @param method RTSPMethod::DESCRIBE or RTSPMethod::SETUP
+     * @param uri Request URI
+     * @param client_ip Client IP address
+     * @param continuation Resumes or rejects the request from any thread
+     * @return true to keep the continuation and answer later, false to process the request right away
+     *
+     * Always called on the network thread, so it should only hand the continuation over to the
+     * application's own work, e.g. starting an encoder before resuming a DESCRIBE.
+     */
+    virtual bool OnRequestDeferred(RTSPMethod method, const std::string &uri, const std::string &client_ip,
+                                   std::shared_ptr<RTSPContinuation> continuation)
+    {
+        return false;
+    }
+
     /**
      * @brief SETUP request event
      * @param client_ip Client IP address
@@ -88,6 +110,28 @@ public:
         return true; // Default allow all connections
     }
 
+    /**
+     * @brief Keyframe request event (RTCP PLI or FIR from a client)
+     * @param stream_path Stream path that needs a new keyframe
+     * @param client_ip Address of the client whose request got through
+     *
+     * Requests for the same stream are coalesced, see RTSPServer::SetKeyframeRequestInterval().
+     */
+    virtual void OnKeyframeRequested(const std::string &stream_path, const std::string &client_ip)
+    {
+        // Default empty implementation
+    }
+
+    /**
+     * @brief Session expired after receiving neither RTSP requests nor RTCP reports for its timeout
+     * @param client_ip Client IP address
+     * @param session_id Session ID
+     */
+    virtual void OnSessionExpired(const std::string &client_ip, const std::string &session_id)
+    {
+        // Default empty implementation
+    }
+
     /**
      * @brief Error event
      * @param client_ip Client IP address
@@ -20,8 +20,13 @@
 #include <queue>
 #include <string>
 #include <thread>
+#include <vector>
 
+#include "irtp_sender.h"
+#include "lmrtp/fec_encoder.h"
 #include "lmrtp/i_rtp_packetizer.h"
+#include "lmrtp/rtcp_packet.h"
+#include "lmrtp/rtp_packet_history.h"
 
 using namespace lmshao::lmnet;
 using namespace lmshao::lmcore;
@@ -30,6 +35,7 @@ using namespace lmshao::lmrtp;
 namespace lmshao::lmrtsp {
 
 class RTSPSession;
+class RTCPReceiverStats;
 
 // Media stream state enumeration
 enum class StreamState {
@@ -60,6 +66,14 @@ public:
 
     // Transport information
     virtual std::string GetTransportInfo() const = 0;
+    virtual uint16_t GetServerRtpPort() const = 0;
+    virtual uint16_t GetServerRtcpPort() const = 0;
+
+    // Statistics
+    virtual RTPStatistics GetStatistics() const = 0;
+
+    // Queue a frame for sending; the frame may be shared with other streams
+    virtual void PushFrame(std::shared_ptr<const MediaFrame> frame) = 0;
 
     void SetSession(std::weak_ptr<RTSPSession> session);
     void SetTrackIndex(int index);
@@ -73,7 +87,10 @@ protected:
 };
 
 // RTP stream implementation
-class RTPStream : public MediaStream, public IServerListener, public std::enable_shared_from_this<RTPStream> {
+class RTPStream : public MediaStream,
+                  public IServerListener,
+                  public IRtcpListener,
+                  public std::enable_shared_from_this<RTPStream> {
 public:
     RTPStream(const std::string &uri, const std::string &mediaType);
     ~RTPStream() override;
@@ -85,8 +102,12 @@ public:
 
     std::string GetRtpInfo() const override;
     std::string GetTransportInfo() const override;
+    uint16_t GetServerRtpPort() const override { return serverRtpPort_; }
+    uint16_t GetServerRtcpPort() const override { return serverRtcpPort_; }
+    RTPStatistics GetStatistics() const override;
 
     void PushFrame(MediaFrame &&frame);
+    void PushFrame(std::shared_ptr<const MediaFrame> frame) override;
 
     uint16_t GetClientRtpPort() const { return clientRtpPort_; }
     uint16_t GetClientRtcpPort() const { return clientRtcpPort_; }
@@ -97,8 +118,21 @@ public:
     void OnClose(std::shared_ptr<Session> session) override;
     void OnError(std::shared_ptr<Session> session, const std::string &error) override;
 
+    // IRtcpListener implementation
+    void OnSenderReport(const RtcpReport &report) override;
+    void OnReceiverReport(const RtcpReport &report) override;
+    void OnBye(uint32_t ssrc) override;
+    void OnNack(const RtcpNack &nack) override;
+    void OnPictureLoss(uint32_t sender_ssrc, uint32_t media_ssrc) override;
+    void OnFullIntraRequest(uint32_t sender_ssrc, uint32_t media_ssrc, uint8_t sequence) override;
+
 private:
     void SendMedia();
+    void Retransmit(uint16_t seq, uint64_t now_ms, uint32_t min_interval_ms);
+    void RequestKeyframe();
+    // Draw the frame's packets from the server's egress budget
+    bool ConsumeEgress(const std::vector<RtpPacket> &packets);
+    void SendRtcpReport(bool bye);
 
 private:
     std::string transportInfo_;
@@ -121,9 +155,36 @@ private:
     std::atomic<bool> isActive_;
     std::thread send_thread_;
 
-    std::queue<MediaFrame> frame_queue_;
+    std::queue<std::shared_ptr<const MediaFrame>> frame_queue_;
     std::mutex queue_mutex_;
     std::condition_variable queue_cv_;
+
+    // SSRC of the media packets, fixed at Setup; RTCP feedback for other SSRCs is ignored
+    uint32_t ssrc_ = 0;
+    bool keyframeRequests_ = false;
+
+    // Retransmission, only created when the stream enables NACK
+    std::unique_ptr<RtpPacketHistory> history_;
+    uint8_t rtxPayloadType_ = 0;
+    uint32_t rtxSsrc_ = 0;
+    std::atomic<uint16_t> rtxSequence_{0};
+
+    // Forward error correction, only created when the stream enables FEC
+    std::unique_ptr<FecEncoder> fecEncoder_;
+
+    // Sender report state, owned by the send thread
+    uint32_t mediaSsrc_ = 0;
+    uint32_t lastRtpTimestamp_ = 0;
+    uint64_t lastRtpSendUs_ = 0; // Steady clock time lastRtpTimestamp_ went out
+    uint32_t clockRate_ = 90000;
+    uint32_t payloadBytesSent_ = 0;
+    uint64_t lastSenderReportMs_ = 0;
+
+    // Statistics
+    std::atomic<uint64_t> packetsSent_{0};
+    std::atomic<uint64_t> bytesSent_{0};
+    std::atomic<uint64_t> packetsRetransmitted_{0};
+    std::unique_ptr<RTCPReceiverStats> rtcpStats_;
 };
 
 // Factory method to create media stream
@@ -38,6 +38,23 @@ struct MediaStreamInfo {
     uint32_t ssrc = 0;
     uint32_t clock_rate = 90000;
 
+    // Retransmission parameters (RFC 4585 NACK, RFC 4588 RTX)
+    uint32_t nack_history_ms = 0; // Sent packets kept for retransmission, 0 disables NACK
+    // RTX needs both a payload type and an SSRC of its own, otherwise packets are resent with the original ones
+    uint8_t rtx_payload_type = 0;
+    uint32_t rtx_ssrc = 0;
+
+    // Keyframe requests (RFC 4585 PLI, RFC 5104 FIR), forwarded to IRTSPServerCallback::OnKeyframeRequested().
+    // Off by default, enabling it adds the rtcp-fb attributes to the stream's SDP
+    bool keyframe_requests = false;
+
+    // Forward error correction parameters (RFC 8627 FlexFEC, RFC 5109 ULPFEC)
+    std::string fec_scheme;       // "flexfec" or "ulpfec", empty disables FEC
+    uint8_t fec_payload_type = 0;
+    uint32_t fec_ssrc = 0;
+    uint8_t fec_columns = 10; // Packets protected by one row parity packet
+    uint8_t fec_rows = 1;     // Values above 1 add column parity packets
+
     // Transport parameters
     uint16_t rtp_port = 0;
     uint16_t rtcp_port = 0;
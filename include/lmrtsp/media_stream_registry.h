@@ -0,0 +1,95 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_MEDIA_STREAM_REGISTRY_H
+#define LMSHAO_LMRTSP_MEDIA_STREAM_REGISTRY_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "media_stream_info.h"
+
+namespace lmshao::lmrtsp {
+
+class RTSPSession;
+
+// Stream path registry for read-mostly workloads.
+// Readers load an immutable snapshot of the table and never wait for writers; writers copy the table, apply
+// their changes and publish the copy. Batch updates to pay for one copy per batch instead of one per stream.
+class MediaStreamRegistry {
+public:
+    class Entry {
+    public:
+        // Media section of the stream's SDP and the server port it was rendered for
+        struct CachedSDP {
+            uint16_t server_port = 0;
+            std::string text;
+        };
+
+        // Sessions playing the stream, replaced as a whole on every change so publishers iterate lock-free
+        using Subscribers = std::vector<std::weak_ptr<RTSPSession>>;
+
+        Entry(std::shared_ptr<const std::string> stream_path, std::shared_ptr<MediaStreamInfo> stream_info)
+            : path(std::move(stream_path)), info(std::move(stream_info))
+        {
+        }
+
+        std::shared_ptr<const CachedSDP> GetSDP() const { return std::atomic_load(&sdp_); }
+        void SetSDP(std::shared_ptr<const CachedSDP> sdp) { std::atomic_store(&sdp_, std::move(sdp)); }
+        void InvalidateSDP() { SetSDP(nullptr); }
+
+        // nullptr when nobody ever subscribed
+        std::shared_ptr<const Subscribers> GetSubscribers() const { return std::atomic_load(&subscribers_); }
+        // Both return false if nothing changed; expired sessions are dropped on the way
+        bool Subscribe(const std::shared_ptr<RTSPSession> &session);
+        bool Unsubscribe(const RTSPSession *session);
+
+        // Interned path, shared by the sessions playing the stream instead of a copy each
+        const std::shared_ptr<const std::string> path;
+        const std::shared_ptr<MediaStreamInfo> info;
+
+    private:
+        friend class MediaStreamRegistry;
+
+        std::shared_ptr<const CachedSDP> sdp_;
+        std::mutex subscribersMutex_;
+        std::shared_ptr<const Subscribers> subscribers_;
+    };
+
+    using Table = std::unordered_map<std::string, std::shared_ptr<Entry>>;
+    using Batch = std::vector<std::pair<std::string, std::shared_ptr<MediaStreamInfo>>>;
+
+    MediaStreamRegistry();
+
+    // Lock-free reads
+    std::shared_ptr<const Table> Snapshot() const { return std::atomic_load(&table_); }
+    std::shared_ptr<Entry> Find(const std::string &stream_path) const;
+    size_t Size() const { return Snapshot()->size(); }
+    std::vector<std::string> Paths() const; // Sorted
+
+    // Adding an existing path replaces the stream and drops its cached SDP, subscribers are kept
+    void Add(const std::string &stream_path, std::shared_ptr<MediaStreamInfo> stream_info);
+    bool Remove(const std::string &stream_path);
+
+    // Apply many changes with a single copy of the table. Removals are applied after additions.
+    // Returns the number of removed streams.
+    size_t Update(const Batch &added, const std::vector<std::string> &removed);
+
+private:
+    std::mutex writeMutex_;
+    std::shared_ptr<const Table> table_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_MEDIA_STREAM_REGISTRY_H
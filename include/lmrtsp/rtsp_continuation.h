@@ -0,0 +1,55 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTSP_CONTINUATION_H
+#define LMSHAO_LMRTSP_RTSP_CONTINUATION_H
+
+#include <atomic>
+#include <functional>
+
+namespace lmshao::lmrtsp {
+
+class RTSPServer;
+
+// Handle to a request the application chose to finish later, see IRTSPServerCallback::OnRequestDeferred().
+// Exactly one of Resume() and Reject() takes effect, from any thread. A continuation released without either
+// answers 500 so the client is never left waiting.
+// Either way the request is finished in order with the connection's other requests, and not at all once the
+// connection has closed.
+class RTSPContinuation {
+public:
+    // Called with 0 to resume, or with the status code to reject with
+    using Completion = std::function<void(int status_code)>;
+
+    explicit RTSPContinuation(Completion completion) : completion_(std::move(completion)) {}
+    ~RTSPContinuation();
+
+    RTSPContinuation(const RTSPContinuation &) = delete;
+    RTSPContinuation &operator=(const RTSPContinuation &) = delete;
+
+    // Process the request as if it had never been deferred
+    void Resume();
+    // Answer the request with an error status, e.g. 404 or 503
+    void Reject(int status_code);
+
+    bool IsDone() const { return done_.load(); }
+
+private:
+    friend class RTSPServer;
+
+    // Forget the request without answering it, used when the application declines to defer
+    void Dismiss() { done_.store(true); }
+    void Complete(int status_code);
+
+    Completion completion_;
+    std::atomic<bool> done_{false};
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTSP_CONTINUATION_H
@@ -0,0 +1,76 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTSP_HEADER_MAP_H
+#define LMSHAO_LMRTSP_RTSP_HEADER_MAP_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "rtsp_headers.h"
+
+namespace lmshao::lmrtsp {
+
+// Flat header container with case-insensitive lookup.
+// Known headers are matched by their interned HeaderId and stored under the canonical spelling; the first
+// kInlineCapacity entries live inside the object, so a typical message needs no node allocations.
+// Entries keep insertion order and the interface mirrors the subset of std::map the code uses.
+class HeaderMap {
+public:
+    using value_type = std::pair<std::string, std::string>;
+    using iterator = value_type *;
+    using const_iterator = const value_type *;
+
+    static constexpr size_t kInlineCapacity = 8;
+
+    iterator begin() { return Data(); }
+    iterator end() { return Data() + size_; }
+    const_iterator begin() const { return Data(); }
+    const_iterator end() const { return Data() + size_; }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    void clear();
+
+    iterator find(HeaderId id);
+    const_iterator find(HeaderId id) const;
+    iterator find(std::string_view name);
+    const_iterator find(std::string_view name) const;
+    size_t count(std::string_view name) const { return find(name) != end() ? 1 : 0; }
+
+    // Throws std::out_of_range if the header is absent, like std::map::at
+    const std::string &at(std::string_view name) const;
+
+    // Value of the header, inserted empty if absent
+    std::string &operator[](std::string_view name);
+
+    size_t erase(std::string_view name);
+
+private:
+    value_type *Data() { return onHeap_ ? heapEntries_.data() : inlineEntries_.data(); }
+    const value_type *Data() const { return onHeap_ ? heapEntries_.data() : inlineEntries_.data(); }
+    HeaderId *Ids() { return onHeap_ ? heapIds_.data() : inlineIds_.data(); }
+    const HeaderId *Ids() const { return onHeap_ ? heapIds_.data() : inlineIds_.data(); }
+
+    size_t IndexOf(HeaderId id, std::string_view name) const;
+
+    size_t size_ = 0;
+    bool onHeap_ = false;
+    std::array<HeaderId, kInlineCapacity> inlineIds_{};
+    std::array<value_type, kInlineCapacity> inlineEntries_;
+    std::vector<HeaderId> heapIds_;
+    std::vector<value_type> heapEntries_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTSP_HEADER_MAP_H
@@ -9,6 +9,10 @@
 #ifndef LMSHAO_LMRTSP_RTSP_HEADERS_H
 #define LMSHAO_LMRTSP_RTSP_HEADERS_H
 
+#include <array>
+#include <cstdint>
+#include <string_view>
+
 namespace lmshao::lmrtsp {
 
 // RTSP Methods
@@ -119,6 +123,177 @@ constexpr const char *REASON_OPTION_NOT_SUPPORTED = "Option not supported";
 // Avoid conflict with Windows REASON_UNKNOWN macro
 constexpr const char *REASON_UNKNOWN_ERROR = "Unknown";
 
+// Well-known header fields, recognised without allocating or lowercasing the name
+enum class HeaderId : uint8_t {
+    CSEQ,
+    DATE,
+    SESSION,
+    TRANSPORT,
+    LOCATION,
+    REQUIRE,
+    PROXY_REQUIRE,
+    ACCEPT,
+    ACCEPT_ENCODING,
+    ACCEPT_LANGUAGE,
+    AUTHORIZATION,
+    FROM,
+    IF_MODIFIED_SINCE,
+    RANGE,
+    REFERER,
+    USER_AGENT,
+    CONTENT_TYPE,
+    CONTENT_LENGTH,
+    CONTENT_BASE,
+    CONTENT_ENCODING,
+    CONTENT_LANGUAGE,
+    PUBLIC,
+    SERVER,
+    RTP_INFO,
+    WWW_AUTHENTICATE,
+    PROXY_AUTHENTICATE,
+    RETRY_AFTER,
+    UNSUPPORTED,
+    CONNECTION,
+    BANDWIDTH,
+    BLOCKSIZE,
+    SCALE,
+    SPEED,
+    TIMESTAMP,
+    CACHE_CONTROL,
+    EXPIRES,
+    ALLOW,
+    VARY,
+    LAST_MODIFIED,
+    VIA,
+    UNKNOWN
+};
+
+namespace detail {
+
+// Canonical spelling, indexed by HeaderId
+constexpr std::array<std::string_view, static_cast<size_t>(HeaderId::UNKNOWN)> kHeaderNames = {
+    "CSeq", "Date", "Session", "Transport", "Location", "Require", "Proxy-Require", "Accept", "Accept-Encoding",
+    "Accept-Language", "Authorization", "From", "If-Modified-Since", "Range", "Referer", "User-Agent", "Content-Type",
+    "Content-Length", "Content-Base", "Content-Encoding", "Content-Language", "Public", "Server", "RTP-Info",
+    "WWW-Authenticate", "Proxy-Authenticate", "Retry-After", "Unsupported", "Connection", "Bandwidth", "Blocksize",
+    "Scale", "Speed", "Timestamp", "Cache-Control", "Expires", "Allow", "Vary", "Last-Modified", "Via"};
+
+constexpr char AsciiLower(char c)
+{
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Case-insensitive FNV-1a; the seed was chosen so that every known name lands in its own slot
+constexpr uint32_t kHeaderHashSeed = 833;
+constexpr size_t kHeaderHashBits = 7;
+
+constexpr size_t HeaderSlot(std::string_view name)
+{
+    uint32_t hash = kHeaderHashSeed;
+    for (char c : name) {
+        hash = (hash ^ static_cast<uint8_t>(AsciiLower(c))) * 0x01000193U;
+    }
+    return hash >> (32 - kHeaderHashBits);
+}
+
+constexpr std::array<uint8_t, (1U << kHeaderHashBits)> BuildHeaderTable()
+{
+    std::array<uint8_t, (1U << kHeaderHashBits)> table{};
+    for (auto &slot : table) {
+        slot = static_cast<uint8_t>(HeaderId::UNKNOWN);
+    }
+    for (size_t i = 0; i < kHeaderNames.size(); ++i) {
+        table[HeaderSlot(kHeaderNames[i])] = static_cast<uint8_t>(i);
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, (1U << kHeaderHashBits)> kHeaderTable = BuildHeaderTable();
+
+constexpr bool IsHeaderTablePerfect()
+{
+    for (size_t i = 0; i < kHeaderNames.size(); ++i) {
+        if (kHeaderTable[HeaderSlot(kHeaderNames[i])] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(IsHeaderTablePerfect(), "header names collide, pick another kHeaderHashSeed");
+
+} // namespace detail
+
+constexpr bool EqualsIgnoreCase(std::string_view a, std::string_view b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (detail::AsciiLower(a[i]) != detail::AsciiLower(b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Canonical name of a known header, empty for HeaderId::UNKNOWN
+constexpr std::string_view HeaderName(HeaderId id)
+{
+    return id < HeaderId::UNKNOWN ? detail::kHeaderNames[static_cast<size_t>(id)] : std::string_view();
+}
+
+// Identify a header by name, ignoring case. One hash and one comparison, usable at compile time.
+constexpr HeaderId LookupHeader(std::string_view name)
+{
+    auto id = static_cast<HeaderId>(detail::kHeaderTable[detail::HeaderSlot(name)]);
+    return id != HeaderId::UNKNOWN && EqualsIgnoreCase(HeaderName(id), name) ? id : HeaderId::UNKNOWN;
+}
+
+// RTSP methods, resolved once per request so handlers switch on an enum instead of comparing strings
+enum class RTSPMethod : uint8_t {
+    OPTIONS,
+    DESCRIBE,
+    ANNOUNCE,
+    SETUP,
+    PLAY,
+    PAUSE,
+    TEARDOWN,
+    RECORD,
+    GET_PARAMETER,
+    SET_PARAMETER,
+    REDIRECT,
+    UNKNOWN
+};
+
+constexpr size_t kRTSPMethodCount = static_cast<size_t>(RTSPMethod::UNKNOWN) + 1;
+
+namespace detail {
+
+// Indexed by RTSPMethod
+constexpr std::array<std::string_view, static_cast<size_t>(RTSPMethod::UNKNOWN)> kMethodNames = {
+    METHOD_OPTIONS,  METHOD_DESCRIBE, METHOD_ANNOUNCE,      METHOD_SETUP,         METHOD_PLAY,    METHOD_PAUSE,
+    METHOD_TEARDOWN, METHOD_RECORD,   METHOD_GET_PARAMETER, METHOD_SET_PARAMETER, METHOD_REDIRECT};
+
+} // namespace detail
+
+// Method token, empty for RTSPMethod::UNKNOWN
+constexpr std::string_view MethodName(RTSPMethod method)
+{
+    return method < RTSPMethod::UNKNOWN ? detail::kMethodNames[static_cast<size_t>(method)] : std::string_view();
+}
+
+// Identify a method token; methods are case-sensitive (RFC 2326 section 6.1)
+constexpr RTSPMethod LookupMethod(std::string_view name)
+{
+    for (size_t i = 0; i < detail::kMethodNames.size(); ++i) {
+        if (detail::kMethodNames[i] == name) {
+            return static_cast<RTSPMethod>(i);
+        }
+    }
+    return RTSPMethod::UNKNOWN;
+}
+
 } // namespace lmshao::lmrtsp
 
 #endif // LMSHAO_LMRTSP_RTSP_HEADERS_H
\ No newline at end of file
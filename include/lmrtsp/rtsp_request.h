@@ -9,11 +9,13 @@
 #ifndef LMSHAO_LMRTSP_RTSP_REQUEST_H
 #define LMSHAO_LMRTSP_RTSP_REQUEST_H
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "rtsp_header_map.h"
 #include "rtsp_headers.h"
 
 namespace lmshao::lmrtsp {
@@ -45,15 +47,23 @@ public:
     std::string ToString() const;
     static RTSPRequest FromString(const std::string &req_str);
 
-    std::map<std::string, std::string> entity_header_;
+    HeaderMap entity_header_;
     std::optional<std::string> message_body_;
 
 public:
     std::string method_;
     std::string uri_;
     std::string version_;
-    std::map<std::string, std::string> general_header_;
+    HeaderMap general_header_;
     RequestHeader request_header_;
+
+    // Validated once when the request is parsed or built, so handlers never convert header strings
+    RTSPMethod method_id_ = RTSPMethod::UNKNOWN;
+    int cseq_ = -1; // -1 if CSeq is missing or not a number
+    size_t content_length_ = 0;
+    std::string session_id_;        // Session header without parameters
+    uint16_t client_rtp_port_ = 0;  // Transport client_port, 0 if absent
+    uint16_t client_rtcp_port_ = 0;
 };
 
 // Builder class for constructing RTSP requests
@@ -0,0 +1,49 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTSP_REQUEST_METRICS_H
+#define LMSHAO_LMRTSP_RTSP_REQUEST_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "rtsp_headers.h"
+
+namespace lmshao::lmrtsp {
+
+// Per-method request counters and handling latency histograms, updated lock-free from any thread
+class RTSPRequestMetrics {
+public:
+    // Bucket i counts requests handled in under 2^i microseconds, the last bucket takes everything slower
+    static constexpr size_t kLatencyBuckets = 16;
+
+    struct Snapshot {
+        uint64_t count = 0;
+        std::array<uint64_t, kLatencyBuckets> latency{};
+    };
+
+    void Record(RTSPMethod method, std::chrono::nanoseconds latency);
+    Snapshot Get(RTSPMethod method) const;
+    void Reset();
+
+    static size_t LatencyBucket(std::chrono::nanoseconds latency);
+
+private:
+    struct Counters {
+        std::atomic<uint64_t> count{0};
+        std::array<std::atomic<uint64_t>, kLatencyBuckets> latency{};
+    };
+
+    std::array<Counters, kRTSPMethodCount> methods_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTSP_REQUEST_METRICS_H
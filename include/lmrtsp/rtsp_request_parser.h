@@ -0,0 +1,119 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTSP_REQUEST_PARSER_H
+#define LMSHAO_LMRTSP_RTSP_REQUEST_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "rtsp_headers.h"
+
+namespace lmshao::lmrtsp {
+
+class RTSPRequest;
+
+struct RTSPHeaderField {
+    HeaderId id = HeaderId::UNKNOWN;
+    std::string_view name;
+    std::string_view value;
+};
+
+// Parsed request as views into the buffer given to the parser.
+// The views stay valid as long as that buffer is neither modified nor moved.
+struct RTSPRequestView {
+    static constexpr size_t kMaxHeaders = 64;
+
+    std::string_view method;
+    RTSPMethod method_id = RTSPMethod::UNKNOWN;
+    std::string_view uri;
+    std::string_view version;
+    std::string_view body;
+    size_t header_count = 0;
+    RTSPHeaderField headers[kMaxHeaders];
+
+    // First header with the given id, nullptr if absent
+    const RTSPHeaderField *Find(HeaderId id) const;
+};
+
+// Incremental RTSP request parser.
+// Feed it the bytes received so far, starting at the beginning of the message; lines that were already
+// scanned are not looked at again, so the buffer may grow (and move) between calls.
+class RTSPRequestParser {
+public:
+    enum class Status {
+        INCOMPLETE, // Need more data
+        COMPLETE,   // Request() and MessageSize() are valid
+        ERROR,      // Malformed request, the connection should be closed
+        TOO_LARGE   // Header section or body exceeds the configured limits
+    };
+
+    RTSPRequestParser() = default;
+
+    // Upper bounds for the header section (request line included) and the declared body size.
+    // Unlimited by default; checked as data arrives so an oversized message is rejected early.
+    void SetLimits(size_t max_header_size, size_t max_body_size);
+
+    // Streaming mode: the message ends after the blank line plus Content-Length bytes of body.
+    Status Parse(std::string_view data);
+
+    // Whole-message mode: data holds exactly one message, a missing final CRLF is tolerated and
+    // everything after the blank line is the body.
+    Status ParseMessage(std::string_view data);
+
+    // Prepare for the next message.
+    void Reset();
+
+    const RTSPRequestView &Request() const { return request_; }
+    size_t MessageSize() const { return messageSize_; }
+    size_t ContentLength() const { return contentLength_; }
+
+    // Copy the parsed request into an RTSPRequest.
+    RTSPRequest ToRequest() const;
+
+private:
+    // Position of a token inside the message, kept as offsets so the buffer may move while incomplete
+    struct Span {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+    struct HeaderSpan {
+        HeaderId id = HeaderId::UNKNOWN;
+        Span name;
+        Span value;
+    };
+
+    enum class State { REQUEST_LINE, HEADERS, BODY, DONE, ERROR };
+
+    bool ParseLine(std::string_view data, size_t start, size_t end);
+    bool ParseRequestLine(std::string_view data, size_t start, size_t end);
+    bool ParseHeaderLine(std::string_view data, size_t start, size_t end);
+    Status Finish(std::string_view data, size_t body_size);
+
+    State state_ = State::REQUEST_LINE;
+    size_t offset_ = 0;
+    size_t bodyStart_ = 0;
+    size_t contentLength_ = 0;
+    bool contentLengthValid_ = true;
+    size_t messageSize_ = 0;
+    size_t maxHeaderSize_ = SIZE_MAX;
+    size_t maxBodySize_ = SIZE_MAX;
+
+    Span method_;
+    Span uri_;
+    Span version_;
+    size_t headerCount_ = 0;
+    HeaderSpan headers_[RTSPRequestView::kMaxHeaders];
+
+    RTSPRequestView request_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTSP_REQUEST_PARSER_H
@@ -14,60 +14,142 @@
 #include <lmnet/tcp_server.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
-#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
+#include "admission_limits.h"
 #include "irtsp_server_callback.h"
+#include "lmrtp/i_rtp_packetizer.h"
 #include "media_stream_info.h"
+#include "media_stream_registry.h"
+#include "rtsp_request_metrics.h"
+#include "rtsp_transport.h"
 
 namespace lmshao::lmrtsp {
 using namespace lmshao::lmcore;
 class RTSPSession;
 class RTSPRequest;
+struct RTSPRequestView;
+class AdmissionControl;
+class CallbackDispatcher;
+class EgressBudget;
+class ResourceReclaimer;
 class RTSPServerListener;
+class RTSPSessionTable;
+class TimerWheel;
 class RTSPServer : public std::enable_shared_from_this<RTSPServer>, public ManagedSingleton<RTSPServer> {
 public:
     friend class ManagedSingleton<RTSPServer>;
     friend class RTSPServerListener;
 
-    ~RTSPServer() = default;
+    // Runs the task it is given, typically by posting it to a thread pool or event loop
+    using CallbackExecutor = std::function<void(std::function<void()>)>;
+    static constexpr size_t kDefaultCallbackQueueCapacity = 1024;
+
+    ~RTSPServer();
 
     // Basic server functionality
     bool Init(const std::string &ip, uint16_t port);
     bool Start();
     bool Stop();
     bool IsRunning() const;
+    // Threads that parse and handle RTSP requests, set before Init(); 0 handles them on the network thread.
+    // Each connection sticks to one thread, only the session table and stream registry are shared.
+    void SetReactorCount(size_t count);
+    size_t GetReactorCount() const;
 
     // Session management
     void HandleRequest(std::shared_ptr<RTSPSession> session, const RTSPRequest &request);
+    // Answer OPTIONS and empty GET_PARAMETER keep-alives from pre-rendered responses.
+    // Returns false if the request has to take the full path.
+    bool HandleKeepAlive(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequestView &request);
     void HandleStatelessRequest(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequest &request);
+    // Route a request to its session, creating one for SETUP
+    void HandleSessionRequest(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequest &request);
+    // Offer DESCRIBE and SETUP to IRTSPServerCallback::OnRequestDeferred(); true if the application took it over.
+    // The answer is handled on the listener's reactor for the connection, in order with its other requests.
+    bool DeferRequest(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequest &request,
+                      std::weak_ptr<RTSPServerListener> listener);
     void SendErrorResponse(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequest &request, int statusCode,
                            const std::string &reasonPhrase);
+    // Answer 503 without parsing the request further, used for connections refused by admission control
+    void RefuseRequest(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequestView &request);
     std::shared_ptr<RTSPSession> CreateSession(std::shared_ptr<lmnet::Session> lmnetSession);
     void RemoveSession(const std::string &sessionId);
+    // Remove every session controlled over the given connection
+    void RemoveSessions(std::shared_ptr<lmnet::Session> lmnetSession);
     std::shared_ptr<RTSPSession> GetSession(const std::string &sessionId);
     std::unordered_map<std::string, std::shared_ptr<RTSPSession>> GetSessions();
+    // Timeout of new sessions in seconds, advertised in the SETUP reply; idle sessions are torn down.
+    // Clients may ask for a shorter one in the Session header, never for a longer one
+    void SetSessionTimeout(uint32_t timeout_seconds);
+    uint32_t GetSessionTimeout() const;
+
+    // Hand release work that may block (joining threads, closing sockets) to the background reclaimer
+    void Reclaim(std::function<void()> task);
 
     // Callback interface
     void SetCallback(std::shared_ptr<IRTSPServerCallback> callback);
     std::shared_ptr<IRTSPServerCallback> GetCallback() const;
+    // Deliver callback events through a bounded queue to the given executor instead of the network thread.
+    // Events that find the queue full are dropped and counted; a null executor restores inline delivery.
+    void SetCallbackExecutor(CallbackExecutor executor, size_t queue_capacity = kDefaultCallbackQueueCapacity);
+    uint64_t GetDroppedCallbacks() const;
 
     // Media stream management
     bool AddMediaStream(const std::string &stream_path, std::shared_ptr<MediaStreamInfo> stream_info);
     bool RemoveMediaStream(const std::string &stream_path);
+    // Register and unregister many streams at once, cheaper than one call per stream
+    void AddMediaStreams(const MediaStreamRegistry::Batch &streams);
+    size_t RemoveMediaStreams(const std::vector<std::string> &stream_paths);
     std::shared_ptr<MediaStreamInfo> GetMediaStream(const std::string &stream_path);
+    // Drop the cached SDP after changing a registered stream's parameters (codec, parameter sets...)
+    void InvalidateSDP(const std::string &stream_path);
     std::vector<std::string> GetMediaStreamPaths() const;
 
+    // Media fan-out: sessions subscribe to their stream path on PLAY and leave on PAUSE or TEARDOWN.
+    // PushFrame hands one shared copy of the frame to each subscriber and returns how many media streams queued it.
+    size_t PushFrame(const std::string &stream_path, lmrtp::MediaFrame frame);
+    bool Subscribe(const std::string &uri, std::shared_ptr<RTSPSession> session);
+    void Unsubscribe(const std::string &stream_path, const RTSPSession *session);
+
     // Client management
     std::vector<std::string> GetConnectedClients() const;
     bool DisconnectClient(const std::string &client_ip);
     size_t GetClientCount() const;
 
-    // SDP generation
+    // Connection, session and player limits; work beyond them is refused with 503 and Retry-After
+    void SetAdmissionLimits(const AdmissionLimits &limits);
+    AdmissionLimits GetAdmissionLimits() const;
+    uint64_t GetRefusedCount() const;
+
+    // Egress capacity in bits per second, 0 for none. PLAY reserves the stream's declared bitrate and is refused
+    // with 453 when it does not fit; media beyond the capacity is dropped before sending.
+    void SetEgressCapacity(uint64_t bits_per_second);
+    // Draw bytes about to be sent from the budget, false if they have to be dropped; now_us is monotonic
+    bool ConsumeEgress(size_t bytes, uint64_t now_us);
+    // Give back the bitrate a player reserved
+    void ReleaseEgress(uint64_t bitrate);
+    uint64_t GetEgressDroppedBytes() const;
+
+    // Keyframe requests from RTCP PLI/FIR, forwarded at most once per interval and stream
+    void RequestKeyframe(const std::string &stream_path, const std::string &client_ip);
+    void SetKeyframeRequestInterval(uint32_t interval_ms);
+
+    // Request counts and handling latency per RTSP method
+    const RTSPRequestMetrics &GetRequestMetrics() const { return requestMetrics_; }
+
+    // Transports offered to clients in SETUP; multicast and SRTP are off by default
+    void SetTransportSupport(const TransportSupport &support);
+    TransportSupport GetTransportSupport() const;
+
+    // SDP generation, rendered once per stream and cached until the stream changes
     std::string GenerateSDP(const std::string &stream_path, const std::string &server_ip, uint16_t server_port);
 
     // Server information
@@ -84,21 +166,55 @@ private:
     std::string serverIP_;
     uint16_t serverPort_;
     std::atomic<bool> running_{false};
+    size_t reactorCount_ = 0;
 
-    // Session management
-    mutable std::mutex sessionsMutex_;
-    std::unordered_map<std::string, std::shared_ptr<RTSPSession>> sessions_;
+    // Session management, indexed by connection and client IP
+    std::unique_ptr<RTSPSessionTable> sessions_;
+
+    // Idle session expiry, checked once per second
+    std::atomic<uint32_t> sessionTimeout_{60}; // RFC 2326 default
+    std::mutex expiryMutex_;
+    std::condition_variable expiryCondition_;
+    std::unique_ptr<TimerWheel> expiryWheel_;
+    std::thread reaperThread_;
+
+    // Runs media teardown off the network thread
+    std::unique_ptr<ResourceReclaimer> reclaimer_;
 
     // Callback interface
     mutable std::mutex callbackMutex_;
     std::shared_ptr<IRTSPServerCallback> callback_;
+    std::shared_ptr<CallbackDispatcher> callbackDispatcher_;
+    std::atomic<uint64_t> droppedCallbacks_{0};
 
-    // Media stream management
-    mutable std::mutex streamsMutex_;
-    std::map<std::string, std::shared_ptr<MediaStreamInfo>> mediaStreams_;
+    // Media stream management, looked up without locking
+    MediaStreamRegistry mediaStreams_;
+
+    std::unique_ptr<AdmissionControl> admission_;
+    std::unique_ptr<EgressBudget> egressBudget_;
+
+    // Request counters and latency histograms per method
+    RTSPRequestMetrics requestMetrics_;
+
+    mutable std::mutex transportMutex_;
+    TransportSupport transportSupport_;
+
+    // Keyframe request coalescing
+    std::mutex keyframeMutex_;
+    std::atomic<uint32_t> keyframeIntervalMs_{500};
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> lastKeyframeRequest_;
 
     // Internal helper methods
+    void ReapExpiredSessions();
+    void StopReaper();
+    // Run an admitted request through the session state machine, answer it and notify the callback
+    void ProcessSessionRequest(const std::shared_ptr<RTSPSession> &session, const RTSPRequest &request,
+                               const std::string &client_ip);
     std::string GetClientIP(std::shared_ptr<RTSPSession> session) const;
+    // Registered stream addressed by uri or by its parent path, path receives the stream path
+    std::shared_ptr<MediaStreamRegistry::Entry> FindStream(const std::string &uri, std::string &path) const;
+    bool AdmitPlay(const std::shared_ptr<RTSPSession> &session, const RTSPRequest &request);
+    bool ReserveEgress(const std::shared_ptr<RTSPSession> &session, const RTSPRequest &request);
     void NotifyCallback(std::function<void(IRTSPServerCallback *)> func);
 };
 
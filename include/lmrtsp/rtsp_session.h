@@ -22,6 +22,7 @@
 #include <vector>
 
 #include "irtp_sender.h"
+#include "lmrtp/i_rtp_packetizer.h"
 #include "media_stream_info.h"
 #include "rtsp_request.h"
 #include "rtsp_response.h"
@@ -47,6 +48,8 @@ public:
 
     // Session information
     std::string GetSessionId() const;
+    // Numeric form of the session id, the key in the server's session table
+    uint64_t GetSessionKey() const { return sessionKey_; }
     std::string GetClientIP() const;
     uint16_t GetClientPort() const;
     std::shared_ptr<lmnet::Session> GetNetworkSession() const;
@@ -60,6 +63,12 @@ public:
     std::shared_ptr<MediaStream> GetMediaStream(int track_index);
     const std::vector<std::shared_ptr<MediaStream>> &GetMediaStreams() const;
 
+    // Stream fan-out, see RTSPServer::PushFrame()
+    void SetStreamPath(std::shared_ptr<const std::string> stream_path);
+    std::string GetStreamPath() const;
+    // Queue the frame on every playing stream, returns how many queued it
+    size_t DeliverFrame(const std::shared_ptr<const lmrtp::MediaFrame> &frame);
+
     // Media stream info
     void SetMediaStreamInfo(std::shared_ptr<MediaStreamInfo> stream_info);
     std::shared_ptr<MediaStreamInfo> GetMediaStreamInfo() const;
@@ -90,42 +99,63 @@ public:
     // Statistics
     RTPStatistics GetRTPStatistics() const;
 
+    // Egress bandwidth reserved by PLAY, given back on PAUSE, TEARDOWN or destruction
+    void SetReservedBitrate(uint32_t bitrate);
+    void ReleaseReservedBitrate();
+
     // Session timeout management
+    static constexpr uint32_t kDefaultTimeout = 60;
+    static constexpr uint32_t kMinTimeout = 10;
+    static constexpr uint32_t kMaxTimeout = 3600;
+
     void UpdateLastActiveTime();
     bool IsExpired(uint32_t timeout_seconds) const;
     time_t GetLastActiveTime() const;
+    // Clamped to [kMinTimeout, kMaxTimeout]
+    void SetTimeout(uint32_t timeout_seconds);
+    uint32_t GetTimeout() const;
+    // MonotonicSeconds() after which the session is idle for longer than its timeout
+    uint64_t GetExpiryTime() const;
+    static uint64_t MonotonicSeconds();
 
 private:
     // Helper methods
-    static std::string GenerateSessionId();
-
-    // Transport parsing
-    RTPTransportParams ParseTransportHeader(const std::string &transport) const;
-
-    std::string sessionId_;
+    // Tear the streams down on the server's reclaimer, or right here without a server
+    void ReleaseMediaStreams(std::vector<std::shared_ptr<MediaStream>> streams);
+    std::vector<std::shared_ptr<MediaStream>> CopyMediaStreams() const;
+
+    // Everything a session only needs once it describes or sets up media. Allocated on first use, so the
+    // many idle sessions of recorder clients cost little more than the fields below.
+    struct MediaState {
+        std::vector<std::shared_ptr<MediaStream>> streams;
+        std::shared_ptr<MediaStreamInfo> info;
+        std::shared_ptr<IRTPSender> sender;
+        RTPTransportParams params;
+        std::string transportInfo; // legacy
+        std::string sdpDescription;
+    };
+    // mediaInfoMutex_ must be held
+    MediaState &Media();
+
+    uint64_t sessionKey_;
     std::shared_ptr<RTSPSessionState> currentState_;
     std::shared_ptr<lmnet::Session> lmnetSession_;
     std::weak_ptr<RTSPServer> rtspServer_;
 
-    // Media streams
-    std::vector<std::shared_ptr<MediaStream>> mediaStreams_;
-    std::string sdpDescription_;
-    std::string transportInfo_; // legacy
-
-    // Media stream info and RTP
     mutable std::mutex mediaInfoMutex_;
-    std::shared_ptr<MediaStreamInfo> mediaStreamInfo_;
-    std::shared_ptr<IRTPSender> rtpSender_;
-    RTPTransportParams rtpTransportParams_;
+    std::unique_ptr<MediaState> media_;
+    // Interned path of the registered stream the session is subscribed to while playing
+    std::shared_ptr<const std::string> streamPath_;
 
     // State flags
     std::atomic<bool> isPlaying_{false};
     std::atomic<bool> isPaused_{false};
     std::atomic<bool> isSetup_{false};
+    std::atomic<uint32_t> reservedBitrate_{0};
 
     // Session timeout
-    uint32_t timeout_;                   // Session timeout (seconds)
-    std::atomic<time_t> lastActiveTime_; // Last active time
+    std::atomic<uint32_t> timeout_;        // Session timeout (seconds)
+    std::atomic<uint64_t> lastActiveTime_; // Last active time, MonotonicSeconds()
 };
 
 } // namespace lmshao::lmrtsp
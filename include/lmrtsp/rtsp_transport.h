@@ -0,0 +1,86 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTSP_TRANSPORT_H
+#define LMSHAO_LMRTSP_RTSP_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "irtp_sender.h"
+
+namespace lmshao::lmrtsp {
+
+enum class TransportProfile : uint8_t { AVP, AVPF, SAVP, SAVPF };
+
+enum class LowerTransport : uint8_t { UDP, TCP };
+
+// One transport-spec of a Transport header (RFC 2326 section 12.39).
+// String fields are views into the header text.
+struct TransportSpec {
+    TransportProfile profile = TransportProfile::AVP;
+    LowerTransport lower_transport = LowerTransport::UDP;
+    bool unicast = true;
+    std::string_view destination;
+    std::string_view mode; // Empty means PLAY
+    uint16_t client_rtp_port = 0;
+    uint16_t client_rtcp_port = 0;
+    uint16_t multicast_rtp_port = 0; // port= of a multicast spec
+    uint16_t multicast_rtcp_port = 0;
+    bool interleaved = false;
+    uint8_t rtp_channel = 0;
+    uint8_t rtcp_channel = 0;
+    uint8_t ttl = 0; // 0 if not given
+    bool has_ssrc = false;
+    uint32_t ssrc = 0;
+};
+
+// All specs a client offered, in its order of preference
+struct TransportOffer {
+    static constexpr size_t kMaxSpecs = 8;
+
+    size_t count = 0;
+    TransportSpec specs[kMaxSpecs];
+};
+
+// What the server is able to deliver
+struct TransportSupport {
+    bool udp = true;
+    bool tcp = true;
+    bool multicast = false;
+    bool secure = false; // SAVP/SAVPF
+};
+
+// Parse a Transport header without allocating. Specs that are not RTP or are malformed are skipped;
+// returns false if none is left.
+bool ParseTransport(std::string_view header, TransportOffer &offer);
+
+// Cheapest spec the server supports: multicast, then unicast UDP, then TCP interleaved. Among equal options
+// the client's order wins. nullptr if nothing offered is supported.
+const TransportSpec *SelectTransport(const TransportOffer &offer, const TransportSupport &support);
+
+// Where the server sends a multicast stream, configured per stream; clients can only accept it
+struct MulticastGroup {
+    std::string_view address;
+    uint16_t rtp_port = 0;
+    uint16_t rtcp_port = 0;
+    uint8_t ttl = 0;
+};
+
+// Copy the negotiated spec into the sender parameters. Multicast media goes to group, the destination, port and ttl
+// a client asked for are ignored.
+void ApplyTransport(const TransportSpec &spec, const MulticastGroup &group, RTPTransportParams &params);
+
+// Append the canonical text of spec, as echoed in the SETUP reply; a multicast spec names group instead
+void AppendTransport(std::string &out, const TransportSpec &spec, const MulticastGroup &group = MulticastGroup());
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTSP_TRANSPORT_H
@@ -0,0 +1,36 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_SESSION_ID_H
+#define LMSHAO_LMRTSP_SESSION_ID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace lmshao::lmrtsp {
+
+// RTSP session identifiers: unpredictable 64-bit keys, written as 16 hex digits in the Session header.
+// Keys come from a ChaCha20 generator per thread, seeded from the system entropy source and rekeyed from its own
+// output after every block, so neither concurrent SETUPs nor an observer of issued ids can predict the next one.
+class SessionId {
+public:
+    static constexpr size_t kLength = 16;
+
+    // Never 0
+    static uint64_t Generate();
+
+    static std::string Format(uint64_t key);
+    // Accepts exactly kLength hex digits of either case; false for anything else and for 0
+    static bool Parse(std::string_view text, uint64_t &key);
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_SESSION_ID_H
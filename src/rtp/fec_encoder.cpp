@@ -0,0 +1,246 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtp/fec_encoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "internal_logger.h"
+#include "xor_kernel.h"
+
+namespace lmshao::lmrtp {
+
+namespace {
+
+constexpr size_t kRtpHeaderSize = 12;
+
+// Largest sequence number offset from SN base that a single FEC packet can describe
+constexpr size_t kFlexFecMaxOffset = 108; // 15 + 31 + 63 mask bits
+constexpr size_t kUlpFecMaxOffset = 47;   // 48-bit mask with the L bit set
+
+void WriteU16(uint8_t *p, uint16_t value)
+{
+    p[0] = static_cast<uint8_t>(value >> 8);
+    p[1] = static_cast<uint8_t>(value);
+}
+
+void WriteU32(uint8_t *p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+uint32_t ReadU32(const uint8_t *p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+} // namespace
+
+FecEncoder::FecEncoder(const FecConfig &config) : config_(config)
+{
+    size_t maxOffset = config_.scheme == FecScheme::FLEXFEC ? kFlexFecMaxOffset : kUlpFecMaxOffset;
+    config_.columns = static_cast<uint8_t>(std::clamp<size_t>(config_.columns, 1, maxOffset + 1));
+    config_.rows = static_cast<uint8_t>(std::clamp<size_t>(config_.rows, 1, maxOffset / config_.columns + 1));
+    if (config_.columns != config.columns || config_.rows != config.rows) {
+        RTP_LOGW("FecEncoder: %ux%u block exceeds the FEC mask, using %ux%u", config.columns, config.rows,
+                 config_.columns, config_.rows);
+    }
+
+    row_.buffer.resize(kHeaderRoom + kMaxPacketSize);
+    if (config_.rows > 1) {
+        columns_.resize(config_.columns);
+        for (auto &column : columns_) {
+            column.buffer.resize(kHeaderRoom + kMaxPacketSize);
+        }
+    }
+    RTP_LOGD("FecEncoder created: %ux%u, %s kernel", config_.columns, config_.rows, XorKernelName());
+}
+
+void FecEncoder::Reset()
+{
+    index_ = 0;
+}
+
+void FecEncoder::Accumulate(Parity &parity, const uint8_t *packet, size_t size)
+{
+    size_t length = size - kRtpHeaderSize;
+    const uint8_t *protected_data = packet + kRtpHeaderSize;
+    uint8_t *payload = parity.buffer.data() + kHeaderRoom;
+    uint32_t timestamp = ReadU32(packet + 4);
+
+    if (parity.count == 0) {
+        parity.header[0] = packet[0];
+        parity.header[1] = packet[1];
+        parity.length = static_cast<uint16_t>(length);
+        parity.timestamp = timestamp;
+        parity.size = length;
+        memcpy(payload, protected_data, length);
+    } else {
+        parity.header[0] ^= packet[0];
+        parity.header[1] ^= packet[1];
+        parity.length ^= static_cast<uint16_t>(length);
+        parity.timestamp ^= timestamp;
+        // Shorter packets are implicitly zero padded to the longest one
+        if (length > parity.size) {
+            memset(payload + parity.size, 0, length - parity.size);
+            parity.size = length;
+        }
+        XorInto(payload, protected_data, length);
+    }
+    parity.last_timestamp = timestamp;
+    parity.count++;
+}
+
+size_t FecEncoder::WriteFlexFecHeader(const Parity &parity, uint8_t *out) const
+{
+    // RFC 8627 section 4.2.2.1, R=0 F=0: flexible mask in up to three k-bit terminated chunks
+    out[0] = parity.header[0] & 0x3F;
+    out[1] = parity.header[1];
+    WriteU16(out + 2, parity.length);
+    WriteU32(out + 4, parity.timestamp);
+    WriteU16(out + 8, parity.base);
+
+    uint16_t mask0 = 0;
+    uint32_t mask1 = 0;
+    uint64_t mask2 = 0;
+    size_t maxOffset = static_cast<size_t>(parity.count - 1) * parity.stride;
+    for (size_t i = 0; i < parity.count; ++i) {
+        size_t offset = i * parity.stride;
+        if (offset < 15) {
+            mask0 |= static_cast<uint16_t>(1U << (14 - offset));
+        } else if (offset < 46) {
+            mask1 |= 1U << (30 - (offset - 15));
+        } else {
+            mask2 |= 1ULL << (62 - (offset - 46));
+        }
+    }
+
+    if (maxOffset < 15) {
+        WriteU16(out + 10, mask0 | 0x8000);
+        return 12;
+    }
+    WriteU16(out + 10, mask0);
+    if (maxOffset < 46) {
+        WriteU32(out + 12, mask1 | 0x80000000U);
+        return 16;
+    }
+    WriteU32(out + 12, mask1);
+    WriteU32(out + 16, static_cast<uint32_t>((mask2 | 0x8000000000000000ULL) >> 32));
+    WriteU32(out + 20, static_cast<uint32_t>(mask2));
+    return 24;
+}
+
+size_t FecEncoder::WriteUlpFecHeader(const Parity &parity, uint8_t *out) const
+{
+    // RFC 5109 section 7.3 FEC header followed by the level 0 header of section 7.4
+    bool longMask = static_cast<size_t>(parity.count - 1) * parity.stride >= 16;
+    out[0] = static_cast<uint8_t>((parity.header[0] & 0x3F) | (longMask ? 0x40 : 0));
+    out[1] = parity.header[1];
+    WriteU16(out + 2, parity.base);
+    WriteU32(out + 4, parity.timestamp);
+    WriteU16(out + 8, parity.length);
+    WriteU16(out + 10, static_cast<uint16_t>(parity.size));
+
+    uint64_t mask = 0;
+    for (size_t i = 0; i < parity.count; ++i) {
+        mask |= 1ULL << (47 - i * parity.stride);
+    }
+    WriteU16(out + 12, static_cast<uint16_t>(mask >> 32));
+    if (!longMask) {
+        return 14;
+    }
+    WriteU32(out + 14, static_cast<uint32_t>(mask));
+    return 18;
+}
+
+const uint8_t *FecEncoder::Finish(Parity &parity, size_t &size)
+{
+    bool flexfec = config_.scheme == FecScheme::FLEXFEC;
+    // FlexFEC names the protected SSRC in the single CSRC of the repair packet
+    size_t rtpHeaderSize = kRtpHeaderSize + (flexfec ? 4 : 0);
+
+    uint8_t header[kHeaderRoom];
+    header[0] = flexfec ? 0x81 : 0x80;
+    header[1] = config_.payload_type & 0x7F;
+    WriteU16(header + 2, sequence_++);
+    WriteU32(header + 4, parity.last_timestamp);
+    WriteU32(header + 8, config_.ssrc);
+    if (flexfec) {
+        WriteU32(header + 12, mediaSsrc_);
+    }
+    uint8_t *fecHeader = header + rtpHeaderSize;
+    size_t headerSize = rtpHeaderSize + (flexfec ? WriteFlexFecHeader(parity, fecHeader)
+                                                 : WriteUlpFecHeader(parity, fecHeader));
+
+    // The parity payload already sits at kHeaderRoom, so only the headers move
+    uint8_t *packet = parity.buffer.data() + kHeaderRoom - headerSize;
+    memcpy(packet, header, headerSize);
+    size = headerSize + parity.size;
+
+    parity.count = 0;
+    return packet;
+}
+
+size_t FecEncoder::AddPacket(const uint8_t *packet, size_t size, const PacketSink &sink)
+{
+    if (!packet || size < kRtpHeaderSize || size > kMaxPacketSize) {
+        return 0;
+    }
+
+    uint16_t seq = static_cast<uint16_t>((packet[2] << 8) | packet[3]);
+    if (index_ != 0 && seq != nextSequence_) {
+        RTP_LOGD("FecEncoder: sequence gap at %u, restarting block", seq);
+        index_ = 0;
+    }
+    nextSequence_ = static_cast<uint16_t>(seq + 1);
+    mediaSsrc_ = ReadU32(packet + 8);
+
+    size_t column = index_ % config_.columns;
+    size_t row = index_ / config_.columns;
+
+    if (column == 0) {
+        row_.count = 0;
+        row_.base = seq;
+        row_.stride = 1;
+    }
+    Accumulate(row_, packet, size);
+    size_t fecCount = 0;
+    size_t fecSize = 0;
+    if (column + 1 == config_.columns) {
+        const uint8_t *fec = Finish(row_, fecSize);
+        sink(fec, fecSize);
+        fecCount++;
+    }
+
+    if (config_.rows > 1) {
+        Parity &parity = columns_[column];
+        if (row == 0) {
+            parity.count = 0;
+            parity.base = seq;
+            parity.stride = config_.columns;
+        }
+        Accumulate(parity, packet, size);
+        if (row + 1 == config_.rows && column + 1 == config_.columns) {
+            for (auto &columnParity : columns_) {
+                const uint8_t *fec = Finish(columnParity, fecSize);
+                sink(fec, fecSize);
+                fecCount++;
+            }
+        }
+    }
+
+    index_ = (index_ + 1) % (static_cast<size_t>(config_.columns) * config_.rows);
+    return fecCount;
+}
+
+} // namespace lmshao::lmrtp
@@ -0,0 +1,392 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtp/rtcp_packet.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#include "internal_logger.h"
+
+namespace lmshao::lmrtp {
+
+namespace {
+
+constexpr size_t kRtcpHeaderSize = 4;
+constexpr size_t kSenderInfoSize = 20;
+constexpr size_t kReportBlockSize = 24;
+constexpr uint8_t kSdesItemEnd = 0;
+constexpr uint8_t kSdesItemCname = 1;
+
+// Seconds between the NTP epoch (1900) and the Unix epoch (1970)
+constexpr uint64_t kNtpUnixEpochOffset = 2208988800ULL;
+
+inline uint32_t ReadU32(const uint8_t *p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline uint16_t ReadU16(const uint8_t *p)
+{
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+inline void WriteU32(uint8_t *p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+void WriteReportBlock(uint8_t *p, const RtcpReportBlock &block)
+{
+    WriteU32(p, block.ssrc);
+    // Cumulative loss saturates at the limits of its signed 24-bit field
+    int32_t lost = std::clamp<int32_t>(block.cumulative_lost, -0x800000, 0x7FFFFF);
+    WriteU32(p + 4, (static_cast<uint32_t>(block.fraction_lost) << 24) | (static_cast<uint32_t>(lost) & 0xFFFFFF));
+    WriteU32(p + 8, block.extended_highest_seq);
+    WriteU32(p + 12, block.jitter);
+    WriteU32(p + 16, block.lsr);
+    WriteU32(p + 20, block.dlsr);
+}
+
+void ParseReportBlock(const uint8_t *p, RtcpReportBlock &block)
+{
+    block.ssrc = ReadU32(p);
+    block.fraction_lost = p[4];
+    // Sign-extend the 24-bit cumulative loss
+    int32_t lost = (static_cast<int32_t>(p[5]) << 16) | (p[6] << 8) | p[7];
+    if (lost & 0x800000) {
+        lost |= static_cast<int32_t>(0xFF000000);
+    }
+    block.cumulative_lost = lost;
+    block.extended_highest_seq = ReadU32(p + 8);
+    block.jitter = ReadU32(p + 12);
+    block.lsr = ReadU32(p + 16);
+    block.dlsr = ReadU32(p + 20);
+}
+
+bool ParseReport(const uint8_t *body, size_t body_size, uint8_t count, bool sender, RtcpReport &report)
+{
+    size_t needed = 4 + (sender ? kSenderInfoSize : 0) + count * kReportBlockSize;
+    if (body_size < needed) {
+        return false;
+    }
+
+    report.ssrc = ReadU32(body);
+    report.has_sender_info = sender;
+    const uint8_t *p = body + 4;
+    if (sender) {
+        report.sender_info.ntp_msw = ReadU32(p);
+        report.sender_info.ntp_lsw = ReadU32(p + 4);
+        report.sender_info.rtp_timestamp = ReadU32(p + 8);
+        report.sender_info.packet_count = ReadU32(p + 12);
+        report.sender_info.octet_count = ReadU32(p + 16);
+        p += kSenderInfoSize;
+    }
+
+    report.report_count = count;
+    for (uint8_t i = 0; i < count; ++i) {
+        ParseReportBlock(p, report.report_blocks[i]);
+        p += kReportBlockSize;
+    }
+    return true;
+}
+
+bool ParseSdes(const uint8_t *body, size_t body_size, uint8_t count, IRtcpListener *listener)
+{
+    const uint8_t *p = body;
+    const uint8_t *end = body + body_size;
+
+    for (uint8_t chunk = 0; chunk < count; ++chunk) {
+        if (end - p < 4) {
+            return false;
+        }
+        uint32_t ssrc = ReadU32(p);
+        const uint8_t *item = p + 4;
+
+        // Items run until a null item; the chunk is then padded to a 32-bit boundary
+        while (item < end && *item != kSdesItemEnd) {
+            if (end - item < 2) {
+                return false;
+            }
+            uint8_t type = item[0];
+            uint8_t length = item[1];
+            if (static_cast<size_t>(end - item) < 2u + length) {
+                return false;
+            }
+            if (type == kSdesItemCname) {
+                listener->OnSourceDescription(ssrc, reinterpret_cast<const char *>(item + 2), length);
+            }
+            item += 2 + length;
+        }
+
+        // Skip the terminating null octet(s) up to the next word boundary
+        size_t consumed = static_cast<size_t>(item - p) + 1;
+        consumed = (consumed + 3) & ~static_cast<size_t>(3);
+        if (consumed > static_cast<size_t>(end - p)) {
+            return false;
+        }
+        p += consumed;
+    }
+    return true;
+}
+
+bool ParseTransportFeedback(const uint8_t *body, size_t body_size, uint8_t fmt, IRtcpListener *listener)
+{
+    if (body_size < 8) {
+        return false;
+    }
+    if (fmt != kRtcpFmtGenericNack) {
+        return true;
+    }
+
+    RtcpNack nack;
+    nack.sender_ssrc = ReadU32(body);
+    nack.media_ssrc = ReadU32(body + 4);
+    for (size_t offset = 8; offset + 4 <= body_size; offset += 4) {
+        nack.pid = ReadU16(body + offset);
+        nack.blp = ReadU16(body + offset + 2);
+        listener->OnNack(nack);
+    }
+    return true;
+}
+
+bool ParsePayloadFeedback(const uint8_t *body, size_t body_size, uint8_t fmt, IRtcpListener *listener)
+{
+    if (body_size < 8) {
+        return false;
+    }
+
+    uint32_t sender_ssrc = ReadU32(body);
+    if (fmt == kRtcpFmtPli) {
+        listener->OnPictureLoss(sender_ssrc, ReadU32(body + 4));
+    } else if (fmt == kRtcpFmtFir) {
+        // The media source SSRC of a FIR is unused, each FCI entry names the target SSRC
+        for (size_t offset = 8; offset + 8 <= body_size; offset += 8) {
+            listener->OnFullIntraRequest(sender_ssrc, ReadU32(body + offset), body[offset + 4]);
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool RtcpParser::IsRtcp(const uint8_t *data, size_t size)
+{
+    if (size < kRtcpHeaderSize) {
+        return false;
+    }
+    // RTCP packet types 192-223 collide with RTP payload types 64-95 with the marker bit set
+    return (data[0] >> 6) == 2 && data[1] >= 192 && data[1] <= 223;
+}
+
+bool RtcpCompoundReader::Next(RtcpPacketView &packet)
+{
+    if (error_ || offset_ + kRtcpHeaderSize > size_) {
+        // Trailing bytes too short for a header make the compound packet malformed
+        error_ = error_ || offset_ != size_;
+        return false;
+    }
+
+    const uint8_t *header = data_ + offset_;
+    uint8_t version = header[0] >> 6;
+    bool padding = (header[0] & 0x20) != 0;
+    size_t packet_size = (static_cast<size_t>(ReadU16(header + 2)) + 1) * 4;
+
+    if (version != 2) {
+        RTP_LOGW("RtcpParser: invalid version %u", version);
+        error_ = true;
+        return false;
+    }
+    if (offset_ + packet_size > size_) {
+        RTP_LOGW("RtcpParser: truncated packet, type %u, length %zu", header[1], packet_size);
+        error_ = true;
+        return false;
+    }
+
+    size_t body_size = packet_size - kRtcpHeaderSize;
+    if (padding) {
+        // The last octet holds the padding count, including itself
+        uint8_t pad = header[packet_size - 1];
+        if (pad == 0 || pad > body_size) {
+            error_ = true;
+            return false;
+        }
+        body_size -= pad;
+    }
+
+    packet.packet_type = header[1];
+    packet.count = header[0] & 0x1F;
+    packet.body = header + kRtcpHeaderSize;
+    packet.body_size = body_size;
+    offset_ += packet_size;
+    return true;
+}
+
+uint8_t *RtcpBuilder::Begin(uint8_t count, RtcpPacketType type, size_t packet_size)
+{
+    if (!buffer_ || size_ + packet_size > capacity_) {
+        return nullptr;
+    }
+    uint8_t *p = buffer_ + size_;
+    uint16_t length = static_cast<uint16_t>(packet_size / 4 - 1);
+    p[0] = static_cast<uint8_t>(0x80 | count);
+    p[1] = static_cast<uint8_t>(type);
+    p[2] = static_cast<uint8_t>(length >> 8);
+    p[3] = static_cast<uint8_t>(length);
+    size_ += packet_size;
+    return p + kRtcpHeaderSize;
+}
+
+bool RtcpBuilder::AddSenderReport(uint32_t ssrc, const RtcpSenderInfo &info, const RtcpReportBlock *blocks,
+                                  size_t block_count)
+{
+    if (block_count > kRtcpMaxReportBlocks) {
+        return false;
+    }
+    size_t packet_size = kRtcpHeaderSize + 4 + kSenderInfoSize + block_count * kReportBlockSize;
+    uint8_t *p = Begin(static_cast<uint8_t>(block_count), RtcpPacketType::SR, packet_size);
+    if (!p) {
+        return false;
+    }
+
+    WriteU32(p, ssrc);
+    WriteU32(p + 4, info.ntp_msw);
+    WriteU32(p + 8, info.ntp_lsw);
+    WriteU32(p + 12, info.rtp_timestamp);
+    WriteU32(p + 16, info.packet_count);
+    WriteU32(p + 20, info.octet_count);
+    p += 4 + kSenderInfoSize;
+    for (size_t i = 0; i < block_count; ++i) {
+        WriteReportBlock(p + i * kReportBlockSize, blocks[i]);
+    }
+    return true;
+}
+
+bool RtcpBuilder::AddReceiverReport(uint32_t ssrc, const RtcpReportBlock *blocks, size_t block_count)
+{
+    if (block_count > kRtcpMaxReportBlocks) {
+        return false;
+    }
+    size_t packet_size = kRtcpHeaderSize + 4 + block_count * kReportBlockSize;
+    uint8_t *p = Begin(static_cast<uint8_t>(block_count), RtcpPacketType::RR, packet_size);
+    if (!p) {
+        return false;
+    }
+
+    WriteU32(p, ssrc);
+    for (size_t i = 0; i < block_count; ++i) {
+        WriteReportBlock(p + 4 + i * kReportBlockSize, blocks[i]);
+    }
+    return true;
+}
+
+bool RtcpBuilder::AddSourceDescription(uint32_t ssrc, const char *cname, size_t cname_length)
+{
+    if (cname_length > 255) {
+        return false;
+    }
+    // SSRC, CNAME item, then at least one null octet padding the chunk to a 32-bit boundary
+    size_t chunk_size = (4 + 2 + cname_length + 1 + 3) & ~static_cast<size_t>(3);
+    uint8_t *p = Begin(1, RtcpPacketType::SDES, kRtcpHeaderSize + chunk_size);
+    if (!p) {
+        return false;
+    }
+
+    WriteU32(p, ssrc);
+    p[4] = kSdesItemCname;
+    p[5] = static_cast<uint8_t>(cname_length);
+    memcpy(p + 6, cname, cname_length);
+    memset(p + 6 + cname_length, kSdesItemEnd, chunk_size - 6 - cname_length);
+    return true;
+}
+
+bool RtcpBuilder::AddBye(uint32_t ssrc)
+{
+    uint8_t *p = Begin(1, RtcpPacketType::BYE, kRtcpHeaderSize + 4);
+    if (!p) {
+        return false;
+    }
+    WriteU32(p, ssrc);
+    return true;
+}
+
+bool RtcpParser::Parse(const uint8_t *data, size_t size, IRtcpListener *listener)
+{
+    if (!data || !listener) {
+        return false;
+    }
+
+    RtcpReport report;
+    RtcpCompoundReader reader(data, size);
+    RtcpPacketView packet;
+
+    while (reader.Next(packet)) {
+        const uint8_t *body = packet.body;
+        size_t body_size = packet.body_size;
+        uint8_t count = packet.count;
+
+        switch (static_cast<RtcpPacketType>(packet.packet_type)) {
+            case RtcpPacketType::SR:
+                if (!ParseReport(body, body_size, count, true, report)) {
+                    return false;
+                }
+                listener->OnSenderReport(report);
+                break;
+            case RtcpPacketType::RR:
+                if (!ParseReport(body, body_size, count, false, report)) {
+                    return false;
+                }
+                listener->OnReceiverReport(report);
+                break;
+            case RtcpPacketType::SDES:
+                if (!ParseSdes(body, body_size, count, listener)) {
+                    return false;
+                }
+                break;
+            case RtcpPacketType::BYE:
+                if (body_size < count * 4u) {
+                    return false;
+                }
+                for (uint8_t i = 0; i < count; ++i) {
+                    listener->OnBye(ReadU32(body + i * 4));
+                }
+                break;
+            case RtcpPacketType::RTPFB:
+                if (!ParseTransportFeedback(body, body_size, count, listener)) {
+                    return false;
+                }
+                break;
+            case RtcpPacketType::PSFB:
+                if (!ParsePayloadFeedback(body, body_size, count, listener)) {
+                    return false;
+                }
+                break;
+            default:
+                // APP and unknown packet types are skipped
+                break;
+        }
+    }
+
+    return !reader.Error();
+}
+
+uint64_t NtpNow()
+{
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+    uint64_t seconds = static_cast<uint64_t>(micros / 1000000) + kNtpUnixEpochOffset;
+    uint64_t fraction = (static_cast<uint64_t>(micros % 1000000) << 32) / 1000000;
+    return (seconds << 32) | fraction;
+}
+
+} // namespace lmshao::lmrtp
@@ -0,0 +1,90 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtp/rtp_packet_history.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "internal_logger.h"
+
+namespace lmshao::lmrtp {
+
+namespace {
+
+constexpr uint32_t kDefaultBitrate = 4000000; // Used when the stream does not declare its bitrate
+constexpr size_t kAveragePacketSize = 1000;
+constexpr size_t kMinCapacity = 64;
+constexpr size_t kMaxCapacity = 8192;
+
+size_t RoundUpPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+size_t RtpPacketHistory::CapacityFor(uint32_t bitrate, uint32_t history_ms)
+{
+    uint64_t bits = static_cast<uint64_t>(bitrate ? bitrate : kDefaultBitrate) * history_ms / 1000;
+    // Double the estimate so keyframe bursts do not push packets out before their deadline
+    size_t packets = static_cast<size_t>(bits / 8 / kAveragePacketSize) * 2;
+    return RoundUpPowerOfTwo(std::clamp(packets, kMinCapacity, kMaxCapacity));
+}
+
+RtpPacketHistory::RtpPacketHistory(uint32_t bitrate, uint32_t history_ms) : history_ms_(history_ms)
+{
+    size_t capacity = CapacityFor(bitrate, history_ms);
+    mask_ = capacity - 1;
+    entries_.resize(capacity);
+    storage_.resize(capacity * kMaxPacketSize);
+    RTP_LOGD("RtpPacketHistory created: %zu packets for %u ms", capacity, history_ms);
+}
+
+void RtpPacketHistory::Put(const uint8_t *packet, size_t size, uint64_t now_ms)
+{
+    if (!packet || size < 12 || size > kMaxPacketSize) {
+        return;
+    }
+
+    uint16_t seq = static_cast<uint16_t>((packet[2] << 8) | packet[3]);
+    size_t index = seq & mask_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry &entry = entries_[index];
+    entry.seq = seq;
+    entry.size = static_cast<uint16_t>(size);
+    entry.send_time_ms = now_ms;
+    entry.resend_time_ms = 0;
+    entry.valid = true;
+    memcpy(&storage_[index * kMaxPacketSize], packet, size);
+}
+
+size_t RtpPacketHistory::GetForResend(uint16_t seq, uint64_t now_ms, uint32_t min_interval_ms, uint8_t *out)
+{
+    size_t index = seq & mask_;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry &entry = entries_[index];
+    if (!entry.valid || entry.seq != seq || now_ms - entry.send_time_ms > history_ms_) {
+        return 0;
+    }
+    if (entry.resend_time_ms != 0 && now_ms - entry.resend_time_ms < min_interval_ms) {
+        return 0;
+    }
+
+    entry.resend_time_ms = now_ms;
+    memcpy(out, &storage_[index * kMaxPacketSize], entry.size);
+    return entry.size;
+}
+
+} // namespace lmshao::lmrtp
@@ -0,0 +1,157 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "xor_kernel.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#define LMRTP_XOR_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+// MSVC emits any intrinsic without per-function target flags
+#define LMRTP_TARGET(isa)
+#else
+#define LMRTP_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace lmshao::lmrtp {
+
+namespace {
+
+using XorFunction = void (*)(uint8_t *dst, const uint8_t *src, size_t size);
+
+struct XorKernel {
+    XorFunction function;
+    const char *name;
+};
+
+// Word-at-a-time from offset i, memcpy keeps unaligned access well-defined
+void XorTail(uint8_t *dst, const uint8_t *src, size_t i, size_t size)
+{
+    for (; i + 8 <= size; i += 8) {
+        uint64_t a;
+        uint64_t b;
+        memcpy(&a, dst + i, 8);
+        memcpy(&b, src + i, 8);
+        a ^= b;
+        memcpy(dst + i, &a, 8);
+    }
+    for (; i < size; ++i) {
+        dst[i] ^= src[i];
+    }
+}
+
+void XorScalar(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    XorTail(dst, src, 0, size);
+}
+
+#if defined(LMRTP_XOR_X86)
+LMRTP_TARGET("avx2") void XorAvx2(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_xor_si256(a, b));
+    }
+    XorTail(dst, src, i, size);
+}
+
+LMRTP_TARGET("sse2") void XorSse2(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_xor_si128(a, b));
+    }
+    XorTail(dst, src, i, size);
+}
+
+// CPU and OS support, the latter so that YMM state is actually saved on context switches
+bool CpuHasAvx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool CpuHasSse2()
+{
+#if defined(_MSC_VER) || defined(__SSE2__)
+    return true;
+#else
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+void XorNeon(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        vst1q_u8(dst + i, veorq_u8(vld1q_u8(dst + i), vld1q_u8(src + i)));
+    }
+    XorTail(dst, src, i, size);
+}
+#endif
+
+// x86 builds pick the widest unit of the running CPU, so a portable binary still gets AVX2
+XorKernel SelectKernel()
+{
+#if defined(LMRTP_XOR_X86)
+    if (CpuHasAvx2()) {
+        return {XorAvx2, "avx2"};
+    }
+    if (CpuHasSse2()) {
+        return {XorSse2, "sse2"};
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    return {XorNeon, "neon"};
+#endif
+    return {XorScalar, "scalar"};
+}
+
+const XorKernel &Kernel()
+{
+    static const XorKernel kernel = SelectKernel();
+    return kernel;
+}
+
+} // namespace
+
+void XorInto(uint8_t *dst, const uint8_t *src, size_t size)
+{
+    Kernel().function(dst, src, size);
+}
+
+const char *XorKernelName()
+{
+    return Kernel().name;
+}
+
+} // namespace lmshao::lmrtp
@@ -0,0 +1,25 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTP_XOR_KERNEL_H
+#define LMSHAO_LMRTP_XOR_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lmshao::lmrtp {
+
+// dst[i] ^= src[i] for size bytes, using the widest vector unit of the running CPU.
+void XorInto(uint8_t *dst, const uint8_t *src, size_t size);
+
+// Name of the kernel selected on first use, for logging.
+const char *XorKernelName();
+
+} // namespace lmshao::lmrtp
+
+#endif // LMSHAO_LMRTP_XOR_KERNEL_H
@@ -0,0 +1,101 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "admission_control.h"
+
+#include <algorithm>
+
+namespace lmshao::lmrtsp {
+
+void AdmissionControl::SetLimits(const AdmissionLimits &limits)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    limits_ = limits;
+    bucketPrimed_ = false;
+}
+
+AdmissionLimits AdmissionControl::GetLimits() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limits_;
+}
+
+bool AdmissionControl::AdmitConnection(uint64_t now_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (limits_.max_connections != 0 && connections_ >= limits_.max_connections) {
+        return Refuse();
+    }
+
+    if (limits_.max_accepts_per_second != 0) {
+        // Token bucket holding one second of accepts, refilled continuously
+        uint64_t capacity = limits_.max_accepts_per_second * kTokenScale;
+        if (!bucketPrimed_) {
+            acceptTokens_ = capacity;
+            lastRefillMs_ = now_ms;
+            bucketPrimed_ = true;
+        } else if (now_ms > lastRefillMs_) {
+            uint64_t refill = (now_ms - lastRefillMs_) * limits_.max_accepts_per_second;
+            acceptTokens_ = std::min(capacity, acceptTokens_ + refill);
+            lastRefillMs_ = now_ms;
+        }
+        if (acceptTokens_ < kTokenScale) {
+            return Refuse();
+        }
+        acceptTokens_ -= kTokenScale;
+    }
+
+    ++connections_;
+    return true;
+}
+
+void AdmissionControl::ReleaseConnection()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (connections_ > 0) {
+        --connections_;
+    }
+}
+
+size_t AdmissionControl::Connections() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return connections_;
+}
+
+bool AdmissionControl::AdmitSession(size_t client_sessions)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (limits_.max_sessions_per_client != 0 && client_sessions >= limits_.max_sessions_per_client) {
+        return Refuse();
+    }
+    return true;
+}
+
+bool AdmissionControl::AdmitPlay(size_t stream_playing)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (limits_.max_playing_per_stream != 0 && stream_playing >= limits_.max_playing_per_stream) {
+        return Refuse();
+    }
+    return true;
+}
+
+uint32_t AdmissionControl::RetryAfter() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return limits_.retry_after_seconds;
+}
+
+bool AdmissionControl::Refuse()
+{
+    refused_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+} // namespace lmshao::lmrtsp
@@ -0,0 +1,56 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_ADMISSION_CONTROL_H
+#define LMSHAO_LMRTSP_ADMISSION_CONTROL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "admission_limits.h"
+
+namespace lmshao::lmrtsp {
+
+// Decides whether the server takes on more work. Connections are counted here, sessions and players are
+// counted by their owners and passed in.
+class AdmissionControl {
+public:
+    void SetLimits(const AdmissionLimits &limits);
+    AdmissionLimits GetLimits() const;
+
+    // Counts the connection if it is admitted, now_ms is any monotonic time in milliseconds
+    bool AdmitConnection(uint64_t now_ms);
+    void ReleaseConnection();
+    size_t Connections() const;
+
+    bool AdmitSession(size_t client_sessions);
+    bool AdmitPlay(size_t stream_playing);
+
+    uint32_t RetryAfter() const;
+    uint64_t Refused() const { return refused_.load(std::memory_order_relaxed); }
+
+private:
+    // Accept tokens are kept in thousandths so refilling needs no floating point
+    static constexpr uint64_t kTokenScale = 1000;
+
+    bool Refuse();
+
+    mutable std::mutex mutex_;
+    AdmissionLimits limits_;
+    size_t connections_ = 0;
+    uint64_t acceptTokens_ = 0;
+    uint64_t lastRefillMs_ = 0;
+    bool bucketPrimed_ = false;
+    std::atomic<uint64_t> refused_{0};
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_ADMISSION_CONTROL_H
@@ -0,0 +1,80 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "callback_dispatcher.h"
+
+#include <exception>
+
+#include "internal_logger.h"
+
+namespace lmshao::lmrtsp {
+
+CallbackDispatcher::CallbackDispatcher(Executor executor, size_t capacity)
+    : executor_(std::move(executor)), ring_(capacity > 0 ? capacity : 1)
+{
+}
+
+bool CallbackDispatcher::Post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == ring_.size()) {
+            return false;
+        }
+        ring_[(head_ + count_) % ring_.size()] = std::move(task);
+        ++count_;
+        if (draining_) {
+            return true;
+        }
+        draining_ = true;
+    }
+    executor_([self = shared_from_this()] { self->Drain(); });
+    return true;
+}
+
+size_t CallbackDispatcher::Pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+void CallbackDispatcher::Drain()
+{
+    for (size_t i = 0; i < kDrainBatch; ++i) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (count_ == 0) {
+                draining_ = false;
+                return;
+            }
+            task = std::move(ring_[head_]);
+            ring_[head_] = nullptr;
+            head_ = (head_ + 1) % ring_.size();
+            --count_;
+        }
+
+        // A throwing task must not stall the queue for good
+        try {
+            task();
+        } catch (const std::exception &e) {
+            RTSP_LOGE("Callback failed: %s", e.what());
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_ == 0) {
+            draining_ = false;
+            return;
+        }
+    }
+    executor_([self = shared_from_this()] { self->Drain(); });
+}
+
+} // namespace lmshao::lmrtsp
@@ -0,0 +1,53 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_CALLBACK_DISPATCHER_H
+#define LMSHAO_LMRTSP_CALLBACK_DISPATCHER_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lmshao::lmrtsp {
+
+// Bounded multi-producer queue that hands tasks to an application-owned executor.
+// Any thread may post; the queue asks the executor to run at most one drain at a time, so tasks run in posting
+// order and never concurrently. A drain runs a bounded batch and then re-posts itself to share the executor.
+class CallbackDispatcher : public std::enable_shared_from_this<CallbackDispatcher> {
+public:
+    using Task = std::function<void()>;
+    // Runs the given task, typically by posting it to a thread pool or event loop
+    using Executor = std::function<void(Task)>;
+
+    static constexpr size_t kDefaultCapacity = 1024;
+    static constexpr size_t kDrainBatch = 64;
+
+    CallbackDispatcher(Executor executor, size_t capacity = kDefaultCapacity);
+
+    // Returns false and drops the task when the queue is full
+    bool Post(Task task);
+
+    size_t Pending() const;
+    size_t Capacity() const { return ring_.size(); }
+
+private:
+    void Drain();
+
+    Executor executor_;
+    mutable std::mutex mutex_;
+    std::vector<Task> ring_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    bool draining_ = false; // A drain is queued on or running in the executor
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_CALLBACK_DISPATCHER_H
@@ -0,0 +1,72 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "egress_budget.h"
+
+#include <algorithm>
+
+namespace lmshao::lmrtsp {
+
+void EgressBudget::SetCapacity(uint64_t bits_per_second)
+{
+    capacity_.store(bits_per_second, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(bucketMutex_);
+    bucketPrimed_ = false;
+}
+
+bool EgressBudget::Reserve(uint64_t bitrate)
+{
+    uint64_t capacity = capacity_.load(std::memory_order_relaxed);
+    uint64_t reserved = reserved_.load(std::memory_order_relaxed);
+    do {
+        if (capacity != 0 && (bitrate > capacity || reserved > capacity - bitrate)) {
+            return false;
+        }
+    } while (!reserved_.compare_exchange_weak(reserved, reserved + bitrate, std::memory_order_relaxed));
+    return true;
+}
+
+void EgressBudget::Release(uint64_t bitrate)
+{
+    uint64_t reserved = reserved_.load(std::memory_order_relaxed);
+    while (!reserved_.compare_exchange_weak(reserved, reserved - std::min(reserved, bitrate),
+                                            std::memory_order_relaxed)) {
+    }
+}
+
+bool EgressBudget::Consume(size_t bytes, uint64_t now_us)
+{
+    uint64_t capacity = capacity_.load(std::memory_order_relaxed);
+    if (capacity == 0) {
+        return true;
+    }
+
+    uint64_t bytesPerSecond = capacity / 8;
+    auto burst = static_cast<int64_t>(bytesPerSecond * kBurstMs / 1000);
+    std::lock_guard<std::mutex> lock(bucketMutex_);
+    if (!bucketPrimed_) {
+        tokens_ = burst;
+        lastRefillUs_ = now_us;
+        bucketPrimed_ = true;
+    } else if (now_us > lastRefillUs_) {
+        auto refill = static_cast<int64_t>((now_us - lastRefillUs_) * bytesPerSecond / 1000000);
+        if (refill > 0) {
+            tokens_ = std::min(burst, tokens_ + refill);
+            lastRefillUs_ = now_us;
+        }
+    }
+
+    if (tokens_ <= 0) {
+        droppedBytes_.fetch_add(bytes, std::memory_order_relaxed);
+        return false;
+    }
+    tokens_ -= static_cast<int64_t>(bytes);
+    return true;
+}
+
+} // namespace lmshao::lmrtsp
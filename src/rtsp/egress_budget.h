@@ -0,0 +1,54 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_EGRESS_BUDGET_H
+#define LMSHAO_LMRTSP_EGRESS_BUDGET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace lmshao::lmrtsp {
+
+// Server-wide egress accounting against a capacity in bits per second, 0 meaning unlimited.
+// Players reserve their stream's declared bitrate up front, so the server refuses the viewer that would not fit
+// instead of degrading all of them. Senders also draw the bytes they actually send from a token bucket refilled
+// at the capacity, which catches streams sending more than they declared.
+class EgressBudget {
+public:
+    // Bytes the bucket can save up, as time at full capacity
+    static constexpr uint64_t kBurstMs = 200;
+
+    void SetCapacity(uint64_t bits_per_second);
+    uint64_t GetCapacity() const { return capacity_.load(std::memory_order_relaxed); }
+
+    // False if the bitrate does not fit next to the current reservations
+    bool Reserve(uint64_t bitrate);
+    void Release(uint64_t bitrate);
+    uint64_t Reserved() const { return reserved_.load(std::memory_order_relaxed); }
+
+    // Take bytes about to be sent, now_us is any monotonic time in microseconds. A frame is let through while
+    // the bucket is not in debt, so frames larger than the burst still pass when the link is idle.
+    bool Consume(size_t bytes, uint64_t now_us);
+    uint64_t DroppedBytes() const { return droppedBytes_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> capacity_{0};
+    std::atomic<uint64_t> reserved_{0};
+    std::atomic<uint64_t> droppedBytes_{0};
+
+    std::mutex bucketMutex_;
+    int64_t tokens_ = 0; // Bytes, negative while in debt
+    uint64_t lastRefillUs_ = 0;
+    bool bucketPrimed_ = false;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_EGRESS_BUDGET_H
@@ -8,15 +8,64 @@
 
 #include "media_stream.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <vector>
 
 #include "internal_logger.h"
+#include "lmrtp/aac_packetizer.h"
 #include "lmrtp/h264_packetizer.h"
+#include "lmrtp/rtp_sequence.h"
+#include "rtcp_receiver_stats.h"
+#include "rtsp_server.h"
 #include "rtsp_session.h"
+#include "rtsp_transport.h"
+#include "session_id.h"
 
 namespace lmshao::lmrtsp {
 
+namespace {
+
+// Lower bound for the interval between two retransmissions of the same packet when no RTT is known yet
+constexpr uint32_t kMinResendIntervalMs = 5;
+
+constexpr uint64_t kSenderReportIntervalMs = 1000;
+constexpr size_t kRtpHeaderSize = 12;
+constexpr char kRtcpCname[] = "lmrtsp";
+// SR with no report blocks, SDES CNAME and BYE
+constexpr size_t kRtcpReportBufferSize = 128;
+
+uint64_t SteadyNowMillis()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+}
+
+uint64_t SteadyNowMicros()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+uint32_t ReadBigEndian32(const uint8_t *p)
+{
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+// Size of the fixed header, CSRC list and header extension of a serialized RTP packet, 0 if malformed
+size_t RtpHeaderSize(const uint8_t *packet, size_t size)
+{
+    size_t header = 12 + (packet[0] & 0x0F) * 4;
+    if ((packet[0] & 0x10) && header + 4 <= size) {
+        header += 4 + ((packet[header + 2] << 8) | packet[header + 3]) * 4;
+    }
+    return header <= size ? header : 0;
+}
+
+} // namespace
+
 // MediaStream base class implementation
 MediaStream::MediaStream(const std::string &uri, const std::string &mediaType)
     : uri_(uri), mediaType_(mediaType), state_(StreamState::INIT)
@@ -62,7 +111,7 @@ void MediaStream::SetTrackIndex(int index)
 // RTPStream implementation
 RTPStream::RTPStream(const std::string &uri, const std::string &mediaType)
     : MediaStream(uri, mediaType), clientRtpPort_(0), clientRtcpPort_(0), serverRtpPort_(0), serverRtcpPort_(0),
-      sequenceNumber_(0), timestamp_(0), isActive_(false)
+      sequenceNumber_(0), timestamp_(0), isActive_(false), rtcpStats_(std::make_unique<RTCPReceiverStats>())
 {
 }
 
@@ -79,43 +128,60 @@ bool RTPStream::Setup(const std::string &transport, const std::string &client_ip
 
     // Parse Transport header
     // Example: Transport: RTP/AVP;unicast;client_port=4588-4589
-
-    // Check transport type
-    if (transport.find("RTP/AVP") == std::string::npos) {
-        RTSP_LOGE("Unsupported transport protocol");
+    // This stream sends over UDP unicast only
+    TransportSupport support;
+    support.tcp = false;
+    TransportOffer offer;
+    const TransportSpec *spec = ParseTransport(transport, offer) ? SelectTransport(offer, support) : nullptr;
+    if (!spec) {
+        RTSP_LOGE("No unicast RTP/AVP transport with client_port offered");
         return false;
     }
+    clientRtpPort_ = spec->client_rtp_port;
+    clientRtcpPort_ = spec->client_rtcp_port;
+    RTSP_LOGD("Client ports: RTP=%d, RTCP=%d", clientRtpPort_, clientRtcpPort_);
 
-    // Check if it's unicast
-    bool isUnicast = (transport.find("unicast") != std::string::npos);
-    if (!isUnicast) {
-        RTSP_LOGE("Only unicast mode is supported");
-        return false;
+    std::shared_ptr<MediaStreamInfo> info;
+    if (auto session = session_.lock()) {
+        info = session->GetMediaStreamInfo();
     }
 
-    // Parse client ports
-    size_t clientPortPos = transport.find("client_port=");
-    if (clientPortPos != std::string::npos) {
-        size_t portStart = clientPortPos + 12; // Length of "client_port="
-        size_t portEnd = transport.find(';', portStart);
-        if (portEnd == std::string::npos) {
-            portEnd = transport.length();
-        }
-
-        std::string portRange = transport.substr(portStart, portEnd - portStart);
-        size_t dashPos = portRange.find('-');
+    // Packetizer for the registered codec, H.264 when the stream is not registered
+    ssrc_ = info && info->ssrc != 0 ? info->ssrc : static_cast<uint32_t>(SessionId::Generate());
+    uint32_t mtu = info ? info->max_packet_size : 1400;
+    if (info && (info->codec == "AAC" || info->codec == "MPEG4-GENERIC")) {
+        packetizer_ = std::make_unique<AacPacketizer>(ssrc_, 0, 0, mtu);
+    } else {
+        packetizer_ = std::make_unique<H264Packetizer>(ssrc_, 0, 0, mtu);
+    }
+    keyframeRequests_ = info && info->media_type == "video" && info->keyframe_requests;
+    // Audio is announced at its sample rate, see the SDP
+    if (info) {
+        clockRate_ = info->media_type == "audio" && info->sample_rate != 0 ? info->sample_rate : info->clock_rate;
+    }
 
-        if (dashPos != std::string::npos) {
-            clientRtpPort_ = std::stoi(portRange.substr(0, dashPos));
-            clientRtcpPort_ = std::stoi(portRange.substr(dashPos + 1));
-            RTSP_LOGD("Client ports: RTP=%d, RTCP=%d", clientRtpPort_, clientRtcpPort_);
-        } else {
-            RTSP_LOGE("Invalid client_port format");
-            return false;
+    // Packet history has to exist before the RTCP server can deliver NACKs
+    if (info) {
+        if (info->nack_history_ms > 0) {
+            history_ = std::make_unique<RtpPacketHistory>(info->bitrate, info->nack_history_ms);
+            // RTX packets must not go out with SSRC 0
+            if (info->rtx_payload_type != 0 && info->rtx_ssrc != 0) {
+                rtxPayloadType_ = info->rtx_payload_type;
+                rtxSsrc_ = info->rtx_ssrc;
+            } else if (info->rtx_payload_type != 0) {
+                RTSP_LOGW("RTX payload type %u without rtx_ssrc, retransmitting with the original SSRC",
+                          info->rtx_payload_type);
+            }
+        }
+        if (!info->fec_scheme.empty() && info->fec_payload_type != 0) {
+            FecConfig fecConfig;
+            fecConfig.scheme = info->fec_scheme == "ulpfec" ? FecScheme::ULPFEC : FecScheme::FLEXFEC;
+            fecConfig.payload_type = info->fec_payload_type;
+            fecConfig.ssrc = info->fec_ssrc;
+            fecConfig.columns = info->fec_columns;
+            fecConfig.rows = info->fec_rows;
+            fecEncoder_ = std::make_unique<FecEncoder>(fecConfig);
         }
-    } else {
-        RTSP_LOGE("Missing client_port parameter");
-        return false;
     }
 
     // Allocate server ports
@@ -154,8 +220,9 @@ bool RTPStream::Setup(const std::string &transport, const std::string &client_ip
     }
 
     // Save transport information
-    transportInfo_ =
-        transport + ";server_port=" + std::to_string(serverRtpPort_) + "-" + std::to_string(serverRtcpPort_);
+    transportInfo_.clear();
+    AppendTransport(transportInfo_, *spec);
+    transportInfo_ += ";server_port=" + std::to_string(serverRtpPort_) + "-" + std::to_string(serverRtcpPort_);
 
     // Update state
     state_ = StreamState::READY;
@@ -175,8 +242,11 @@ bool RTPStream::Play(const std::string &range)
 
     if (auto session = session_.lock()) {
         RTSP_LOGD("Session is valid, ready to send frames for track %d", track_index_);
-        isActive_ = true;
-        send_thread_ = std::thread(&RTPStream::SendMedia, this);
+        // Resuming after PAUSE keeps the send thread that is already running
+        if (!send_thread_.joinable()) {
+            isActive_ = true;
+            send_thread_ = std::thread(&RTPStream::SendMedia, this);
+        }
     } else {
         RTSP_LOGE("Session is expired, cannot play stream");
         return false;
@@ -221,6 +291,7 @@ bool RTPStream::Teardown()
     if (send_thread_.joinable()) {
         send_thread_.join();
     }
+    SendRtcpReport(true);
 
     if (rtp_server_) {
         rtp_server_->Stop();
@@ -258,7 +329,21 @@ std::string RTPStream::GetTransportInfo() const
     return transportInfo_;
 }
 
+RTPStatistics RTPStream::GetStatistics() const
+{
+    RTPStatistics stats = rtcpStats_->GetAggregate();
+    stats.packets_sent = packetsSent_.load(std::memory_order_relaxed);
+    stats.bytes_sent = bytesSent_.load(std::memory_order_relaxed);
+    stats.packets_retransmitted = packetsRetransmitted_.load(std::memory_order_relaxed);
+    return stats;
+}
+
 void RTPStream::PushFrame(MediaFrame &&frame)
+{
+    PushFrame(std::make_shared<const MediaFrame>(std::move(frame)));
+}
+
+void RTPStream::PushFrame(std::shared_ptr<const MediaFrame> frame)
 {
     std::unique_lock<std::mutex> lock(queue_mutex_);
     frame_queue_.push(std::move(frame));
@@ -268,7 +353,14 @@ void RTPStream::PushFrame(MediaFrame &&frame)
 
 void RTPStream::OnReceive(std::shared_ptr<lmnet::Session> session, std::shared_ptr<lmcore::DataBuffer> data)
 {
-    RTSP_LOGD("RTPStream received a packet");
+    if (!data || !RtcpParser::IsRtcp(data->Data(), data->Size())) {
+        RTSP_LOGD("RTPStream ignored a non-RTCP packet");
+        return;
+    }
+
+    if (!RtcpParser::Parse(data->Data(), data->Size(), this)) {
+        RTSP_LOGW("RTPStream received malformed RTCP packet from %s", session ? session->host.c_str() : "");
+    }
 }
 
 void RTPStream::OnClose(std::shared_ptr<lmnet::Session> session)
@@ -281,6 +373,151 @@ void RTPStream::OnError(std::shared_ptr<lmnet::Session> session, const std::stri
     RTSP_LOGE("RTPStream error: %s", error.c_str());
 }
 
+void RTPStream::OnSenderReport(const RtcpReport &report)
+{
+    // Clients that also send media carry their reception reports on SR packets
+    OnReceiverReport(report);
+}
+
+void RTPStream::OnReceiverReport(const RtcpReport &report)
+{
+    uint64_t now = NtpNow();
+    for (uint8_t i = 0; i < report.report_count; ++i) {
+        rtcpStats_->Update(report.report_blocks[i], now);
+    }
+
+    // Receiver reports keep a viewer's session alive just like RTSP requests do
+    if (auto session = session_.lock()) {
+        session->UpdateLastActiveTime();
+    }
+}
+
+void RTPStream::OnBye(uint32_t ssrc)
+{
+    RTSP_LOGD("RTPStream received RTCP BYE from SSRC 0x%08X", ssrc);
+}
+
+void RTPStream::OnNack(const RtcpNack &nack)
+{
+    if (!history_ || !rtp_client_) {
+        return;
+    }
+    if (nack.media_ssrc != ssrc_) {
+        RTSP_LOGD("RTPStream ignored NACK for SSRC 0x%08X from SSRC 0x%08X", nack.media_ssrc, nack.sender_ssrc);
+        return;
+    }
+
+    uint64_t now = SteadyNowMillis();
+    // Avoid resending the same packet again before the previous retransmission could have arrived
+    uint32_t minInterval = std::max(rtcpStats_->GetAggregate().rtt, kMinResendIntervalMs);
+
+    Retransmit(nack.pid, now, minInterval);
+    for (int bit = 0; bit < 16; ++bit) {
+        if (nack.blp & (1 << bit)) {
+            Retransmit(static_cast<uint16_t>(nack.pid + bit + 1), now, minInterval);
+        }
+    }
+}
+
+void RTPStream::Retransmit(uint16_t seq, uint64_t now_ms, uint32_t min_interval_ms)
+{
+    // Leave room for the 2-byte original sequence number of an RTX packet
+    uint8_t packet[RtpPacketHistory::kMaxPacketSize + 2];
+    size_t size = history_->GetForResend(seq, now_ms, min_interval_ms, packet);
+    if (size == 0) {
+        RTSP_LOGD("NACKed packet %u is no longer available", seq);
+        return;
+    }
+
+    if (rtxPayloadType_ != 0) {
+        // RFC 4588 section 4: original header with RTX payload type, sequence number and SSRC, then the OSN
+        size_t header = RtpHeaderSize(packet, size);
+        if (header == 0) {
+            return;
+        }
+        memmove(packet + header + 2, packet + header, size - header);
+        packet[header] = packet[2];
+        packet[header + 1] = packet[3];
+        packet[1] = static_cast<uint8_t>((packet[1] & 0x80) | (rtxPayloadType_ & 0x7F));
+        uint16_t rtxSeq = rtxSequence_.fetch_add(1, std::memory_order_relaxed);
+        packet[2] = static_cast<uint8_t>(rtxSeq >> 8);
+        packet[3] = static_cast<uint8_t>(rtxSeq);
+        packet[8] = static_cast<uint8_t>(rtxSsrc_ >> 24);
+        packet[9] = static_cast<uint8_t>(rtxSsrc_ >> 16);
+        packet[10] = static_cast<uint8_t>(rtxSsrc_ >> 8);
+        packet[11] = static_cast<uint8_t>(rtxSsrc_);
+        size += 2;
+    }
+
+    if (!rtp_client_->Send(packet, size)) {
+        RTSP_LOGE("Failed to retransmit RTP packet %u", seq);
+        return;
+    }
+    packetsRetransmitted_.fetch_add(1, std::memory_order_relaxed);
+    bytesSent_.fetch_add(size, std::memory_order_relaxed);
+}
+
+void RTPStream::OnPictureLoss(uint32_t sender_ssrc, uint32_t media_ssrc)
+{
+    if (!keyframeRequests_ || media_ssrc != ssrc_) {
+        RTSP_LOGD("RTPStream ignored PLI for SSRC 0x%08X from SSRC 0x%08X", media_ssrc, sender_ssrc);
+        return;
+    }
+    RTSP_LOGD("RTPStream received PLI from SSRC 0x%08X", sender_ssrc);
+    RequestKeyframe();
+}
+
+void RTPStream::OnFullIntraRequest(uint32_t sender_ssrc, uint32_t media_ssrc, uint8_t sequence)
+{
+    if (!keyframeRequests_ || media_ssrc != ssrc_) {
+        RTSP_LOGD("RTPStream ignored FIR for SSRC 0x%08X from SSRC 0x%08X", media_ssrc, sender_ssrc);
+        return;
+    }
+    RTSP_LOGD("RTPStream received FIR #%u from SSRC 0x%08X", sequence, sender_ssrc);
+    RequestKeyframe();
+}
+
+void RTPStream::RequestKeyframe()
+{
+    auto session = session_.lock();
+    if (!session) {
+        return;
+    }
+    auto server = session->GetRTSPServer().lock();
+    auto info = session->GetMediaStreamInfo();
+    if (server && info) {
+        server->RequestKeyframe(info->stream_path, session->GetClientIP());
+    }
+}
+
+void RTPStream::SendRtcpReport(bool bye)
+{
+    if (!rtcp_client_ || mediaSsrc_ == 0) {
+        return;
+    }
+
+    uint64_t ntp = NtpNow();
+    RtcpSenderInfo info;
+    info.ntp_msw = static_cast<uint32_t>(ntp >> 32);
+    info.ntp_lsw = static_cast<uint32_t>(ntp);
+    // The SR timestamp has to match the NTP time, not the time the last packet went out
+    uint64_t elapsed = lastRtpSendUs_ != 0 ? SteadyNowMicros() - lastRtpSendUs_ : 0;
+    info.rtp_timestamp = ExtrapolateTimestamp(lastRtpTimestamp_, elapsed, clockRate_);
+    info.packet_count = static_cast<uint32_t>(packetsSent_.load(std::memory_order_relaxed));
+    info.octet_count = payloadBytesSent_;
+
+    uint8_t buffer[kRtcpReportBufferSize];
+    RtcpBuilder builder(buffer, sizeof(buffer));
+    builder.AddSenderReport(mediaSsrc_, info);
+    builder.AddSourceDescription(mediaSsrc_, kRtcpCname, sizeof(kRtcpCname) - 1);
+    if (bye) {
+        builder.AddBye(mediaSsrc_);
+    }
+    if (!rtcp_client_->Send(builder.Data(), builder.Size())) {
+        RTSP_LOGW("Failed to send RTCP sender report");
+    }
+}
+
 void RTPStream::SendMedia()
 {
     RTSP_LOGD("SendMedia thread started");
@@ -293,18 +530,46 @@ void RTPStream::SendMedia()
             break;
         }
 
-        MediaFrame frame = std::move(frame_queue_.front());
+        auto frame = std::move(frame_queue_.front());
         frame_queue_.pop();
         lock.unlock();
 
         // Pack frame into RTP packets and send them
         if (packetizer_) {
-            auto packets = packetizer_->packetize(frame);
+            auto packets = packetizer_->packetize(*frame);
+            if (!ConsumeEgress(packets)) {
+                RTSP_LOGD("Egress budget exhausted, frame dropped");
+                continue;
+            }
             for (const auto &packet : packets) {
                 auto buffer = packet.serialize();
                 if (!rtp_client_->Send(buffer.data(), buffer.size())) {
                     RTSP_LOGE("Failed to send RTP packet");
+                    continue;
+                }
+                packetsSent_.fetch_add(1, std::memory_order_relaxed);
+                bytesSent_.fetch_add(buffer.size(), std::memory_order_relaxed);
+                payloadBytesSent_ += static_cast<uint32_t>(packet.payload.size());
+                // Take timestamp and SSRC from the wire so the SR matches what the client received
+                lastRtpTimestamp_ = ReadBigEndian32(buffer.data() + 4);
+                lastRtpSendUs_ = SteadyNowMicros();
+                mediaSsrc_ = ReadBigEndian32(buffer.data() + 8);
+                if (history_) {
+                    history_->Put(buffer.data(), buffer.size(), SteadyNowMillis());
                 }
+                if (fecEncoder_) {
+                    fecEncoder_->AddPacket(buffer.data(), buffer.size(), [this](const uint8_t *data, size_t size) {
+                        if (rtp_client_->Send(data, size)) {
+                            bytesSent_.fetch_add(size, std::memory_order_relaxed);
+                        }
+                    });
+                }
+            }
+
+            uint64_t now = SteadyNowMillis();
+            if (now - lastSenderReportMs_ >= kSenderReportIntervalMs) {
+                lastSenderReportMs_ = now;
+                SendRtcpReport(false);
             }
         } else {
             RTSP_LOGE("No packetizer available");
@@ -313,6 +578,21 @@ void RTPStream::SendMedia()
     RTSP_LOGD("SendMedia thread finished");
 }
 
+bool RTPStream::ConsumeEgress(const std::vector<RtpPacket> &packets)
+{
+    auto session = session_.lock();
+    auto server = session ? session->GetRTSPServer().lock() : nullptr;
+    if (!server) {
+        return true;
+    }
+    // Whole frames pass or drop, a partly sent frame would not decode anyway
+    size_t bytes = 0;
+    for (const auto &packet : packets) {
+        bytes += kRtpHeaderSize + packet.payload.size();
+    }
+    return server->ConsumeEgress(bytes, SteadyNowMicros());
+}
+
 // MediaStreamFactory implementation
 std::shared_ptr<MediaStream> MediaStreamFactory::CreateStream(const std::string &uri, const std::string &mediaType)
 {
@@ -0,0 +1,126 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "media_stream_registry.h"
+
+#include <algorithm>
+
+namespace lmshao::lmrtsp {
+
+bool MediaStreamRegistry::Entry::Subscribe(const std::shared_ptr<RTSPSession> &session)
+{
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    auto current = std::atomic_load(&subscribers_);
+    auto next = std::make_shared<Subscribers>();
+    if (current) {
+        next->reserve(current->size() + 1);
+        for (const auto &subscriber : *current) {
+            auto existing = subscriber.lock();
+            if (existing == session) {
+                return false;
+            }
+            if (existing) {
+                next->push_back(subscriber);
+            }
+        }
+    }
+    next->push_back(session);
+    std::atomic_store(&subscribers_, std::shared_ptr<const Subscribers>(std::move(next)));
+    return true;
+}
+
+bool MediaStreamRegistry::Entry::Unsubscribe(const RTSPSession *session)
+{
+    std::lock_guard<std::mutex> lock(subscribersMutex_);
+    auto current = std::atomic_load(&subscribers_);
+    if (!current) {
+        return false;
+    }
+    auto next = std::make_shared<Subscribers>();
+    next->reserve(current->size());
+    bool found = false;
+    for (const auto &subscriber : *current) {
+        auto existing = subscriber.lock();
+        if (existing.get() == session) {
+            found = true;
+        } else if (existing) {
+            next->push_back(subscriber);
+        }
+    }
+    std::atomic_store(&subscribers_, std::shared_ptr<const Subscribers>(std::move(next)));
+    return found;
+}
+
+MediaStreamRegistry::MediaStreamRegistry() : table_(std::make_shared<const Table>()) {}
+
+std::shared_ptr<MediaStreamRegistry::Entry> MediaStreamRegistry::Find(const std::string &stream_path) const
+{
+    auto table = Snapshot();
+    auto it = table->find(stream_path);
+    return it != table->end() ? it->second : nullptr;
+}
+
+std::vector<std::string> MediaStreamRegistry::Paths() const
+{
+    auto table = Snapshot();
+    std::vector<std::string> paths;
+    paths.reserve(table->size());
+    for (const auto &pair : *table) {
+        paths.push_back(pair.first);
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+void MediaStreamRegistry::Add(const std::string &stream_path, std::shared_ptr<MediaStreamInfo> stream_info)
+{
+    Update({{stream_path, std::move(stream_info)}}, {});
+}
+
+bool MediaStreamRegistry::Remove(const std::string &stream_path)
+{
+    return Update({}, {stream_path}) > 0;
+}
+
+size_t MediaStreamRegistry::Update(const Batch &added, const std::vector<std::string> &removed)
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    auto current = std::atomic_load(&table_);
+
+    if (added.empty()) {
+        // Nothing to publish if none of the paths is registered
+        bool found = std::any_of(removed.begin(), removed.end(),
+                                 [&](const std::string &path) { return current->count(path) > 0; });
+        if (!found) {
+            return 0;
+        }
+    }
+
+    // Entries are shared with the previous snapshot, only the table itself is copied
+    auto table = std::make_shared<Table>(*current);
+    table->reserve(table->size() + added.size());
+    for (const auto &pair : added) {
+        auto &slot = (*table)[pair.first];
+        auto path = slot ? slot->path : std::make_shared<const std::string>(pair.first);
+        auto entry = std::make_shared<Entry>(std::move(path), pair.second);
+        if (slot) {
+            // Viewers keep receiving when a stream is re-registered
+            entry->subscribers_ = slot->GetSubscribers();
+        }
+        slot = std::move(entry);
+    }
+    size_t count = 0;
+    for (const auto &path : removed) {
+        count += table->erase(path);
+    }
+
+    std::atomic_store(&table_, std::shared_ptr<const Table>(std::move(table)));
+    return count;
+}
+
+} // namespace lmshao::lmrtsp
@@ -0,0 +1,87 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "resource_reclaimer.h"
+
+#include <exception>
+
+#include "internal_logger.h"
+
+namespace lmshao::lmrtsp {
+
+ResourceReclaimer::~ResourceReclaimer()
+{
+    Stop();
+}
+
+void ResourceReclaimer::Start()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) {
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&ResourceReclaimer::Run, this);
+}
+
+void ResourceReclaimer::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    condition_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ResourceReclaimer::Post(Task task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            tasks_.push_back(std::move(task));
+            condition_.notify_one();
+            return;
+        }
+    }
+    task();
+}
+
+size_t ResourceReclaimer::Pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return tasks_.size();
+}
+
+void ResourceReclaimer::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        condition_.wait(lock, [this] { return !running_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+            // Stopped and drained
+            return;
+        }
+        Task task = std::move(tasks_.front());
+        tasks_.pop_front();
+
+        lock.unlock();
+        try {
+            task();
+        } catch (const std::exception &e) {
+            RTSP_LOGE("Resource release failed: %s", e.what());
+        }
+        // Objects captured by the task are destroyed here as well, off the network thread
+        task = nullptr;
+        lock.lock();
+    }
+}
+
+} // namespace lmshao::lmrtsp
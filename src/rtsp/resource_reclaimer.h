@@ -0,0 +1,54 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RESOURCE_RECLAIMER_H
+#define LMSHAO_LMRTSP_RESOURCE_RECLAIMER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace lmshao::lmrtsp {
+
+// Background thread for release work that may block, such as joining send threads and closing sockets,
+// so the network thread only has to hand it over. Tasks run in posting order.
+class ResourceReclaimer {
+public:
+    using Task = std::function<void()>;
+
+    ResourceReclaimer() = default;
+    ~ResourceReclaimer();
+
+    ResourceReclaimer(const ResourceReclaimer &) = delete;
+    ResourceReclaimer &operator=(const ResourceReclaimer &) = delete;
+
+    void Start();
+    // Runs every task still queued before returning
+    void Stop();
+
+    // Runs the task right away when the reclaimer is not started
+    void Post(Task task);
+
+    size_t Pending() const;
+
+private:
+    void Run();
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+    std::deque<Task> tasks_;
+    bool running_ = false;
+    std::thread thread_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RESOURCE_RECLAIMER_H
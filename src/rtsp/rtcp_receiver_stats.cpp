@@ -0,0 +1,144 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rtcp_receiver_stats.h"
+
+#include <algorithm>
+
+namespace lmshao::lmrtsp {
+
+namespace {
+
+constexpr uint64_t kSlotUsed = 1ULL << 32;
+constexpr uint64_t kNtpUnixEpochOffset = 2208988800ULL;
+
+uint64_t NtpToUnixMillis(uint64_t ntp)
+{
+    uint64_t seconds = (ntp >> 32) - kNtpUnixEpochOffset;
+    uint64_t millis = ((ntp & 0xFFFFFFFFULL) * 1000) >> 32;
+    return seconds * 1000 + millis;
+}
+
+// Round trip time from LSR/DLSR as described in RFC 3550 section 6.4.1, in milliseconds
+uint32_t ComputeRtt(uint32_t lsr, uint32_t dlsr, uint64_t ntp_now)
+{
+    if (lsr == 0) {
+        return 0;
+    }
+    uint32_t delay = lmrtp::NtpToCompact(ntp_now) - lsr - dlsr;
+    // A negative value (clock skew or a stale report) shows up as a huge unsigned delay
+    if (delay & 0x80000000U) {
+        return 0;
+    }
+    return static_cast<uint32_t>((static_cast<uint64_t>(delay) * 1000) >> 16);
+}
+
+} // namespace
+
+RTCPReceiverStats::Slot *RTCPReceiverStats::FindOrClaim(uint32_t ssrc)
+{
+    const uint64_t key = kSlotUsed | ssrc;
+    for (auto &slot : slots_) {
+        uint64_t current = slot.key.load(std::memory_order_acquire);
+        // A failed claim leaves the winner's key in current, which may be ours
+        if ((current == 0 && slot.key.compare_exchange_strong(current, key, std::memory_order_acq_rel)) ||
+            current == key) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+const RTCPReceiverStats::Slot *RTCPReceiverStats::Find(uint32_t ssrc) const
+{
+    const uint64_t key = kSlotUsed | ssrc;
+    for (const auto &slot : slots_) {
+        if (slot.key.load(std::memory_order_acquire) == key) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+void RTCPReceiverStats::Update(const lmrtp::RtcpReportBlock &block, uint64_t ntp_now)
+{
+    Slot *slot = FindOrClaim(block.ssrc);
+    if (!slot) {
+        return;
+    }
+
+    // Enter the write section: move the sequence from even to odd, this also serialises writers
+    uint32_t seq = slot->sequence.load(std::memory_order_relaxed);
+    do {
+        seq &= ~1U;
+    } while (!slot->sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire));
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot->packets_lost.store(block.cumulative_lost > 0 ? block.cumulative_lost : 0, std::memory_order_relaxed);
+    slot->fraction_lost.store(block.fraction_lost, std::memory_order_relaxed);
+    slot->jitter.store(block.jitter, std::memory_order_relaxed);
+    uint32_t rtt = ComputeRtt(block.lsr, block.dlsr, ntp_now);
+    if (rtt != 0 || block.lsr == 0) {
+        slot->rtt.store(rtt, std::memory_order_relaxed);
+    }
+    slot->last_rr_timestamp.store(NtpToUnixMillis(ntp_now), std::memory_order_relaxed);
+
+    slot->sequence.store(seq + 2, std::memory_order_release);
+}
+
+bool RTCPReceiverStats::ReadSlot(const Slot &slot, RTPStatistics &stats)
+{
+    uint32_t before;
+    uint32_t after;
+    do {
+        before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1U) {
+            continue;
+        }
+        stats.packets_lost = slot.packets_lost.load(std::memory_order_relaxed);
+        stats.loss_rate = slot.fraction_lost.load(std::memory_order_relaxed) / 256.0;
+        stats.jitter = slot.jitter.load(std::memory_order_relaxed);
+        stats.rtt = slot.rtt.load(std::memory_order_relaxed);
+        stats.last_rr_timestamp = slot.last_rr_timestamp.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = slot.sequence.load(std::memory_order_relaxed);
+    } while ((before & 1U) || before != after);
+
+    return before != 0;
+}
+
+bool RTCPReceiverStats::GetSnapshot(uint32_t ssrc, RTPStatistics &stats) const
+{
+    const Slot *slot = Find(ssrc);
+    if (!slot) {
+        return false;
+    }
+    return ReadSlot(*slot, stats);
+}
+
+RTPStatistics RTCPReceiverStats::GetAggregate() const
+{
+    RTPStatistics aggregate;
+    for (const auto &slot : slots_) {
+        if (slot.key.load(std::memory_order_acquire) == 0) {
+            continue;
+        }
+        RTPStatistics stats;
+        if (!ReadSlot(slot, stats)) {
+            continue;
+        }
+        aggregate.packets_lost += stats.packets_lost;
+        aggregate.loss_rate = std::max(aggregate.loss_rate, stats.loss_rate);
+        aggregate.jitter = std::max(aggregate.jitter, stats.jitter);
+        aggregate.rtt = std::max(aggregate.rtt, stats.rtt);
+        aggregate.last_rr_timestamp = std::max(aggregate.last_rr_timestamp, stats.last_rr_timestamp);
+    }
+    return aggregate;
+}
+
+} // namespace lmshao::lmrtsp
@@ -0,0 +1,62 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTCP_RECEIVER_STATS_H
+#define LMSHAO_LMRTSP_RTCP_RECEIVER_STATS_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "irtp_sender.h"
+#include "lmrtp/rtcp_packet.h"
+
+namespace lmshao::lmrtsp {
+
+/**
+ * @brief Per-SSRC reception quality reported by the client through RTCP RR/SR report blocks
+ *
+ * Updates come from the RTCP receive path, readers (GetRTPStatistics, monitoring) take
+ * snapshots without locking. Each source slot is guarded by a sequence counter: the writer
+ * makes it odd while updating, readers retry until they observe the same even value twice.
+ */
+class RTCPReceiverStats {
+public:
+    static constexpr size_t kMaxSources = 4;
+
+    RTCPReceiverStats() = default;
+
+    // Apply one report block, received at NTP time ntp_now
+    void Update(const lmrtp::RtcpReportBlock &block, uint64_t ntp_now);
+
+    // Snapshot of one source; returns false if nothing has been reported for it
+    bool GetSnapshot(uint32_t ssrc, RTPStatistics &stats) const;
+
+    // Snapshot combined across all sources: loss is summed, quality metrics take the worst value
+    RTPStatistics GetAggregate() const;
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> key{0}; // ssrc | kSlotUsed, 0 when free
+        std::atomic<uint32_t> sequence{0};
+        std::atomic<uint64_t> packets_lost{0};
+        std::atomic<uint32_t> fraction_lost{0};
+        std::atomic<uint32_t> jitter{0};
+        std::atomic<uint32_t> rtt{0};
+        std::atomic<uint64_t> last_rr_timestamp{0};
+    };
+
+    Slot *FindOrClaim(uint32_t ssrc);
+    const Slot *Find(uint32_t ssrc) const;
+    static bool ReadSlot(const Slot &slot, RTPStatistics &stats);
+
+    Slot slots_[kMaxSources];
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTCP_RECEIVER_STATS_H
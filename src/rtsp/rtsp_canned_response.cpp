@@ -0,0 +1,45 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rtsp_canned_response.h"
+
+#include <charconv>
+
+namespace lmshao::lmrtsp {
+
+CannedResponse::CannedResponse(const RTSPResponse &response) : text_(response.ToString())
+{
+    std::string_view text(text_);
+    size_t start = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != kCSeqSlot[0] && text[i] != kSessionSlot[0]) {
+            continue;
+        }
+        segments_.push_back(text.substr(start, i - start));
+        slots_.push_back(text[i] == kCSeqSlot[0] ? Slot::CSEQ : Slot::SESSION);
+        start = i + 1;
+    }
+    segments_.push_back(text.substr(start));
+}
+
+std::string_view CannedResponse::WriteTo(std::string &out, int cseq, std::string_view session) const
+{
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), cseq);
+    std::string_view cseqText(digits, result.ptr - digits);
+
+    out.clear();
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        out.append(segments_[i]);
+        out.append(slots_[i] == Slot::CSEQ ? cseqText : session);
+    }
+    out.append(segments_.back());
+    return out;
+}
+
+} // namespace lmshao::lmrtsp
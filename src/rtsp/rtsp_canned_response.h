@@ -0,0 +1,46 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTSP_CANNED_RESPONSE_H
+#define LMSHAO_LMRTSP_RTSP_CANNED_RESPONSE_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "rtsp_response.h"
+
+namespace lmshao::lmrtsp {
+
+// A response rendered once, with only CSeq and Session filled in per request.
+// Build the template with kCSeqSlot / kSessionSlot as header values; the serialized text is split
+// around them, so the output is byte-for-byte what the builder would have produced.
+class CannedResponse {
+public:
+    static constexpr const char *kCSeqSlot = "\x01";
+    static constexpr const char *kSessionSlot = "\x02";
+
+    explicit CannedResponse(const RTSPResponse &response);
+    CannedResponse(const CannedResponse &) = delete;
+    CannedResponse &operator=(const CannedResponse &) = delete;
+
+    // Serialize into out, replacing its content, and return a view of it
+    std::string_view WriteTo(std::string &out, int cseq, std::string_view session = {}) const;
+
+private:
+    enum class Slot { CSEQ, SESSION };
+
+    std::string text_;
+    // text_ is cut at each slot: segments_[i] precedes slots_[i], the last segment ends the message
+    std::vector<std::string_view> segments_;
+    std::vector<Slot> slots_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTSP_CANNED_RESPONSE_H
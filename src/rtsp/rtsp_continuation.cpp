@@ -0,0 +1,43 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rtsp_continuation.h"
+
+#include "internal_logger.h"
+
+namespace lmshao::lmrtsp {
+
+RTSPContinuation::~RTSPContinuation()
+{
+    if (!done_.load()) {
+        RTSP_LOGW("Deferred request released without an answer");
+        Complete(500);
+    }
+}
+
+void RTSPContinuation::Resume()
+{
+    Complete(0);
+}
+
+void RTSPContinuation::Reject(int status_code)
+{
+    Complete(status_code > 0 ? status_code : 500);
+}
+
+void RTSPContinuation::Complete(int status_code)
+{
+    if (done_.exchange(true)) {
+        return;
+    }
+    if (completion_) {
+        completion_(status_code);
+    }
+}
+
+} // namespace lmshao::lmrtsp
@@ -0,0 +1,129 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rtsp_header_map.h"
+
+#include <stdexcept>
+
+namespace lmshao::lmrtsp {
+
+void HeaderMap::clear()
+{
+    for (size_t i = 0; i < size_; ++i) {
+        Data()[i] = value_type();
+    }
+    size_ = 0;
+    onHeap_ = false;
+    heapIds_.clear();
+    heapEntries_.clear();
+}
+
+size_t HeaderMap::IndexOf(HeaderId id, std::string_view name) const
+{
+    const HeaderId *ids = Ids();
+    if (id != HeaderId::UNKNOWN) {
+        for (size_t i = 0; i < size_; ++i) {
+            if (ids[i] == id) {
+                return i;
+            }
+        }
+        return size_;
+    }
+
+    // Unknown names are compared as text
+    const value_type *entries = Data();
+    for (size_t i = 0; i < size_; ++i) {
+        if (ids[i] == HeaderId::UNKNOWN && EqualsIgnoreCase(entries[i].first, name)) {
+            return i;
+        }
+    }
+    return size_;
+}
+
+HeaderMap::iterator HeaderMap::find(HeaderId id)
+{
+    return begin() + (id == HeaderId::UNKNOWN ? size_ : IndexOf(id, {}));
+}
+
+HeaderMap::const_iterator HeaderMap::find(HeaderId id) const
+{
+    return begin() + (id == HeaderId::UNKNOWN ? size_ : IndexOf(id, {}));
+}
+
+HeaderMap::iterator HeaderMap::find(std::string_view name)
+{
+    return begin() + IndexOf(LookupHeader(name), name);
+}
+
+HeaderMap::const_iterator HeaderMap::find(std::string_view name) const
+{
+    return begin() + IndexOf(LookupHeader(name), name);
+}
+
+const std::string &HeaderMap::at(std::string_view name) const
+{
+    auto it = find(name);
+    if (it == end()) {
+        throw std::out_of_range("HeaderMap::at: " + std::string(name));
+    }
+    return it->second;
+}
+
+std::string &HeaderMap::operator[](std::string_view name)
+{
+    HeaderId id = LookupHeader(name);
+    size_t index = IndexOf(id, name);
+    if (index < size_) {
+        return Data()[index].second;
+    }
+
+    if (!onHeap_ && size_ == kInlineCapacity) {
+        // Spill to the heap once, keeping the storage contiguous for iteration
+        heapIds_.assign(inlineIds_.begin(), inlineIds_.end());
+        heapEntries_.reserve(kInlineCapacity * 2);
+        for (auto &entry : inlineEntries_) {
+            heapEntries_.push_back(std::move(entry));
+            entry = value_type();
+        }
+        onHeap_ = true;
+    }
+
+    std::string key = id != HeaderId::UNKNOWN ? std::string(HeaderName(id)) : std::string(name);
+    if (onHeap_) {
+        heapIds_.push_back(id);
+        heapEntries_.emplace_back(std::move(key), std::string());
+    } else {
+        inlineIds_[size_] = id;
+        inlineEntries_[size_] = value_type(std::move(key), std::string());
+    }
+    return Data()[size_++].second;
+}
+
+size_t HeaderMap::erase(std::string_view name)
+{
+    size_t index = IndexOf(LookupHeader(name), name);
+    if (index == size_) {
+        return 0;
+    }
+    value_type *entries = Data();
+    HeaderId *ids = Ids();
+    for (size_t i = index; i + 1 < size_; ++i) {
+        entries[i] = std::move(entries[i + 1]);
+        ids[i] = ids[i + 1];
+    }
+    --size_;
+    if (onHeap_) {
+        heapEntries_.pop_back();
+        heapIds_.pop_back();
+    } else {
+        entries[size_] = value_type();
+    }
+    return 1;
+}
+
+} // namespace lmshao::lmrtsp
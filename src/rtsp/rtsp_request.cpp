@@ -12,56 +12,85 @@
 #include <sstream>
 
 #include "internal_logger.h"
+#include "rtsp_request_parser.h"
 #include "rtsp_utils.h"
 
 namespace lmshao::lmrtsp {
 
+namespace {
+
+std::string_view TrimView(std::string_view str)
+{
+    size_t start = str.find_first_not_of(" \t\r\n");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(start, end - start + 1);
+}
+
+} // namespace
+
 RequestHeader RequestHeader::FromString(const std::string &header_str)
 {
     RequestHeader header;
+    std::string_view data(header_str);
 
-    std::vector<std::string> lines = RTSPUtils::split(header_str, CRLF);
-
-    for (const std::string &line : lines) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        size_t end = data.find(CRLF, offset);
+        if (end == std::string_view::npos) {
+            end = data.size();
+        }
+        std::string_view line = data.substr(offset, end - offset);
+        offset = end + 2;
         if (line.empty()) {
             continue;
         }
 
         size_t colon_pos = line.find(COLON);
-        if (colon_pos == std::string::npos) {
+        if (colon_pos == std::string_view::npos) {
             // Invalid header line, add to custom headers
-            header.custom_header_.push_back(line);
+            header.custom_header_.emplace_back(line);
             continue;
         }
 
-        std::string header_name = RTSPUtils::trim(line.substr(0, colon_pos));
-        std::string header_value = RTSPUtils::trim(line.substr(colon_pos + 1));
-
-        // Convert header name to lowercase for comparison
-        std::string header_name_lower = RTSPUtils::toLower(header_name);
+        std::string_view header_name = TrimView(line.substr(0, colon_pos));
+        std::string header_value(TrimView(line.substr(colon_pos + 1)));
 
         // Parse standard request headers
-        if (header_name_lower == RTSPUtils::toLower(ACCEPT)) {
-            header.accept_ = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(ACCEPT_ENCODING)) {
-            header.accept_encoding_ = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(ACCEPT_LANGUAGE)) {
-            header.accept_language_ = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(AUTHORIZATION)) {
-            header.authorization_ = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(FROM)) {
-            header.from_ = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(IF_MODIFIED_SINCE)) {
-            header.if_modified_since_ = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(RANGE)) {
-            header.range_ = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(REFERER)) {
-            header.referer_ = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(USER_AGENT)) {
-            header.user_agent_ = header_value;
-        } else {
-            // Unknown header, add to custom headers
-            header.custom_header_.push_back(header_name + COLON + SP + header_value);
+        switch (LookupHeader(header_name)) {
+            case HeaderId::ACCEPT:
+                header.accept_ = std::move(header_value);
+                break;
+            case HeaderId::ACCEPT_ENCODING:
+                header.accept_encoding_ = std::move(header_value);
+                break;
+            case HeaderId::ACCEPT_LANGUAGE:
+                header.accept_language_ = std::move(header_value);
+                break;
+            case HeaderId::AUTHORIZATION:
+                header.authorization_ = std::move(header_value);
+                break;
+            case HeaderId::FROM:
+                header.from_ = std::move(header_value);
+                break;
+            case HeaderId::IF_MODIFIED_SINCE:
+                header.if_modified_since_ = std::move(header_value);
+                break;
+            case HeaderId::RANGE:
+                header.range_ = std::move(header_value);
+                break;
+            case HeaderId::REFERER:
+                header.referer_ = std::move(header_value);
+                break;
+            case HeaderId::USER_AGENT:
+                header.user_agent_ = std::move(header_value);
+                break;
+            default:
+                // Unknown header, add to custom headers
+                header.custom_header_.push_back(std::string(header_name) + COLON + SP + header_value);
+                break;
         }
     }
 
@@ -70,151 +99,11 @@ RequestHeader RequestHeader::FromString(const std::string &header_str)
 
 RTSPRequest RTSPRequest::FromString(const std::string &req_str)
 {
-    RTSPRequest request;
-
-    if (req_str.empty()) {
-        return request;
+    RTSPRequestParser parser;
+    if (parser.ParseMessage(req_str) != RTSPRequestParser::Status::COMPLETE) {
+        return RTSPRequest();
     }
-
-    // Split the request into lines
-    std::vector<std::string> lines = RTSPUtils::split(req_str, CRLF);
-
-    if (lines.empty()) {
-        return request;
-    }
-
-    // Parse the request line (first line)
-    std::string request_line = lines[0];
-    std::vector<std::string> request_parts = RTSPUtils::split(request_line, SP);
-
-    if (request_parts.size() >= 3) {
-        // Validate that the version looks like RTSP/x.x
-        if (request_parts[2].find("RTSP/") == 0) {
-            request.method_ = request_parts[0];
-            request.uri_ = request_parts[1];
-            request.version_ = request_parts[2];
-        } else {
-            // Invalid version format
-            return request;
-        }
-    } else {
-        // Invalid request line
-        return request;
-    }
-
-    // Find the empty line that separates headers from body
-    size_t body_start = 0;
-    bool found_empty_line = false;
-
-    for (size_t i = 1; i < lines.size(); ++i) {
-        if (lines[i].empty()) {
-            body_start = i + 1;
-            found_empty_line = true;
-            break;
-        }
-    }
-
-    // Parse headers
-    std::vector<std::string> header_lines;
-    size_t header_end = found_empty_line ? body_start - 1 : lines.size();
-
-    for (size_t i = 1; i < header_end; ++i) {
-        if (!lines[i].empty()) {
-            header_lines.push_back(lines[i]);
-        }
-    }
-
-    // Process each header line
-    for (const std::string &line : header_lines) {
-        size_t colon_pos = line.find(COLON);
-        if (colon_pos == std::string::npos) {
-            continue; // Invalid header line
-        }
-
-        std::string header_name = RTSPUtils::trim(line.substr(0, colon_pos));
-        std::string header_value = RTSPUtils::trim(line.substr(colon_pos + 1));
-
-        // Convert header name to lowercase for comparison
-        std::string header_name_lower = RTSPUtils::toLower(header_name);
-
-        // Classify headers into general, request, and entity headers
-        if (header_name_lower == RTSPUtils::toLower(CSEQ) || header_name_lower == RTSPUtils::toLower(DATE) ||
-            header_name_lower == RTSPUtils::toLower(SESSION) || header_name_lower == RTSPUtils::toLower(TRANSPORT) ||
-            header_name_lower == RTSPUtils::toLower(LOCATION) || header_name_lower == RTSPUtils::toLower(REQUIRE) ||
-            header_name_lower == RTSPUtils::toLower(PROXY_REQUIRE)) {
-            // General headers
-            request.general_header_[header_name] = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(CONTENT_TYPE) ||
-                   header_name_lower == RTSPUtils::toLower(CONTENT_LENGTH)) {
-            // Entity headers
-            request.entity_header_[header_name] = header_value;
-        } else if (header_name_lower == RTSPUtils::toLower(ACCEPT) ||
-                   header_name_lower == RTSPUtils::toLower(ACCEPT_ENCODING) ||
-                   header_name_lower == RTSPUtils::toLower(ACCEPT_LANGUAGE) ||
-                   header_name_lower == RTSPUtils::toLower(AUTHORIZATION) ||
-                   header_name_lower == RTSPUtils::toLower(FROM) ||
-                   header_name_lower == RTSPUtils::toLower(IF_MODIFIED_SINCE) ||
-                   header_name_lower == RTSPUtils::toLower(RANGE) || header_name_lower == RTSPUtils::toLower(REFERER) ||
-                   header_name_lower == RTSPUtils::toLower(USER_AGENT)) {
-            // Request headers - parse using RequestHeader::FromString
-            std::string single_header = header_name + COLON + SP + header_value + CRLF;
-            RequestHeader parsed_header = RequestHeader::FromString(single_header);
-
-            // Merge the parsed header with the request header
-            if (parsed_header.accept_) {
-                request.request_header_.accept_ = parsed_header.accept_;
-            }
-            if (parsed_header.accept_encoding_) {
-                request.request_header_.accept_encoding_ = parsed_header.accept_encoding_;
-            }
-            if (parsed_header.accept_language_) {
-                request.request_header_.accept_language_ = parsed_header.accept_language_;
-            }
-            if (parsed_header.authorization_) {
-                request.request_header_.authorization_ = parsed_header.authorization_;
-            }
-            if (parsed_header.from_) {
-                request.request_header_.from_ = parsed_header.from_;
-            }
-            if (parsed_header.if_modified_since_) {
-                request.request_header_.if_modified_since_ = parsed_header.if_modified_since_;
-            }
-            if (parsed_header.range_) {
-                request.request_header_.range_ = parsed_header.range_;
-            }
-            if (parsed_header.referer_) {
-                request.request_header_.referer_ = parsed_header.referer_;
-            }
-            if (parsed_header.user_agent_) {
-                request.request_header_.user_agent_ = parsed_header.user_agent_;
-            }
-
-            // Add custom headers
-            for (const std::string &custom : parsed_header.custom_header_) {
-                request.request_header_.custom_header_.push_back(custom);
-            }
-        } else {
-            // Unknown header, add to request custom headers
-            request.request_header_.custom_header_.push_back(header_name + COLON + SP + header_value);
-        }
-    }
-
-    // Parse message body if present
-    if (found_empty_line && body_start < lines.size()) {
-        std::ostringstream body_oss;
-        for (size_t i = body_start; i < lines.size(); ++i) {
-            body_oss << lines[i];
-            if (i + 1 < lines.size()) {
-                body_oss << CRLF;
-            }
-        }
-        std::string body = body_oss.str();
-        if (!body.empty()) {
-            request.message_body_ = body;
-        }
-    }
-
-    return request;
+    return parser.ToRequest();
 }
 
 std::string RequestHeader::ToString() const
@@ -280,6 +169,7 @@ RTSPRequestBuilder::RTSPRequestBuilder()
 RTSPRequestBuilder &RTSPRequestBuilder::SetMethod(const std::string &method)
 {
     request_.method_ = method;
+    request_.method_id_ = LookupMethod(method);
     return *this;
 }
 
@@ -292,18 +182,21 @@ RTSPRequestBuilder &RTSPRequestBuilder::SetUri(const std::string &uri)
 RTSPRequestBuilder &RTSPRequestBuilder::SetCSeq(int cseq)
 {
     request_.general_header_[CSEQ] = std::to_string(cseq);
+    request_.cseq_ = cseq;
     return *this;
 }
 
 RTSPRequestBuilder &RTSPRequestBuilder::SetSession(const std::string &session)
 {
     request_.general_header_[SESSION] = session;
+    request_.session_id_ = RTSPUtils::sessionId(session);
     return *this;
 }
 
 RTSPRequestBuilder &RTSPRequestBuilder::SetTransport(const std::string &transport)
 {
     request_.general_header_[TRANSPORT] = transport;
+    RTSPUtils::parseClientPorts(transport, request_.client_rtp_port_, request_.client_rtcp_port_);
     return *this;
 }
 
@@ -364,6 +257,7 @@ RTSPRequestBuilder &RTSPRequestBuilder::SetContentType(const std::string &conten
 RTSPRequestBuilder &RTSPRequestBuilder::SetContentLength(size_t length)
 {
     request_.entity_header_[CONTENT_LENGTH] = std::to_string(length);
+    request_.content_length_ = length;
     return *this;
 }
 
@@ -0,0 +1,51 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rtsp_request_metrics.h"
+
+namespace lmshao::lmrtsp {
+
+size_t RTSPRequestMetrics::LatencyBucket(std::chrono::nanoseconds latency)
+{
+    auto us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+    size_t bucket = 0;
+    while (bucket + 1 < kLatencyBuckets && us >= (1ULL << bucket)) {
+        ++bucket;
+    }
+    return bucket;
+}
+
+void RTSPRequestMetrics::Record(RTSPMethod method, std::chrono::nanoseconds latency)
+{
+    Counters &counters = methods_[static_cast<size_t>(method)];
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+    counters.latency[LatencyBucket(latency)].fetch_add(1, std::memory_order_relaxed);
+}
+
+RTSPRequestMetrics::Snapshot RTSPRequestMetrics::Get(RTSPMethod method) const
+{
+    const Counters &counters = methods_[static_cast<size_t>(method)];
+    Snapshot snapshot;
+    snapshot.count = counters.count.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < kLatencyBuckets; ++i) {
+        snapshot.latency[i] = counters.latency[i].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+void RTSPRequestMetrics::Reset()
+{
+    for (auto &counters : methods_) {
+        counters.count.store(0, std::memory_order_relaxed);
+        for (auto &bucket : counters.latency) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+} // namespace lmshao::lmrtsp
@@ -0,0 +1,354 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rtsp_request_parser.h"
+
+#include <charconv>
+
+#include "internal_logger.h"
+#include "rtsp_request.h"
+#include "rtsp_utils.h"
+
+namespace lmshao::lmrtsp {
+
+namespace {
+
+inline bool IsSpace(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+// Shrink [start, end) to exclude surrounding spaces and tabs
+void TrimRange(std::string_view data, size_t &start, size_t &end)
+{
+    while (start < end && IsSpace(data[start])) {
+        ++start;
+    }
+    while (end > start && IsSpace(data[end - 1])) {
+        --end;
+    }
+}
+
+} // namespace
+
+const RTSPHeaderField *RTSPRequestView::Find(HeaderId id) const
+{
+    for (size_t i = 0; i < header_count; ++i) {
+        if (headers[i].id == id) {
+            return &headers[i];
+        }
+    }
+    return nullptr;
+}
+
+void RTSPRequestParser::Reset()
+{
+    state_ = State::REQUEST_LINE;
+    offset_ = 0;
+    bodyStart_ = 0;
+    contentLength_ = 0;
+    contentLengthValid_ = true;
+    messageSize_ = 0;
+    headerCount_ = 0;
+    request_ = RTSPRequestView();
+}
+
+void RTSPRequestParser::SetLimits(size_t max_header_size, size_t max_body_size)
+{
+    maxHeaderSize_ = max_header_size;
+    maxBodySize_ = max_body_size;
+}
+
+bool RTSPRequestParser::ParseRequestLine(std::string_view data, size_t start, size_t end)
+{
+    // Method SP Request-URI SP RTSP-Version
+    TrimRange(data, start, end);
+    size_t firstSpace = data.find(' ', start);
+    size_t lastSpace = data.rfind(' ', end - 1);
+    if (firstSpace == std::string_view::npos || firstSpace >= end || lastSpace <= firstSpace) {
+        return false;
+    }
+
+    size_t uriStart = firstSpace + 1;
+    size_t uriEnd = lastSpace;
+    TrimRange(data, uriStart, uriEnd);
+    std::string_view version = data.substr(lastSpace + 1, end - lastSpace - 1);
+    if (firstSpace == start || uriStart == uriEnd || version.substr(0, 5) != "RTSP/") {
+        return false;
+    }
+
+    method_ = {static_cast<uint32_t>(start), static_cast<uint32_t>(firstSpace - start)};
+    uri_ = {static_cast<uint32_t>(uriStart), static_cast<uint32_t>(uriEnd - uriStart)};
+    version_ = {static_cast<uint32_t>(lastSpace + 1), static_cast<uint32_t>(version.size())};
+    return true;
+}
+
+bool RTSPRequestParser::ParseHeaderLine(std::string_view data, size_t start, size_t end)
+{
+    // Obsolete line folding: a continuation line extends the previous value
+    if (IsSpace(data[start])) {
+        if (headerCount_ > 0) {
+            size_t valueEnd = end;
+            TrimRange(data, start, valueEnd);
+            Span &value = headers_[headerCount_ - 1].value;
+            if (value.length == 0) {
+                value.offset = static_cast<uint32_t>(start);
+            }
+            value.length = static_cast<uint32_t>(valueEnd - value.offset);
+        }
+        return true;
+    }
+
+    size_t colon = data.find(':', start);
+    if (colon == std::string_view::npos || colon >= end) {
+        // Not a header line, ignored like any other unknown line
+        return true;
+    }
+    if (headerCount_ == RTSPRequestView::kMaxHeaders) {
+        RTSP_LOGW("Too many headers in RTSP request");
+        return false;
+    }
+
+    size_t nameStart = start;
+    size_t nameEnd = colon;
+    size_t valueStart = colon + 1;
+    size_t valueEnd = end;
+    TrimRange(data, nameStart, nameEnd);
+    TrimRange(data, valueStart, valueEnd);
+
+    HeaderSpan &header = headers_[headerCount_++];
+    header.id = LookupHeader(data.substr(nameStart, nameEnd - nameStart));
+    header.name = {static_cast<uint32_t>(nameStart), static_cast<uint32_t>(nameEnd - nameStart)};
+    header.value = {static_cast<uint32_t>(valueStart), static_cast<uint32_t>(valueEnd - valueStart)};
+
+    if (header.id == HeaderId::CONTENT_LENGTH) {
+        const char *first = data.data() + valueStart;
+        const char *last = data.data() + valueEnd;
+        auto result = std::from_chars(first, last, contentLength_);
+        contentLengthValid_ = result.ec == std::errc() && result.ptr == last;
+    }
+    return true;
+}
+
+bool RTSPRequestParser::ParseLine(std::string_view data, size_t start, size_t end)
+{
+    if (state_ == State::REQUEST_LINE) {
+        // Empty lines before the request line are keep-alives
+        if (start == end) {
+            return true;
+        }
+        if (!ParseRequestLine(data, start, end)) {
+            return false;
+        }
+        state_ = State::HEADERS;
+        return true;
+    }
+
+    if (start == end) {
+        state_ = State::BODY;
+        return true;
+    }
+    return ParseHeaderLine(data, start, end);
+}
+
+RTSPRequestParser::Status RTSPRequestParser::Finish(std::string_view data, size_t body_size)
+{
+    messageSize_ = bodyStart_ + body_size;
+
+    request_.method = data.substr(method_.offset, method_.length);
+    request_.method_id = LookupMethod(request_.method);
+    request_.uri = data.substr(uri_.offset, uri_.length);
+    request_.version = data.substr(version_.offset, version_.length);
+    request_.body = data.substr(bodyStart_, body_size);
+    request_.header_count = headerCount_;
+    for (size_t i = 0; i < headerCount_; ++i) {
+        request_.headers[i].id = headers_[i].id;
+        request_.headers[i].name = data.substr(headers_[i].name.offset, headers_[i].name.length);
+        request_.headers[i].value = data.substr(headers_[i].value.offset, headers_[i].value.length);
+    }
+
+    state_ = State::DONE;
+    return Status::COMPLETE;
+}
+
+RTSPRequestParser::Status RTSPRequestParser::Parse(std::string_view data)
+{
+    if (state_ == State::DONE) {
+        return Status::COMPLETE;
+    }
+    if (state_ == State::ERROR || data.size() > UINT32_MAX) {
+        return Status::ERROR;
+    }
+
+    while (state_ != State::BODY) {
+        size_t newline = data.find('\n', offset_);
+        if (newline == std::string_view::npos) {
+            if (data.size() > maxHeaderSize_) {
+                RTSP_LOGW("RTSP request header exceeds %zu bytes", maxHeaderSize_);
+                state_ = State::ERROR;
+                return Status::TOO_LARGE;
+            }
+            return Status::INCOMPLETE;
+        }
+        if (newline >= maxHeaderSize_) {
+            RTSP_LOGW("RTSP request header exceeds %zu bytes", maxHeaderSize_);
+            state_ = State::ERROR;
+            return Status::TOO_LARGE;
+        }
+
+        size_t end = newline;
+        if (end > offset_ && data[end - 1] == '\r') {
+            --end;
+        }
+        size_t start = offset_;
+        offset_ = newline + 1;
+
+        if (!ParseLine(data, start, end)) {
+            state_ = State::ERROR;
+            return Status::ERROR;
+        }
+    }
+
+    if (bodyStart_ == 0) {
+        bodyStart_ = offset_;
+        if (!contentLengthValid_) {
+            RTSP_LOGW("Invalid Content-Length in RTSP request");
+            state_ = State::ERROR;
+            return Status::ERROR;
+        }
+        if (contentLength_ > maxBodySize_) {
+            RTSP_LOGW("RTSP request body of %zu bytes exceeds %zu", contentLength_, maxBodySize_);
+            state_ = State::ERROR;
+            return Status::TOO_LARGE;
+        }
+    }
+    if (data.size() - bodyStart_ < contentLength_) {
+        return Status::INCOMPLETE;
+    }
+    return Finish(data, contentLength_);
+}
+
+RTSPRequestParser::Status RTSPRequestParser::ParseMessage(std::string_view data)
+{
+    Reset();
+    if (data.size() > UINT32_MAX) {
+        state_ = State::ERROR;
+        return Status::ERROR;
+    }
+
+    while (state_ != State::BODY && offset_ < data.size()) {
+        size_t newline = data.find('\n', offset_);
+        size_t next = newline == std::string_view::npos ? data.size() : newline + 1;
+        size_t end = newline == std::string_view::npos ? data.size() : newline;
+        if (end > offset_ && data[end - 1] == '\r') {
+            --end;
+        }
+        size_t start = offset_;
+        offset_ = next;
+
+        if (!ParseLine(data, start, end)) {
+            state_ = State::ERROR;
+            return Status::ERROR;
+        }
+    }
+
+    if (state_ == State::REQUEST_LINE) {
+        state_ = State::ERROR;
+        return Status::ERROR;
+    }
+    bodyStart_ = offset_;
+    return Finish(data, data.size() - bodyStart_);
+}
+
+RTSPRequest RTSPRequestParser::ToRequest() const
+{
+    RTSPRequest request;
+    if (state_ != State::DONE) {
+        return request;
+    }
+
+    request.method_ = request_.method;
+    request.method_id_ = request_.method_id;
+    request.uri_ = request_.uri;
+    request.version_ = request_.version;
+
+    RequestHeader &requestHeader = request.request_header_;
+    for (size_t i = 0; i < request_.header_count; ++i) {
+        const RTSPHeaderField &field = request_.headers[i];
+        switch (field.id) {
+            case HeaderId::CSEQ:
+                if (uint32_t cseq = 0; RTSPUtils::parseNumber(field.value, cseq) && cseq <= INT32_MAX) {
+                    request.cseq_ = static_cast<int>(cseq);
+                }
+                request.general_header_[field.name] = field.value;
+                break;
+            case HeaderId::SESSION:
+                request.session_id_ = RTSPUtils::sessionId(field.value);
+                request.general_header_[field.name] = field.value;
+                break;
+            case HeaderId::TRANSPORT:
+                RTSPUtils::parseClientPorts(field.value, request.client_rtp_port_, request.client_rtcp_port_);
+                request.general_header_[field.name] = field.value;
+                break;
+            case HeaderId::DATE:
+            case HeaderId::LOCATION:
+            case HeaderId::REQUIRE:
+            case HeaderId::PROXY_REQUIRE:
+                request.general_header_[field.name] = field.value;
+                break;
+            case HeaderId::CONTENT_TYPE:
+            case HeaderId::CONTENT_LENGTH:
+                request.entity_header_[field.name] = field.value;
+                break;
+            case HeaderId::ACCEPT:
+                requestHeader.accept_ = field.value;
+                break;
+            case HeaderId::ACCEPT_ENCODING:
+                requestHeader.accept_encoding_ = field.value;
+                break;
+            case HeaderId::ACCEPT_LANGUAGE:
+                requestHeader.accept_language_ = field.value;
+                break;
+            case HeaderId::AUTHORIZATION:
+                requestHeader.authorization_ = field.value;
+                break;
+            case HeaderId::FROM:
+                requestHeader.from_ = field.value;
+                break;
+            case HeaderId::IF_MODIFIED_SINCE:
+                requestHeader.if_modified_since_ = field.value;
+                break;
+            case HeaderId::RANGE:
+                requestHeader.range_ = field.value;
+                break;
+            case HeaderId::REFERER:
+                requestHeader.referer_ = field.value;
+                break;
+            case HeaderId::USER_AGENT:
+                requestHeader.user_agent_ = field.value;
+                break;
+            default: {
+                std::string custom;
+                custom.reserve(field.name.size() + 2 + field.value.size());
+                custom.append(field.name).append(": ").append(field.value);
+                requestHeader.custom_header_.push_back(std::move(custom));
+                break;
+            }
+        }
+    }
+
+    if (contentLengthValid_) {
+        request.content_length_ = contentLength_;
+    }
+    if (!request_.body.empty()) {
+        request.message_body_ = std::string(request_.body);
+    }
+    return request;
+}
+
+} // namespace lmshao::lmrtsp
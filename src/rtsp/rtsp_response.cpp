@@ -9,6 +9,8 @@
 #include "rtsp_response.h"
 
 #include <algorithm>
+#include <array>
+#include <charconv>
 #include <sstream>
 
 #include "rtsp_utils.h"
@@ -20,12 +22,31 @@ namespace {
 // Helper function to parse status code from string
 StatusCode parseStatusCode(const std::string &status_str)
 {
-    try {
-        int code = std::stoi(status_str);
-        return static_cast<StatusCode>(code);
-    } catch (const std::exception &) {
+    int code = 0;
+    if (!RTSPUtils::parseNumber(status_str, code)) {
         return StatusCode::InternalServerError; // Default on parse error
     }
+    return static_cast<StatusCode>(code);
+}
+
+// "RTSP/1.0 <code> <reason>\r\n" for status codes 100-599, rendered once
+std::string_view StatusLine(uint16_t code)
+{
+    static const std::array<std::string, 500> lines = [] {
+        std::array<std::string, 500> table;
+        for (size_t i = 0; i < table.size(); ++i) {
+            uint16_t value = static_cast<uint16_t>(100 + i);
+            table[i] = std::string(RTSP_VERSION) + SP + std::to_string(value) + SP +
+                       GetReasonPhrase(static_cast<StatusCode>(value)) + CRLF;
+        }
+        return table;
+    }();
+    return lines[code - 100];
+}
+
+void AppendHeader(std::string &out, std::string_view name, std::string_view value)
+{
+    out.append(name).append(COLON).append(SP).append(value).append(CRLF);
 }
 
 // Helper function to split comma-separated values
@@ -334,60 +355,81 @@ std::string GetReasonPhrase(StatusCode code)
 
 std::string ResponseHeader::ToString() const
 {
-    std::ostringstream oss;
+    std::string out;
+    AppendTo(out);
+    return out;
+}
+
+void ResponseHeader::AppendTo(std::string &out) const
+{
     if (location_) {
-        oss << LOCATION << COLON << SP << *location_ << CRLF;
+        AppendHeader(out, LOCATION, *location_);
     }
     if (proxy_authenticate_) {
-        oss << PROXY_AUTHENTICATE << COLON << SP << *proxy_authenticate_ << CRLF;
+        AppendHeader(out, PROXY_AUTHENTICATE, *proxy_authenticate_);
     }
     if (!public_methods_.empty()) {
-        oss << PUBLIC << COLON << SP;
+        out.append(PUBLIC).append(COLON).append(SP);
         for (size_t i = 0; i < public_methods_.size(); ++i) {
-            oss << public_methods_[i];
+            out.append(public_methods_[i]);
             if (i + 1 < public_methods_.size()) {
-                oss << COMMA << SP;
+                out.append(COMMA).append(SP);
             }
         }
-        oss << CRLF;
+        out.append(CRLF);
     }
     if (retry_after_) {
-        oss << RETRY_AFTER << COLON << SP << *retry_after_ << CRLF;
+        AppendHeader(out, RETRY_AFTER, *retry_after_);
     }
     if (server_) {
-        oss << SERVER << COLON << SP << *server_ << CRLF;
+        AppendHeader(out, SERVER, *server_);
     }
     if (vary_) {
-        oss << VARY << COLON << SP << *vary_ << CRLF;
+        AppendHeader(out, VARY, *vary_);
     }
     if (www_authenticate_) {
-        oss << WWW_AUTHENTICATE << COLON << SP << *www_authenticate_ << CRLF;
+        AppendHeader(out, WWW_AUTHENTICATE, *www_authenticate_);
     }
     if (rtp_info_) {
-        oss << RTP_INFO << COLON << SP << *rtp_info_ << CRLF;
+        AppendHeader(out, RTP_INFO, *rtp_info_);
     }
     for (const auto &h : custom_header_) {
-        oss << h << CRLF;
+        out.append(h).append(CRLF);
     }
-    return oss.str();
 }
 
 std::string RTSPResponse::ToString() const
 {
-    std::ostringstream oss;
-    oss << version_ << SP << static_cast<uint16_t>(status_) << SP << GetReasonPhrase(status_) << CRLF;
+    std::string out;
+    WriteTo(out);
+    return out;
+}
+
+std::string_view RTSPResponse::WriteTo(std::string &out) const
+{
+    out.clear();
+    auto code = static_cast<uint16_t>(status_);
+    if (version_ == RTSP_VERSION && code >= 100 && code < 600) {
+        out.append(StatusLine(code));
+    } else {
+        char digits[8];
+        auto result = std::to_chars(digits, digits + sizeof(digits), code);
+        out.append(version_).append(SP).append(digits, result.ptr).append(SP).append(GetReasonPhrase(status_));
+        out.append(CRLF);
+    }
+
     for (const auto &[k, v] : general_header_) {
-        oss << k << COLON << SP << v << CRLF;
+        AppendHeader(out, k, v);
     }
-    oss << response_header_.ToString();
+    response_header_.AppendTo(out);
     for (const auto &[k, v] : entity_header_) {
-        oss << k << COLON << SP << v << CRLF;
+        AppendHeader(out, k, v);
     }
-    oss << CRLF;
+    out.append(CRLF);
     if (message_body_) {
-        oss << *message_body_;
+        out.append(*message_body_);
     }
-    return oss.str();
+    return out;
 }
 
 // RTSPResponseBuilder implementations
@@ -485,6 +527,12 @@ RTSPResponseBuilder &RTSPResponseBuilder::SetRTPInfo(const std::string &rtp_info
     return *this;
 }
 
+RTSPResponseBuilder &RTSPResponseBuilder::SetRetryAfter(uint32_t seconds)
+{
+    response_.response_header_.retry_after_ = std::to_string(seconds);
+    return *this;
+}
+
 RTSPResponseBuilder &RTSPResponseBuilder::AddCustomHeader(const std::string &header)
 {
     response_.response_header_.custom_header_.push_back(header);
@@ -599,6 +647,11 @@ RTSPResponseBuilder RTSPResponseFactory::CreateInternalServerError(int cseq)
     return CreateError(StatusCode::InternalServerError, cseq);
 }
 
+RTSPResponseBuilder RTSPResponseFactory::CreateServiceUnavailable(int cseq, uint32_t retry_after_seconds)
+{
+    return CreateError(StatusCode::ServiceUnavailable, cseq).SetRetryAfter(retry_after_seconds);
+}
+
 RTSPResponseBuilder RTSPResponseFactory::CreateNotImplemented(int cseq)
 {
     return CreateError(StatusCode::NotImplemented, cseq);
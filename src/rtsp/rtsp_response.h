@@ -10,11 +10,12 @@
 #define LMSHAO_LMRTSP_RTSP_RESPONSE_H
 
 #include <cstdint>
-#include <map>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "rtsp_header_map.h"
 #include "rtsp_headers.h"
 
 namespace lmshao::lmrtsp {
@@ -86,6 +87,9 @@ public:
     std::string ToString() const;
     static ResponseHeader FromString(const std::string &header_str);
 
+    // Append the header lines to out
+    void AppendTo(std::string &out) const;
+
 public:
     std::optional<std::string> location_;
     std::optional<std::string> proxy_authenticate_;
@@ -105,12 +109,16 @@ public:
     std::string ToString() const;
     static RTSPResponse FromString(const std::string &resp_str);
 
+    // Serialize into out, replacing its content but keeping its capacity, so a buffer reused across
+    // responses stops allocating once it has grown. The view is valid until out is modified.
+    std::string_view WriteTo(std::string &out) const;
+
 public:
     std::string version_;
     StatusCode status_;
-    std::map<std::string, std::string> general_header_;
+    HeaderMap general_header_;
     ResponseHeader response_header_;
-    std::map<std::string, std::string> entity_header_;
+    HeaderMap entity_header_;
     std::optional<std::string> message_body_;
 };
 
@@ -137,6 +145,7 @@ public:
     RTSPResponseBuilder &SetPublic(const std::string &methods_str);
     RTSPResponseBuilder &SetWWWAuthenticate(const std::string &auth);
     RTSPResponseBuilder &SetRTPInfo(const std::string &rtp_info);
+    RTSPResponseBuilder &SetRetryAfter(uint32_t seconds);
     RTSPResponseBuilder &AddCustomHeader(const std::string &header);
 
     // Entity headers
@@ -171,6 +180,7 @@ public:
     static RTSPResponseBuilder CreateMethodNotAllowed(int cseq);
     static RTSPResponseBuilder CreateSessionNotFound(int cseq);
     static RTSPResponseBuilder CreateInternalServerError(int cseq);
+    static RTSPResponseBuilder CreateServiceUnavailable(int cseq, uint32_t retry_after_seconds);
     static RTSPResponseBuilder CreateNotImplemented(int cseq);
 };
 
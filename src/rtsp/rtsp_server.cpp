@@ -10,19 +10,135 @@
 
 #include <lmnet/tcp_server.h>
 
+#include <algorithm>
+
+#include "admission_control.h"
+#include "callback_dispatcher.h"
+#include "egress_budget.h"
 #include "internal_logger.h"
 #include "irtsp_server_callback.h"
+#include "resource_reclaimer.h"
+#include "rtsp_canned_response.h"
+#include "rtsp_request_parser.h"
 #include "rtsp_response.h"
 #include "rtsp_server_listener.h"
 #include "rtsp_session.h"
+#include "rtsp_session_table.h"
+#include "rtsp_utils.h"
+#include "session_id.h"
+#include "timer_wheel.h"
 
 namespace lmshao::lmrtsp {
 
+namespace {
+
+constexpr const char *kServerName = "RTSP Server/1.0";
+
+// The public default of SetCallbackExecutor() mirrors the dispatcher's own
+static_assert(RTSPServer::kDefaultCallbackQueueCapacity == CallbackDispatcher::kDefaultCapacity);
+
+// Responses are serialized into a buffer owned by the network thread. Each one is written and sent before
+// the thread handles the next connection, so the capacity is reused by every connection it serves.
+std::string &ResponseBuffer()
+{
+    thread_local std::string buffer;
+    return buffer;
+}
+
+void SendSerialized(const std::shared_ptr<lmnet::Session> &lmnetSession, std::string_view data)
+{
+    RTSP_LOGD("Send response: \n%.*s", static_cast<int>(data.size()), data.data());
+    lmnetSession->Send(data.data(), data.size());
+}
+
+void SendResponse(const std::shared_ptr<lmnet::Session> &lmnetSession, const RTSPResponse &response)
+{
+    SendSerialized(lmnetSession, response.WriteTo(ResponseBuffer()));
+}
+
+// Everything of a stream's SDP after the connection line except a=control, which depends on the request URI
+std::string RenderMediaSection(const MediaStreamInfo &info, uint16_t server_port)
+{
+    std::string sdp = "t=0 0\r\n";
+
+    if (info.media_type == "video") {
+        bool rtx = info.nack_history_ms > 0 && info.rtx_payload_type != 0 && info.rtx_ssrc != 0;
+        bool fec = !info.fec_scheme.empty() && info.fec_payload_type != 0;
+        std::string rtxPt = std::to_string(info.rtx_payload_type);
+        std::string fecPt = std::to_string(info.fec_payload_type);
+        sdp += "m=video " + std::to_string(server_port) + " RTP/AVP 96" + (rtx ? " " + rtxPt : "") +
+               (fec ? " " + fecPt : "") + "\r\n";
+        sdp += "a=rtpmap:96 " + info.codec + "/90000\r\n";
+        if (info.nack_history_ms > 0) {
+            sdp += "a=rtcp-fb:96 nack\r\n";
+        }
+        if (info.keyframe_requests) {
+            sdp += "a=rtcp-fb:96 nack pli\r\n";
+            sdp += "a=rtcp-fb:96 ccm fir\r\n";
+        }
+        if (rtx) {
+            sdp += "a=rtpmap:" + rtxPt + " rtx/90000\r\n";
+            sdp += "a=fmtp:" + rtxPt + " apt=96\r\n";
+        }
+        if (rtx && info.ssrc != 0) {
+            sdp += "a=ssrc-group:FID " + std::to_string(info.ssrc) + " " + std::to_string(info.rtx_ssrc) + "\r\n";
+        }
+        if (fec && info.fec_scheme == "ulpfec") {
+            sdp += "a=rtpmap:" + fecPt + " ulpfec/90000\r\n";
+        } else if (fec) {
+            sdp += "a=rtpmap:" + fecPt + " flexfec/90000\r\n";
+            sdp += "a=fmtp:" + fecPt + " repair-window=200000\r\n";
+        }
+        if (fec && info.ssrc != 0 && info.fec_ssrc != 0) {
+            sdp += "a=ssrc-group:FEC-FR " + std::to_string(info.ssrc) + " " + std::to_string(info.fec_ssrc) + "\r\n";
+        }
+        if (info.width > 0 && info.height > 0) {
+            sdp += "a=framerate:" + std::to_string(info.frame_rate) + "\r\n";
+        }
+    } else if (info.media_type == "audio") {
+        sdp += "m=audio " + std::to_string(server_port) + " RTP/AVP 97\r\n";
+        sdp += "a=rtpmap:97 " + info.codec + "/" + std::to_string(info.sample_rate) + "\r\n";
+    }
+    return sdp;
+}
+
+const CannedResponse &OptionsResponse()
+{
+    static const CannedResponse response([] {
+        RTSPResponse options = RTSPResponseFactory::CreateOptionsOK(0).SetServer(kServerName).Build();
+        options.general_header_[CSEQ] = CannedResponse::kCSeqSlot;
+        return options;
+    }());
+    return response;
+}
+
+const CannedResponse &KeepAliveResponse()
+{
+    static const CannedResponse response([] {
+        RTSPResponse keepAlive = RTSPResponseFactory::CreateOK(0).Build();
+        keepAlive.general_header_[CSEQ] = CannedResponse::kCSeqSlot;
+        keepAlive.general_header_[SESSION] = CannedResponse::kSessionSlot;
+        return keepAlive;
+    }());
+    return response;
+}
+
+} // namespace
+
 RTSPServer::RTSPServer()
+    : sessions_(std::make_unique<RTSPSessionTable>()), expiryWheel_(std::make_unique<TimerWheel>()),
+      reclaimer_(std::make_unique<ResourceReclaimer>()), admission_(std::make_unique<AdmissionControl>()),
+      egressBudget_(std::make_unique<EgressBudget>())
 {
     RTSP_LOGD("RTSPServer constructor called");
 }
 
+RTSPServer::~RTSPServer()
+{
+    running_.store(false);
+    StopReaper();
+}
+
 bool RTSPServer::Init(const std::string &ip, uint16_t port)
 {
     RTSP_LOGD("Initializing RTSP server on %s:%d", ip.c_str(), port);
@@ -38,7 +154,7 @@ bool RTSPServer::Init(const std::string &ip, uint16_t port)
     }
 
     // Set listener
-    serverListener_ = std::make_shared<RTSPServerListener>(shared_from_this());
+    serverListener_ = std::make_shared<RTSPServerListener>(shared_from_this(), reactorCount_);
     tcpServer_->SetListener(serverListener_);
 
     if (!tcpServer_->Init()) {
@@ -58,12 +174,23 @@ bool RTSPServer::Start()
         return false;
     }
 
+    // Reactors have to run before the first request arrives
+    serverListener_->Start();
     if (!tcpServer_->Start()) {
         RTSP_LOGE("Failed to start TCP server");
+        serverListener_->Stop();
         return false;
     }
 
     running_.store(true);
+    reclaimer_->Start();
+    {
+        std::lock_guard<std::mutex> lock(expiryMutex_);
+        expiryWheel_->Reset(RTSPSession::MonotonicSeconds());
+    }
+    if (!reaperThread_.joinable()) {
+        reaperThread_ = std::thread(&RTSPServer::ReapExpiredSessions, this);
+    }
     RTSP_LOGD("RTSP server started successfully");
     return true;
 }
@@ -82,12 +209,12 @@ bool RTSPServer::Stop()
     }
 
     running_.store(false);
+    serverListener_->Stop();
+    StopReaper();
 
-    // Clean up all sessions
-    {
-        std::lock_guard<std::mutex> lock(sessionsMutex_);
-        sessions_.clear();
-    }
+    // Clean up all sessions, then wait for their media to be released
+    sessions_->Clear();
+    reclaimer_->Stop();
 
     RTSP_LOGD("RTSP server stopped successfully");
     return true;
@@ -97,92 +224,168 @@ void RTSPServer::HandleRequest(std::shared_ptr<RTSPSession> session, const RTSPR
 {
     RTSP_LOGD("Handling %s request for session %s", request.method_.c_str(), session->GetSessionId().c_str());
 
+    auto start = std::chrono::steady_clock::now();
+
     // Get client IP for callback notifications
     std::string client_ip = GetClientIP(session);
 
+    if (request.method_id_ == RTSPMethod::PLAY && !AdmitPlay(session, request)) {
+        RTSP_LOGW("Player limit of %s reached, refusing %s", request.uri_.c_str(), client_ip.c_str());
+        SendErrorResponse(session->GetNetworkSession(), request, 503, "Service Unavailable");
+    } else if (request.method_id_ == RTSPMethod::PLAY && !ReserveEgress(session, request)) {
+        RTSP_LOGW("Egress budget exhausted, refusing %s to %s", request.uri_.c_str(), client_ip.c_str());
+        SendErrorResponse(session->GetNetworkSession(), request, 453, "Not Enough Bandwidth");
+    } else {
+        ProcessSessionRequest(session, request, client_ip);
+    }
+    requestMetrics_.Record(request.method_id_, std::chrono::steady_clock::now() - start);
+}
+
+void RTSPServer::ProcessSessionRequest(const std::shared_ptr<RTSPSession> &session, const RTSPRequest &request,
+                                       const std::string &client_ip)
+{
+    // The registered stream's RTP parameters (codec, SSRC, NACK, FEC) apply to the media set up for it
+    if (request.method_id_ == RTSPMethod::SETUP) {
+        std::string path;
+        if (auto entry = FindStream(request.uri_, path)) {
+            session->SetMediaStreamInfo(entry->info);
+        }
+    }
+
     // Process request directly through session state machine
     RTSPResponse response = session->ProcessRequest(request);
+    if (request.method_id_ == RTSPMethod::PLAY && !session->IsPlaying()) {
+        session->ReleaseReservedBitrate();
+    }
 
     // Notify callback about the request after processing
-    const std::string &method = request.method_;
-    if (method == "SETUP") {
-        std::string transport = "";
-        auto it = request.general_header_.find("Transport");
-        if (it != request.general_header_.end()) {
-            transport = it->second;
+    switch (request.method_id_) {
+        case RTSPMethod::SETUP: {
+            std::string transport = "";
+            auto it = request.general_header_.find(HeaderId::TRANSPORT);
+            if (it != request.general_header_.end()) {
+                transport = it->second;
+            }
+            RTSP_LOGD("invoke OnStreamRequested");
+            NotifyCallback([client_ip, transport, uri = request.uri_](IRTSPServerCallback *callback) {
+                callback->OnSetupReceived(client_ip, transport, uri);
+            });
+            break;
         }
-        RTSP_LOGD("invoke OnStreamRequested");
-        NotifyCallback(
-            [&](IRTSPServerCallback *callback) { callback->OnSetupReceived(client_ip, transport, request.uri_); });
-    } else if (method == "PLAY") {
-        std::string range = "";
-        auto it = request.general_header_.find("Range");
-        if (it != request.general_header_.end()) {
-            range = it->second;
+        case RTSPMethod::PLAY: {
+            std::string range = request.request_header_.range_.value_or("");
+            auto it = request.general_header_.find(HeaderId::RANGE);
+            if (range.empty() && it != request.general_header_.end()) {
+                range = it->second;
+            }
+            NotifyCallback([client_ip, uri = request.uri_, range](IRTSPServerCallback *callback) {
+                callback->OnPlayReceived(client_ip, uri, range);
+            });
+            break;
         }
-        NotifyCallback(
-            [&](IRTSPServerCallback *callback) { callback->OnPlayReceived(client_ip, request.uri_, range); });
-    } else if (method == "PAUSE") {
-        NotifyCallback([&](IRTSPServerCallback *callback) { callback->OnPauseReceived(client_ip, request.uri_); });
-    } else if (method == "TEARDOWN") {
-        NotifyCallback([&](IRTSPServerCallback *callback) { callback->OnTeardownReceived(client_ip, request.uri_); });
+        case RTSPMethod::PAUSE:
+            NotifyCallback([client_ip, uri = request.uri_](IRTSPServerCallback *callback) {
+                callback->OnPauseReceived(client_ip, uri);
+            });
+            break;
+        case RTSPMethod::TEARDOWN:
+            NotifyCallback([client_ip, uri = request.uri_](IRTSPServerCallback *callback) {
+                callback->OnTeardownReceived(client_ip, uri);
+            });
+            break;
+        default:
+            break;
     }
 
     // Send response
     auto lmnetSession = session->GetNetworkSession();
     if (lmnetSession) {
-        RTSP_LOGD("Send response: \n%s", response.ToString().c_str());
-        lmnetSession->Send(response.ToString());
+        SendResponse(lmnetSession, response);
     }
 }
 
-void RTSPServer::HandleStatelessRequest(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequest &request)
+bool RTSPServer::HandleKeepAlive(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequestView &request)
 {
-    RTSP_LOGD("Handling stateless %s request", request.method_.c_str());
-
-    RTSPResponse response;
-    int cseq = 0;
-
-    // Extract CSeq from request
-    if (request.general_header_.find(CSEQ) != request.general_header_.end()) {
-        cseq = std::stoi(request.general_header_.at(CSEQ));
+    const RTSPHeaderField *cseqField = request.Find(HeaderId::CSEQ);
+    uint32_t cseq = 0;
+    if (!lmnetSession || !cseqField || !RTSPUtils::parseNumber(cseqField->value, cseq) || cseq > INT32_MAX) {
+        return false;
     }
 
-    if (request.method_ == METHOD_OPTIONS) {
-        response = RTSPResponseFactory::CreateOptionsOK(cseq).SetServer("RTSP Server/1.0").Build();
-    } else if (request.method_ == METHOD_DESCRIBE) {
-        // Notify callback for stream request
-        std::string client_ip = "";
-        if (lmnetSession) {
-            client_ip = lmnetSession->host;
+    auto start = std::chrono::steady_clock::now();
+    switch (request.method_id) {
+        case RTSPMethod::OPTIONS:
+            SendSerialized(lmnetSession, OptionsResponse().WriteTo(ResponseBuffer(), static_cast<int>(cseq)));
+            break;
+        case RTSPMethod::GET_PARAMETER: {
+            // GET_PARAMETER without a body only refreshes the session timeout
+            const RTSPHeaderField *sessionField = request.Find(HeaderId::SESSION);
+            if (!request.body.empty() || !sessionField) {
+                return false;
+            }
+            std::string_view sessionId = RTSPUtils::sessionId(sessionField->value);
+            auto session = GetSession(std::string(sessionId));
+            if (!session) {
+                return false;
+            }
+            session->UpdateLastActiveTime();
+            SendSerialized(lmnetSession,
+                           KeepAliveResponse().WriteTo(ResponseBuffer(), static_cast<int>(cseq), sessionId));
+            break;
         }
-        RTSP_LOGD("invoke OnStreamRequested");
-        NotifyCallback([&](IRTSPServerCallback *callback) { callback->OnStreamRequested(request.uri_, client_ip); });
-
-        // Generate SDP for the requested stream
-        std::string sdp = GenerateSDP(request.uri_, GetServerIP(), GetServerPort());
-        response = RTSPResponseFactory::CreateDescribeOK(cseq).SetServer("RTSP Server/1.0").SetSdp(sdp).Build();
-    } else {
-        // This should not happen as we only call this for OPTIONS and DESCRIBE
-        response = RTSPResponseFactory::CreateMethodNotAllowed(cseq).Build();
+        default:
+            return false;
     }
+    requestMetrics_.Record(request.method_id, std::chrono::steady_clock::now() - start);
+    return true;
+}
 
-    // Send response
-    if (lmnetSession) {
-        RTSP_LOGD("Send stateless response: \n%s", response.ToString().c_str());
-        lmnetSession->Send(response.ToString());
+void RTSPServer::HandleStatelessRequest(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequest &request)
+{
+    RTSP_LOGD("Handling stateless %s request", request.method_.c_str());
+    auto start = std::chrono::steady_clock::now();
+
+    int cseq = request.cseq_;
+    switch (request.method_id_) {
+        case RTSPMethod::OPTIONS:
+            if (lmnetSession) {
+                SendSerialized(lmnetSession, OptionsResponse().WriteTo(ResponseBuffer(), cseq));
+            }
+            break;
+        case RTSPMethod::DESCRIBE: {
+            // Notify callback for stream request
+            std::string client_ip = "";
+            if (lmnetSession) {
+                client_ip = lmnetSession->host;
+            }
+            RTSP_LOGD("invoke OnStreamRequested");
+            NotifyCallback([uri = request.uri_, client_ip](IRTSPServerCallback *callback) {
+                callback->OnStreamRequested(uri, client_ip);
+            });
+
+            // Generate SDP for the requested stream
+            std::string sdp = GenerateSDP(request.uri_, GetServerIP(), GetServerPort());
+            if (lmnetSession) {
+                SendResponse(lmnetSession,
+                             RTSPResponseFactory::CreateDescribeOK(cseq).SetServer(kServerName).SetSdp(sdp).Build());
+            }
+            break;
+        }
+        default:
+            // This should not happen as we only call this for OPTIONS and DESCRIBE
+            if (lmnetSession) {
+                SendResponse(lmnetSession, RTSPResponseFactory::CreateMethodNotAllowed(cseq).Build());
+            }
+            break;
     }
+    requestMetrics_.Record(request.method_id_, std::chrono::steady_clock::now() - start);
 }
 
 void RTSPServer::SendErrorResponse(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequest &request,
                                    int statusCode, const std::string &reasonPhrase)
 {
-    int cseq = 0;
-
-    // Extract CSeq from request
-    if (request.general_header_.find(CSEQ) != request.general_header_.end()) {
-        cseq = std::stoi(request.general_header_.at(CSEQ));
-    }
+    // Errors may answer requests whose CSeq could not be read
+    int cseq = request.cseq_ < 0 ? 0 : request.cseq_;
 
     RTSPResponse response;
     switch (statusCode) {
@@ -198,6 +401,9 @@ void RTSPServer::SendErrorResponse(std::shared_ptr<lmnet::Session> lmnetSession,
         case 500:
             response = RTSPResponseFactory::CreateInternalServerError(cseq).Build();
             break;
+        case 503:
+            response = RTSPResponseFactory::CreateServiceUnavailable(cseq, admission_->RetryAfter()).Build();
+            break;
         default:
             response = RTSPResponseFactory::CreateError(static_cast<StatusCode>(statusCode), cseq).Build();
             break;
@@ -205,17 +411,106 @@ void RTSPServer::SendErrorResponse(std::shared_ptr<lmnet::Session> lmnetSession,
 
     // Send error response
     if (lmnetSession) {
-        RTSP_LOGD("Send error response (%d %s): \n%s", statusCode, reasonPhrase.c_str(), response.ToString().c_str());
-        lmnetSession->Send(response.ToString());
+        RTSP_LOGD("Send error response (%d %s)", statusCode, reasonPhrase.c_str());
+        SendResponse(lmnetSession, response);
     }
 }
 
+void RTSPServer::RefuseRequest(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequestView &request)
+{
+    const RTSPHeaderField *cseqField = request.Find(HeaderId::CSEQ);
+    uint32_t cseq = 0;
+    if (!cseqField || !RTSPUtils::parseNumber(cseqField->value, cseq) || cseq > INT32_MAX) {
+        cseq = 0;
+    }
+    RTSPRequest refused;
+    refused.cseq_ = static_cast<int>(cseq);
+    SendErrorResponse(lmnetSession, refused, 503, "Service Unavailable");
+}
+
+void RTSPServer::HandleSessionRequest(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequest &request)
+{
+    std::shared_ptr<RTSPSession> session;
+    if (!request.session_id_.empty()) {
+        session = GetSession(request.session_id_);
+    }
+
+    // SETUP without a known session starts a new one, any other request needs an existing session
+    if (!session && request.method_id_ == RTSPMethod::SETUP) {
+        std::string client_ip = lmnetSession ? lmnetSession->host : "";
+        if (!admission_->AdmitSession(sessions_->CountClient(client_ip))) {
+            RTSP_LOGW("Session limit of %s reached", client_ip.c_str());
+            SendErrorResponse(lmnetSession, request, 503, "Service Unavailable");
+            return;
+        }
+        session = CreateSession(lmnetSession);
+    }
+
+    if (session) {
+        HandleRequest(session, request);
+    } else {
+        RTSP_LOGE("Failed to create or find RTSP session for method: %s", request.method_.c_str());
+        SendErrorResponse(lmnetSession, request, 454, "Session Not Found");
+    }
+}
+
+bool RTSPServer::DeferRequest(std::shared_ptr<lmnet::Session> lmnetSession, const RTSPRequest &request,
+                              std::weak_ptr<RTSPServerListener> listener)
+{
+    if (request.method_id_ != RTSPMethod::DESCRIBE && request.method_id_ != RTSPMethod::SETUP) {
+        return false;
+    }
+    auto callback = GetCallback();
+    if (!callback) {
+        return false;
+    }
+
+    // The continuation owns a copy of the request, it may outlive the receive buffer. It is completed on whatever
+    // thread the application answers from, so the request goes back to the connection's reactor.
+    auto continuation = std::make_shared<RTSPContinuation>(
+        [weakServer = weak_from_this(), listener = std::move(listener), lmnetSession, request](int status_code) {
+            auto reactors = listener.lock();
+            if (!reactors) {
+                return;
+            }
+            reactors->Resume(lmnetSession, [weakServer, lmnetSession, request, status_code] {
+                auto server = weakServer.lock();
+                if (!server) {
+                    return;
+                }
+                if (status_code != 0) {
+                    server->SendErrorResponse(lmnetSession, request, status_code, "Deferred Request Rejected");
+                } else if (request.method_id_ == RTSPMethod::DESCRIBE) {
+                    server->HandleStatelessRequest(lmnetSession, request);
+                } else {
+                    server->HandleSessionRequest(lmnetSession, request);
+                }
+            });
+        });
+
+    std::string client_ip = lmnetSession ? lmnetSession->host : "";
+    if (!callback->OnRequestDeferred(request.method_id_, request.uri_, client_ip, continuation)) {
+        continuation->Dismiss();
+        return false;
+    }
+    RTSP_LOGD("%s %s deferred by application", request.method_.c_str(), request.uri_.c_str());
+    return true;
+}
+
 std::shared_ptr<RTSPSession> RTSPServer::CreateSession(std::shared_ptr<lmnet::Session> lmnetSession)
 {
-    auto session = std::make_shared<RTSPSession>(lmnetSession, weak_from_this());
+    int connection = lmnetSession ? lmnetSession->fd : -1;
+    std::string clientIP = lmnetSession ? lmnetSession->host : std::string();
+    // A key already in use is never handed out twice, a new session draws a fresh one
+    std::shared_ptr<RTSPSession> session;
+    do {
+        session = std::make_shared<RTSPSession>(lmnetSession, weak_from_this());
+        session->SetTimeout(sessionTimeout_.load(std::memory_order_relaxed));
+    } while (!sessions_->TryInsert(session->GetSessionKey(), session, connection, clientIP));
+    uint64_t key = session->GetSessionKey();
     {
-        std::lock_guard<std::mutex> lock(sessionsMutex_);
-        sessions_[session->GetSessionId()] = session;
+        std::lock_guard<std::mutex> lock(expiryMutex_);
+        expiryWheel_->Schedule(key, session->GetExpiryTime());
     }
     RTSP_LOGD("Created new RTSP session: %s", session->GetSessionId().c_str());
     return session;
@@ -223,28 +518,111 @@ std::shared_ptr<RTSPSession> RTSPServer::CreateSession(std::shared_ptr<lmnet::Se
 
 void RTSPServer::RemoveSession(const std::string &sessionId)
 {
-    std::lock_guard<std::mutex> lock(sessionsMutex_);
-    auto it = sessions_.find(sessionId);
-    if (it != sessions_.end()) {
+    uint64_t key = 0;
+    if (SessionId::Parse(sessionId, key) && sessions_->Remove(key)) {
         RTSP_LOGD("Removing RTSP session: %s", sessionId.c_str());
-        sessions_.erase(it);
     }
 }
 
-std::shared_ptr<RTSPSession> RTSPServer::GetSession(const std::string &sessionId)
+void RTSPServer::RemoveSessions(std::shared_ptr<lmnet::Session> lmnetSession)
 {
-    std::lock_guard<std::mutex> lock(sessionsMutex_);
-    auto it = sessions_.find(sessionId);
-    if (it != sessions_.end()) {
-        return it->second;
+    if (!lmnetSession) {
+        return;
     }
-    return nullptr;
+    for (const auto &session : sessions_->RemoveConnection(lmnetSession->fd)) {
+        RTSP_LOGD("Removing RTSP session: %s", session->GetSessionId().c_str());
+    }
+}
+
+std::shared_ptr<RTSPSession> RTSPServer::GetSession(const std::string &sessionId)
+{
+    uint64_t key = 0;
+    return SessionId::Parse(sessionId, key) ? sessions_->Find(key) : nullptr;
 }
 
 std::unordered_map<std::string, std::shared_ptr<RTSPSession>> RTSPServer::GetSessions()
 {
-    std::lock_guard<std::mutex> lock(sessionsMutex_);
-    return sessions_;
+    std::unordered_map<std::string, std::shared_ptr<RTSPSession>> sessions;
+    sessions_->ForEach([&](uint64_t, const std::shared_ptr<RTSPSession> &session) {
+        sessions.emplace(session->GetSessionId(), session);
+    });
+    return sessions;
+}
+
+void RTSPServer::SetSessionTimeout(uint32_t timeout_seconds)
+{
+    sessionTimeout_.store(std::clamp(timeout_seconds, RTSPSession::kMinTimeout, RTSPSession::kMaxTimeout));
+}
+
+uint32_t RTSPServer::GetSessionTimeout() const
+{
+    return sessionTimeout_.load();
+}
+
+void RTSPServer::ReapExpiredSessions()
+{
+    std::vector<uint64_t> due;
+    std::vector<std::pair<uint64_t, std::shared_ptr<RTSPSession>>> expired;
+
+    std::unique_lock<std::mutex> lock(expiryMutex_);
+    while (running_.load()) {
+        expiryCondition_.wait_for(lock, std::chrono::seconds(1), [this] { return !running_.load(); });
+
+        // A timer firing only means the session may be idle: refreshes just move its expiry time, so sessions
+        // that were active since are put back on the wheel at their current deadline
+        uint64_t now = RTSPSession::MonotonicSeconds();
+        due.clear();
+        expiryWheel_->Advance(now, due);
+        if (serverListener_) {
+            serverListener_->CloseRefused(std::chrono::steady_clock::now());
+        }
+        for (uint64_t id : due) {
+            auto session = sessions_->Find(id);
+            if (!session) {
+                continue;
+            }
+            uint64_t deadline = session->GetExpiryTime();
+            if (deadline > now) {
+                expiryWheel_->Schedule(id, deadline);
+            } else if (sessions_->Remove(id)) {
+                expired.emplace_back(id, std::move(session));
+            }
+        }
+        if (expired.empty()) {
+            continue;
+        }
+
+        // Tear the batch down without blocking new sessions
+        lock.unlock();
+        RTSP_LOGD("Reaping %zu expired sessions", expired.size());
+        for (auto &pair : expired) {
+            auto &session = pair.second;
+            std::string client_ip = GetClientIP(session);
+            RTSP_LOGD("Session %s expired after %u seconds", session->GetSessionId().c_str(), session->GetTimeout());
+            session->TeardownMedia("");
+            NotifyCallback([client_ip, session_id = session->GetSessionId()](IRTSPServerCallback *callback) {
+                callback->OnSessionExpired(client_ip, session_id);
+            });
+        }
+        expired.clear();
+        lock.lock();
+    }
+}
+
+void RTSPServer::Reclaim(std::function<void()> task)
+{
+    reclaimer_->Post(std::move(task));
+}
+
+void RTSPServer::StopReaper()
+{
+    {
+        std::lock_guard<std::mutex> lock(expiryMutex_);
+        expiryCondition_.notify_all();
+    }
+    if (reaperThread_.joinable()) {
+        reaperThread_.join();
+    }
 }
 
 // Callback interface implementation
@@ -261,94 +639,188 @@ std::shared_ptr<IRTSPServerCallback> RTSPServer::GetCallback() const
     return callback_;
 }
 
+void RTSPServer::SetCallbackExecutor(CallbackExecutor executor, size_t queue_capacity)
+{
+    // Events already queued still drain through the previous dispatcher
+    std::shared_ptr<CallbackDispatcher> dispatcher;
+    if (executor) {
+        dispatcher = std::make_shared<CallbackDispatcher>(std::move(executor), queue_capacity);
+    }
+    std::lock_guard<std::mutex> lock(callbackMutex_);
+    callbackDispatcher_ = std::move(dispatcher);
+}
+
+uint64_t RTSPServer::GetDroppedCallbacks() const
+{
+    return droppedCallbacks_.load(std::memory_order_relaxed);
+}
+
 // Media stream management implementation
 bool RTSPServer::AddMediaStream(const std::string &stream_path, std::shared_ptr<MediaStreamInfo> stream_info)
 {
-    std::lock_guard<std::mutex> lock(streamsMutex_);
-    mediaStreams_[stream_path] = stream_info;
+    mediaStreams_.Add(stream_path, std::move(stream_info));
     RTSP_LOGD("Added media stream: %s", stream_path.c_str());
     return true;
 }
 
 bool RTSPServer::RemoveMediaStream(const std::string &stream_path)
 {
-    std::lock_guard<std::mutex> lock(streamsMutex_);
-    auto it = mediaStreams_.find(stream_path);
-    if (it != mediaStreams_.end()) {
-        mediaStreams_.erase(it);
-        RTSP_LOGD("Removed media stream: %s", stream_path.c_str());
-        return true;
-    }
-    return false;
+    return RemoveMediaStreams({stream_path}) > 0;
 }
 
-std::shared_ptr<MediaStreamInfo> RTSPServer::GetMediaStream(const std::string &stream_path)
+void RTSPServer::AddMediaStreams(const MediaStreamRegistry::Batch &streams)
 {
-    std::lock_guard<std::mutex> lock(streamsMutex_);
+    mediaStreams_.Update(streams, {});
+    RTSP_LOGD("Added %zu media streams", streams.size());
+}
 
-    // Debug: Log all available streams
-    RTSP_LOGD("Looking for stream: %s", stream_path.c_str());
-    RTSP_LOGD("Available streams count: %zu", mediaStreams_.size());
-    for (const auto &pair : mediaStreams_) {
-        RTSP_LOGD("  - Stream: '%s'", pair.first.c_str());
+size_t RTSPServer::RemoveMediaStreams(const std::vector<std::string> &stream_paths)
+{
+    size_t removed = mediaStreams_.Update({}, stream_paths);
+    if (removed > 0) {
+        RTSP_LOGD("Removed %zu media streams", removed);
+        std::lock_guard<std::mutex> keyframeLock(keyframeMutex_);
+        for (const auto &path : stream_paths) {
+            lastKeyframeRequest_.erase(path);
+        }
     }
+    return removed;
+}
 
-    auto it = mediaStreams_.find(stream_path);
-    if (it != mediaStreams_.end()) {
-        RTSP_LOGD("Stream found: %s", stream_path.c_str());
-        return it->second;
+std::shared_ptr<MediaStreamInfo> RTSPServer::GetMediaStream(const std::string &stream_path)
+{
+    auto entry = mediaStreams_.Find(stream_path);
+    if (entry) {
+        return entry->info;
     }
     RTSP_LOGD("Stream not found: %s", stream_path.c_str());
     return nullptr;
 }
 
+void RTSPServer::InvalidateSDP(const std::string &stream_path)
+{
+    if (auto entry = mediaStreams_.Find(stream_path)) {
+        entry->InvalidateSDP();
+    }
+}
+
 std::vector<std::string> RTSPServer::GetMediaStreamPaths() const
 {
-    std::lock_guard<std::mutex> lock(streamsMutex_);
-    std::vector<std::string> paths;
-    for (const auto &pair : mediaStreams_) {
-        paths.push_back(pair.first);
+    return mediaStreams_.Paths();
+}
+
+// Media fan-out implementation
+size_t RTSPServer::PushFrame(const std::string &stream_path, lmrtp::MediaFrame frame)
+{
+    auto entry = mediaStreams_.Find(stream_path);
+    auto subscribers = entry ? entry->GetSubscribers() : nullptr;
+    if (!subscribers || subscribers->empty()) {
+        return 0;
     }
-    return paths;
+
+    // One immutable copy shared by every subscriber's send queue
+    auto shared = std::make_shared<const lmrtp::MediaFrame>(std::move(frame));
+    size_t delivered = 0;
+    for (const auto &subscriber : *subscribers) {
+        if (auto session = subscriber.lock()) {
+            delivered += session->DeliverFrame(shared);
+        }
+    }
+    return delivered;
 }
 
-// Client management implementation
-std::vector<std::string> RTSPServer::GetConnectedClients() const
+std::shared_ptr<MediaStreamRegistry::Entry> RTSPServer::FindStream(const std::string &uri, std::string &path) const
 {
-    std::lock_guard<std::mutex> lock(sessionsMutex_);
-    std::vector<std::string> clients;
-    for (const auto &pair : sessions_) {
-        auto session = pair.second;
-        if (session && session->GetNetworkSession()) {
-            clients.push_back(session->GetNetworkSession()->host);
+    // SETUP and PLAY may address a track below the stream path, e.g. /live/track1
+    path = RTSPUtils::urlPath(uri);
+    auto entry = mediaStreams_.Find(path);
+    if (!entry) {
+        size_t slash = path.find_last_of('/');
+        if (slash != std::string::npos && slash > 0) {
+            path.resize(slash);
+            entry = mediaStreams_.Find(path);
         }
     }
-    return clients;
+    return entry;
 }
 
-bool RTSPServer::DisconnectClient(const std::string &client_ip)
+bool RTSPServer::Subscribe(const std::string &uri, std::shared_ptr<RTSPSession> session)
 {
-    std::lock_guard<std::mutex> lock(sessionsMutex_);
-    std::vector<std::string> sessionsToRemove;
+    std::string path;
+    auto entry = FindStream(uri, path);
+    if (!entry) {
+        RTSP_LOGD("No registered stream for %s, session %s not subscribed", uri.c_str(),
+                  session->GetSessionId().c_str());
+        return false;
+    }
+    entry->Subscribe(session);
+    session->SetStreamPath(entry->path);
+    return true;
+}
 
-    for (const auto &pair : sessions_) {
-        auto session = pair.second;
-        if (session && session->GetNetworkSession() && session->GetNetworkSession()->host == client_ip) {
-            sessionsToRemove.push_back(pair.first);
+bool RTSPServer::AdmitPlay(const std::shared_ptr<RTSPSession> &session, const RTSPRequest &request)
+{
+    // Resuming or repeating PLAY keeps the place the session already has
+    if (session->IsPlaying()) {
+        return true;
+    }
+    std::string path;
+    auto entry = FindStream(request.uri_, path);
+    if (!entry) {
+        return true;
+    }
+    size_t playing = 0;
+    if (auto subscribers = entry->GetSubscribers()) {
+        for (const auto &subscriber : *subscribers) {
+            auto existing = subscriber.lock();
+            if (existing && existing != session) {
+                ++playing;
+            }
         }
     }
+    return admission_->AdmitPlay(playing);
+}
 
-    for (const auto &sessionId : sessionsToRemove) {
-        sessions_.erase(sessionId);
+bool RTSPServer::ReserveEgress(const std::shared_ptr<RTSPSession> &session, const RTSPRequest &request)
+{
+    if (session->IsPlaying() || egressBudget_->GetCapacity() == 0) {
+        return true;
     }
+    // Streams that do not declare a bitrate are only limited by the token bucket
+    std::string path;
+    auto entry = FindStream(request.uri_, path);
+    uint32_t bitrate = entry ? entry->info->bitrate : 0;
+    if (bitrate == 0) {
+        return true;
+    }
+    if (!egressBudget_->Reserve(bitrate)) {
+        return false;
+    }
+    session->SetReservedBitrate(bitrate);
+    return true;
+}
 
-    return !sessionsToRemove.empty();
+void RTSPServer::Unsubscribe(const std::string &stream_path, const RTSPSession *session)
+{
+    if (auto entry = mediaStreams_.Find(stream_path)) {
+        entry->Unsubscribe(session);
+    }
+}
+
+// Client management implementation
+std::vector<std::string> RTSPServer::GetConnectedClients() const
+{
+    return sessions_->Clients();
+}
+
+bool RTSPServer::DisconnectClient(const std::string &client_ip)
+{
+    return !sessions_->RemoveClient(client_ip).empty();
 }
 
 size_t RTSPServer::GetClientCount() const
 {
-    std::lock_guard<std::mutex> lock(sessionsMutex_);
-    return sessions_.size();
+    return sessions_->Size();
 }
 
 // Server information
@@ -357,6 +829,20 @@ bool RTSPServer::IsRunning() const
     return running_.load();
 }
 
+void RTSPServer::SetReactorCount(size_t count)
+{
+    if (serverListener_) {
+        RTSP_LOGW("Reactor count has to be set before Init");
+        return;
+    }
+    reactorCount_ = count;
+}
+
+size_t RTSPServer::GetReactorCount() const
+{
+    return reactorCount_;
+}
+
 std::string RTSPServer::GetServerIP() const
 {
     return serverIP_;
@@ -367,50 +853,108 @@ uint16_t RTSPServer::GetServerPort() const
     return serverPort_;
 }
 
+void RTSPServer::RequestKeyframe(const std::string &stream_path, const std::string &client_ip)
+{
+    auto now = std::chrono::steady_clock::now();
+    auto interval = std::chrono::milliseconds(keyframeIntervalMs_.load(std::memory_order_relaxed));
+    {
+        std::lock_guard<std::mutex> lock(keyframeMutex_);
+        auto it = lastKeyframeRequest_.find(stream_path);
+        if (it != lastKeyframeRequest_.end() && now - it->second < interval) {
+            RTSP_LOGD("Keyframe request for %s from %s coalesced", stream_path.c_str(), client_ip.c_str());
+            return;
+        }
+        lastKeyframeRequest_[stream_path] = now;
+    }
+
+    RTSP_LOGD("Keyframe requested for %s by %s", stream_path.c_str(), client_ip.c_str());
+    NotifyCallback([stream_path, client_ip](IRTSPServerCallback *callback) {
+        callback->OnKeyframeRequested(stream_path, client_ip);
+    });
+}
+
+void RTSPServer::SetAdmissionLimits(const AdmissionLimits &limits)
+{
+    admission_->SetLimits(limits);
+}
+
+AdmissionLimits RTSPServer::GetAdmissionLimits() const
+{
+    return admission_->GetLimits();
+}
+
+uint64_t RTSPServer::GetRefusedCount() const
+{
+    return admission_->Refused();
+}
+
+void RTSPServer::SetEgressCapacity(uint64_t bits_per_second)
+{
+    egressBudget_->SetCapacity(bits_per_second);
+}
+
+bool RTSPServer::ConsumeEgress(size_t bytes, uint64_t now_us)
+{
+    return egressBudget_->Consume(bytes, now_us);
+}
+
+void RTSPServer::ReleaseEgress(uint64_t bitrate)
+{
+    egressBudget_->Release(bitrate);
+}
+
+uint64_t RTSPServer::GetEgressDroppedBytes() const
+{
+    return egressBudget_->DroppedBytes();
+}
+
+void RTSPServer::SetKeyframeRequestInterval(uint32_t interval_ms)
+{
+    keyframeIntervalMs_.store(interval_ms, std::memory_order_relaxed);
+}
+
+void RTSPServer::SetTransportSupport(const TransportSupport &support)
+{
+    std::lock_guard<std::mutex> lock(transportMutex_);
+    transportSupport_ = support;
+}
+
+TransportSupport RTSPServer::GetTransportSupport() const
+{
+    std::lock_guard<std::mutex> lock(transportMutex_);
+    return transportSupport_;
+}
+
 // SDP generation implementation
 std::string RTSPServer::GenerateSDP(const std::string &stream_path, const std::string &server_ip, uint16_t server_port)
 {
     // Extract path from full RTSP URL if needed
-    std::string path = stream_path;
-    if (stream_path.find("rtsp://") == 0) {
-        // Find the path part after host:port
-        size_t schemeEnd = stream_path.find("://");
-        if (schemeEnd != std::string::npos) {
-            size_t hostStart = schemeEnd + 3;
-            size_t pathStart = stream_path.find('/', hostStart);
-            if (pathStart != std::string::npos) {
-                path = stream_path.substr(pathStart);
-            }
-        }
-    }
+    std::string path(RTSPUtils::urlPath(stream_path));
 
-    auto stream_info = GetMediaStream(path);
-    if (!stream_info) {
+    auto entry = mediaStreams_.Find(path);
+    if (!entry || !entry->info) {
         RTSP_LOGE("Media stream not found: %s (original: %s)", path.c_str(), stream_path.c_str());
         return "";
     }
-
-    // Basic SDP generation logic
-    std::string sdp;
-    sdp += "v=0\r\n";
-    sdp += "o=- 0 0 IN IP4 " + server_ip + "\r\n";
-    sdp += "s=RTSP Session\r\n";
-    sdp += "c=IN IP4 " + server_ip + "\r\n";
-    sdp += "t=0 0\r\n";
-
-    if (stream_info->media_type == "video") {
-        sdp += "m=video " + std::to_string(server_port) + " RTP/AVP 96\r\n";
-        sdp += "a=rtpmap:96 " + stream_info->codec + "/90000\r\n";
-        if (stream_info->width > 0 && stream_info->height > 0) {
-            sdp += "a=framerate:" + std::to_string(stream_info->frame_rate) + "\r\n";
-        }
-    } else if (stream_info->media_type == "audio") {
-        sdp += "m=audio " + std::to_string(server_port) + " RTP/AVP 97\r\n";
-        sdp += "a=rtpmap:97 " + stream_info->codec + "/" + std::to_string(stream_info->sample_rate) + "\r\n";
+    auto media = entry->GetSDP();
+    if (!media || media->server_port != server_port) {
+        // Concurrent misses may render twice, both results are identical
+        auto rendered = std::make_shared<MediaStreamRegistry::Entry::CachedSDP>();
+        rendered->server_port = server_port;
+        rendered->text = RenderMediaSection(*entry->info, server_port);
+        media = rendered;
+        entry->SetSDP(std::move(rendered));
     }
 
-    sdp += "a=control:" + stream_path + "\r\n";
-
+    // Only the origin address and the control URL differ between requests
+    std::string sdp;
+    sdp.reserve(96 + 2 * server_ip.size() + media->text.size() + stream_path.size());
+    sdp.append("v=0\r\n");
+    sdp.append("o=- 0 0 IN IP4 ").append(server_ip).append("\r\n");
+    sdp.append("s=RTSP Session\r\n");
+    sdp.append("c=IN IP4 ").append(server_ip).append("\r\n");
+    sdp.append(media->text);
+    sdp.append("a=control:").append(stream_path).append("\r\n");
     return sdp;
 }
 
@@ -425,9 +969,24 @@ std::string RTSPServer::GetClientIP(std::shared_ptr<RTSPSession> session) const
 
 void RTSPServer::NotifyCallback(std::function<void(IRTSPServerCallback *)> func)
 {
-    std::lock_guard<std::mutex> lock(callbackMutex_);
-    if (callback_) {
-        func(callback_.get());
+    // User code never runs under callbackMutex_, it may call back into the server
+    std::shared_ptr<IRTSPServerCallback> callback;
+    std::shared_ptr<CallbackDispatcher> dispatcher;
+    {
+        std::lock_guard<std::mutex> lock(callbackMutex_);
+        callback = callback_;
+        dispatcher = callbackDispatcher_;
+    }
+    if (!callback) {
+        return;
+    }
+    if (!dispatcher) {
+        func(callback.get());
+        return;
+    }
+    if (!dispatcher->Post([callback, func = std::move(func)] { func(callback.get()); })) {
+        droppedCallbacks_.fetch_add(1, std::memory_order_relaxed);
+        RTSP_LOGW("Callback queue full, event dropped");
     }
 }
 
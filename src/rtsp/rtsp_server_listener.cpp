@@ -11,48 +11,117 @@
 #include <lmcore/data_buffer.h>
 #include <lmnet/session.h>
 
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/socket.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+#include "admission_control.h"
 #include "internal_logger.h"
 #include "rtsp_request.h"
+#include "rtsp_request_parser.h"
 #include "rtsp_server.h"
-#include "rtsp_session.h"
 
 namespace lmshao::lmrtsp {
 
-// Helper function: Get all session IDs
-// Since RTSPServer class doesn't provide GetAllSessions method, we need an alternative
-// This function is a temporary solution, in actual application RTSPServer class should be modified to add
-// GetAllSessions method
-std::vector<std::string> GetSessionIds(std::shared_ptr<RTSPServer> server)
+RTSPServerListener::RTSPServerListener(std::shared_ptr<RTSPServer> server, size_t reactors)
+    : rtspServer_(server), threaded_(reactors > 0)
 {
-    std::vector<std::string> sessionIds;
+    for (size_t i = 0; i < std::max<size_t>(reactors, 1); ++i) {
+        reactors_.push_back(std::make_unique<Reactor>());
+    }
+    RTSP_LOGD("RTSPServerListener created with %zu reactors", reactors);
+}
 
-    // Note: This is a temporary implementation, we actually cannot get all session IDs
-    // Because RTSPServer class doesn't provide method to access sessions_ member
-    // In actual application, RTSPServer class should be modified to add GetAllSessions method
+RTSPServerListener::~RTSPServerListener()
+{
+    Stop();
+}
 
-    // Since we cannot get all sessions, return an empty list here
-    // This means we cannot properly clean up RTSP sessions related to disconnected lmnet sessions
-    // This may cause memory leaks or other issues
+void RTSPServerListener::Start()
+{
+    if (!threaded_) {
+        return;
+    }
+    for (auto &reactor : reactors_) {
+        std::lock_guard<std::mutex> lock(reactor->mutex);
+        if (reactor->running) {
+            continue;
+        }
+        reactor->running = true;
+        reactor->thread = std::thread(&RTSPServerListener::RunReactor, std::ref(*reactor));
+    }
+}
 
-    return sessionIds;
+void RTSPServerListener::Stop()
+{
+    for (auto &reactor : reactors_) {
+        {
+            std::lock_guard<std::mutex> lock(reactor->mutex);
+            reactor->running = false;
+        }
+        reactor->condition.notify_all();
+        if (reactor->thread.joinable()) {
+            reactor->thread.join();
+        }
+    }
 }
 
-RTSPServerListener::RTSPServerListener(std::shared_ptr<RTSPServer> server) : rtspServer_(server)
+void RTSPServerListener::Execute(lmnet::socket_t fd, std::function<void(Reactor &)> task)
 {
-    RTSP_LOGD("RTSPServerListener created");
+    Reactor &reactor = *reactors_[static_cast<size_t>(fd) % reactors_.size()];
+    {
+        std::lock_guard<std::mutex> lock(reactor.mutex);
+        if (reactor.running) {
+            reactor.tasks.push_back([&reactor, task = std::move(task)] { task(reactor); });
+            reactor.condition.notify_one();
+            return;
+        }
+    }
+    // The network thread and deferred requests resumed by the application may both get here
+    std::lock_guard<std::recursive_mutex> lock(reactor.inlineMutex);
+    task(reactor);
+}
+
+void RTSPServerListener::RunReactor(Reactor &reactor)
+{
+    std::unique_lock<std::mutex> lock(reactor.mutex);
+    while (true) {
+        reactor.condition.wait(lock, [&reactor] { return !reactor.running || !reactor.tasks.empty(); });
+        if (reactor.tasks.empty()) {
+            return;
+        }
+        auto task = std::move(reactor.tasks.front());
+        reactor.tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
 }
 
 void RTSPServerListener::OnError(std::shared_ptr<lmnet::Session> session, const std::string &errorInfo)
 {
     RTSP_LOGE("Network error: %s", errorInfo.c_str());
 
-    // Clean up incomplete request data
-    incompleteRequests_.erase(session->fd);
+    ReleaseConnection(session->fd);
+    {
+        std::lock_guard<std::mutex> lock(refusedMutex_);
+        refused_.erase(session->fd);
+    }
+
+    // Drop buffered request data
+    Execute(session->fd, [fd = session->fd](Reactor &reactor) { reactor.receiveBuffers.erase(fd); });
 
     // Notify callback
     auto server = rtspServer_.lock();
     if (server) {
-        server->NotifyCallback([&](IRTSPServerCallback *callback) { callback->OnError(session->host, -1, errorInfo); });
+        server->NotifyCallback([host = session->host, errorInfo](IRTSPServerCallback *callback) {
+            callback->OnError(host, -1, errorInfo);
+        });
     }
 }
 
@@ -60,44 +129,54 @@ void RTSPServerListener::OnClose(std::shared_ptr<lmnet::Session> session)
 {
     RTSP_LOGD("Client disconnected: %s:%d", session->host.c_str(), session->port);
 
-    // Clean up incomplete request data
-    incompleteRequests_.erase(session->fd);
+    ReleaseConnection(session->fd);
+    {
+        std::lock_guard<std::mutex> lock(refusedMutex_);
+        refused_.erase(session->fd);
+    }
 
     // Notify callback about client disconnection
     auto server = rtspServer_.lock();
     if (server) {
-        server->NotifyCallback([&](IRTSPServerCallback *callback) { callback->OnClientDisconnected(session->host); });
-
-        // Traverse all sessions to find RTSP sessions using this lmnet session
-        // Note: We need to traverse all sessions and check if lmnet sessions match
-        std::vector<std::string> sessionsToRemove;
-
-        // Get all session IDs and check lmnet sessions
-        auto sessions = server->GetSessions();
-        for (const auto &pair : sessions) {
-            auto rtspSession = pair.second;
-            if (rtspSession && rtspSession->GetNetworkSession() == session) {
-                // Found related session, mark for deletion
-                sessionsToRemove.push_back(pair.first);
-            }
-        }
+        server->NotifyCallback(
+            [host = session->host](IRTSPServerCallback *callback) { callback->OnClientDisconnected(host); });
+    }
 
-        // Delete marked sessions
-        for (const auto &sessionId : sessionsToRemove) {
-            server->RemoveSession(sessionId);
+    // Queued behind the connection's pending requests, so their sessions are dropped too
+    Execute(session->fd, [this, session](Reactor &reactor) {
+        reactor.receiveBuffers.erase(session->fd);
+        if (auto server = rtspServer_.lock()) {
+            server->RemoveSessions(session);
         }
-    }
+    });
 }
 
 void RTSPServerListener::OnAccept(std::shared_ptr<lmnet::Session> session)
 {
     RTSP_LOGD("New client connected: %s:%d", session->host.c_str(), session->port);
 
-    // Notify callback about client connection
     auto server = rtspServer_.lock();
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    if (server &&
+        !server->admission_->AdmitConnection(std::chrono::duration_cast<std::chrono::milliseconds>(now).count())) {
+        // The first request is answered 503 without sessions or callbacks, then the connection is closed
+        RTSP_LOGW("Refusing connection from %s:%d", session->host.c_str(), session->port);
+        {
+            std::lock_guard<std::mutex> lock(refusedMutex_);
+            refused_[session->fd] = {session, std::chrono::steady_clock::now() + kRefusedGrace};
+        }
+        Execute(session->fd, [fd = session->fd](Reactor &reactor) { reactor.receiveBuffers[fd].refused = true; });
+        return;
+    }
+    if (server) {
+        std::lock_guard<std::mutex> lock(admittedMutex_);
+        admitted_.insert(session->fd);
+    }
+
+    // Notify callback about client connection
     if (server) {
-        server->NotifyCallback([&](IRTSPServerCallback *callback) {
-            callback->OnClientConnected(session->host, ""); // User-Agent will be obtained from RTSP request
+        server->NotifyCallback([host = session->host](IRTSPServerCallback *callback) {
+            callback->OnClientConnected(host, ""); // User-Agent will be obtained from RTSP request
         });
     }
 
@@ -106,120 +185,186 @@ void RTSPServerListener::OnAccept(std::shared_ptr<lmnet::Session> session)
 
 void RTSPServerListener::OnReceive(std::shared_ptr<lmnet::Session> session, std::shared_ptr<lmcore::DataBuffer> buffer)
 {
-    // Get received data
-    std::string data(reinterpret_cast<const char *>(buffer->Data()), buffer->Size());
-    RTSP_LOGD("Received data from %s:%d, size: %zu", session->host.c_str(), session->port, data.size());
+    RTSP_LOGD("Received data from %s:%d, size: %zu", session->host.c_str(), session->port, buffer->Size());
 
-    // Check if there's previously incomplete request data
-    auto it = incompleteRequests_.find(session->fd);
-    if (it != incompleteRequests_.end()) {
-        // Merge previous data
-        data = it->second + data;
-        incompleteRequests_.erase(it);
-    }
+    Execute(session->fd, [this, session, buffer](Reactor &reactor) { HandleReceive(reactor, session, buffer); });
+}
+
+void RTSPServerListener::Resume(std::shared_ptr<lmnet::Session> session, std::function<void()> task)
+{
+    lmnet::socket_t fd = session->fd;
+    Execute(fd, [session = std::move(session), task = std::move(task)](Reactor &reactor) {
+        // OnClose erases the buffer before a new connection on the same socket gets one
+        auto it = reactor.receiveBuffers.find(session->fd);
+        if (it == reactor.receiveBuffers.end() || it->second.connection.lock() != session) {
+            RTSP_LOGD("Connection from %s:%d closed, dropping deferred request", session->host.c_str(),
+                      session->port);
+            return;
+        }
+        task();
+    });
+}
 
-    // Parse RTSP request
-    if (!ParseRTSPRequest(data, session)) {
-        // If parsing fails, data might be incomplete, save it and wait for more data
-        HandleIncompleteData(session, data);
+void RTSPServerListener::ReleaseConnection(lmnet::socket_t fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(admittedMutex_);
+        if (admitted_.erase(fd) == 0) {
+            return;
+        }
+    }
+    if (auto server = rtspServer_.lock()) {
+        server->admission_->ReleaseConnection();
     }
 }
 
-bool RTSPServerListener::ParseRTSPRequest(const std::string &data, std::shared_ptr<lmnet::Session> session)
+void RTSPServerListener::CloseConnection(const std::shared_ptr<lmnet::Session> &session)
 {
-    // Check if it's a complete RTSP request
-    // RTSP request ends with \r\n\r\n, or if there's message body, need to check Content-Length
-    size_t headerEnd = data.find(CRLFCRLF);
-    if (headerEnd == std::string::npos) {
-        RTSP_LOGD("Incomplete RTSP request, waiting for more data");
-        return false;
+    std::lock_guard<std::mutex> lock(refusedMutex_);
+    auto it = refused_.find(session->fd);
+    // Gone or replaced: OnClose already ran and the socket may belong to a new connection
+    if (it == refused_.end() || it->second.session.lock() != session) {
+        return;
     }
+    refused_.erase(it);
+    ShutdownSocket(session->fd);
+}
 
-    // Parse request headers
-    std::string headerData = data.substr(0, headerEnd + 4); // Include \r\n\r\n
-    // Check Content-Length
-    size_t contentLengthPos = headerData.find(CONTENT_LENGTH);
-    int contentLength = 0;
-    if (contentLengthPos != std::string::npos) {
-        size_t valueStart = headerData.find_first_not_of(SP, contentLengthPos + 15);
-        size_t valueEnd = headerData.find(CRLF, valueStart);
-        if (valueStart != std::string::npos && valueEnd != std::string::npos) {
-            contentLength = std::stoi(headerData.substr(valueStart, valueEnd - valueStart));
+void RTSPServerListener::CloseRefused(std::chrono::steady_clock::time_point now)
+{
+    // OnClose erases under the same lock, so no socket here can have been closed and reused yet
+    std::lock_guard<std::mutex> lock(refusedMutex_);
+    for (auto it = refused_.begin(); it != refused_.end();) {
+        if (it->second.deadline > now) {
+            ++it;
+            continue;
+        }
+        if (auto session = it->second.session.lock()) {
+            RTSP_LOGD("Closing refused connection from %s:%d", session->host.c_str(), session->port);
+            ShutdownSocket(session->fd);
         }
+        it = refused_.erase(it);
     }
+}
 
-    // Check if there's complete message body
-    if (data.size() < headerEnd + 4 + contentLength) {
-        RTSP_LOGD("Incomplete RTSP request body, waiting for more data");
-        return false;
+void RTSPServerListener::ShutdownSocket(lmnet::socket_t fd)
+{
+#ifdef _WIN32
+    ::shutdown(fd, SD_BOTH);
+#else
+    ::shutdown(fd, SHUT_RDWR);
+#endif
+}
+
+void RTSPServerListener::HandleReceive(Reactor &reactor, std::shared_ptr<lmnet::Session> session,
+                                       std::shared_ptr<lmcore::DataBuffer> buffer)
+{
+    ReceiveBuffer &receiveBuffer = reactor.receiveBuffers[session->fd];
+    if (receiveBuffer.connection.expired()) {
+        receiveBuffer.connection = session;
+    }
+    if (receiveBuffer.rejected) {
+        return;
     }
 
-    // Extract complete request data
-    std::string completeRequest = data.substr(0, headerEnd + 4 + contentLength);
+    const char *data = reinterpret_cast<const char *>(buffer->Data());
+    receiveBuffer.data.insert(receiveBuffer.data.end(), data, data + buffer->Size());
+    ProcessReceiveBuffer(session, receiveBuffer);
+}
 
-    // Use RTSPRequest::FromString to parse request
-    try {
-        auto request = RTSPRequest::FromString(completeRequest);
+void RTSPServerListener::ProcessReceiveBuffer(std::shared_ptr<lmnet::Session> session, ReceiveBuffer &buffer)
+{
+    // Pipelined requests are framed one after another from the consumed cursor
+    while (buffer.consumed < buffer.data.size()) {
+        std::string_view pending(buffer.data.data() + buffer.consumed, buffer.data.size() - buffer.consumed);
+        auto status = buffer.parser.Parse(pending);
+        if (status == RTSPRequestParser::Status::INCOMPLETE) {
+            break;
+        }
 
-        // Get server instance
-        auto server = rtspServer_.lock();
-        if (!server) {
-            RTSP_LOGE("RTSP server instance not available");
-            return false;
-        }
-
-        // Handle stateless requests (OPTIONS, DESCRIBE) directly without creating session
-        if (request.method_ == METHOD_OPTIONS || request.method_ == METHOD_DESCRIBE) {
-            RTSP_LOGD("Handle stateless request: \n%s", completeRequest.c_str());
-            server->HandleStatelessRequest(session, request);
-        } else {
-            // Get or create RTSP session for stateful requests
-            std::shared_ptr<RTSPSession> rtspSession = nullptr;
-
-            // Check if session ID already exists
-            std::string sessionId;
-            if (request.general_header_.find(SESSION) != request.general_header_.end()) {
-                sessionId = request.general_header_.at(SESSION);
-                rtspSession = server->GetSession(sessionId);
+        if (status != RTSPRequestParser::Status::COMPLETE) {
+            // Without a valid frame the rest of the stream cannot be delimited
+            bool tooLarge = status == RTSPRequestParser::Status::TOO_LARGE;
+            RTSP_LOGE("%s RTSP request from %s:%d, ignoring further data", tooLarge ? "Oversized" : "Malformed",
+                      session->host.c_str(), session->port);
+            if (auto server = rtspServer_.lock()) {
+                server->SendErrorResponse(session, RTSPRequest(), tooLarge ? 413 : 400,
+                                          tooLarge ? "Request Entity Too Large" : "Bad Request");
             }
+            buffer.rejected = true;
+            buffer.data.clear();
+            buffer.data.shrink_to_fit();
+            buffer.consumed = 0;
+            return;
+        }
 
-            // For SETUP request, create a new session if none exists
-            // For other requests, session must already exist
-            if (!rtspSession && request.method_ == METHOD_SETUP) {
-                rtspSession = server->CreateSession(session);
-            }
+        RTSP_LOGD("Handle request: \n%.*s", static_cast<int>(buffer.parser.MessageSize()), pending.data());
+        size_t messageSize = buffer.parser.MessageSize();
 
-            // Handle request
-            if (rtspSession) {
-                RTSP_LOGD("Handle request: \n%s", completeRequest.c_str());
-                server->HandleRequest(rtspSession, request);
-            } else {
-                RTSP_LOGE("Failed to create or find RTSP session for method: %s", request.method_.c_str());
-                // Send error response for requests that require a session but don't have one
-                server->SendErrorResponse(session, request, 454, "Session Not Found");
-            }
+        // Refusals and keep-alives are answered from the parsed view without building an RTSPRequest
+        auto server = rtspServer_.lock();
+        if (server && buffer.refused) {
+            server->RefuseRequest(session, buffer.parser.Request());
+            CloseConnection(session);
+            buffer.rejected = true;
+            buffer.data.clear();
+            buffer.data.shrink_to_fit();
+            buffer.consumed = 0;
+            return;
+        }
+        if (server && server->HandleKeepAlive(session, buffer.parser.Request())) {
+            buffer.consumed += messageSize;
+            buffer.parser.Reset();
+            continue;
         }
 
-        // Check if there's remaining data (may contain multiple requests
-        if (completeRequest.size() < data.size()) {
-            std::string remainingData = data.substr(completeRequest.size());
-            // Recursively process remaining data
-            ParseRTSPRequest(remainingData, session);
+        RTSPRequest request = buffer.parser.ToRequest();
+        buffer.consumed += messageSize;
+        buffer.parser.Reset();
+        try {
+            DispatchRequest(session, request);
+        } catch (const std::exception &e) {
+            RTSP_LOGE("Failed to handle RTSP request: %s", e.what());
         }
+    }
 
-        return true;
-    } catch (const std::exception &e) {
-        RTSP_LOGE("Failed to parse RTSP request: %s", e.what());
-        return false;
+    // Compact once per receive so the buffer only ever holds the partial request
+    if (buffer.consumed == buffer.data.size()) {
+        buffer.data.clear();
+    } else if (buffer.consumed > 0) {
+        buffer.data.erase(buffer.data.begin(), buffer.data.begin() + buffer.consumed);
     }
+    buffer.consumed = 0;
 }
 
-void RTSPServerListener::HandleIncompleteData(std::shared_ptr<lmnet::Session> session, const std::string &data)
+void RTSPServerListener::DispatchRequest(std::shared_ptr<lmnet::Session> session, const RTSPRequest &request)
 {
-    // Store incomplete data, wait for more data to arrive
-    incompleteRequests_[session->fd] = data;
-    RTSP_LOGD("Stored incomplete request data for client %s:%d, size: %zu", session->host.c_str(), session->port,
-              data.size());
+    auto server = rtspServer_.lock();
+    if (!server) {
+        RTSP_LOGE("RTSP server instance not available");
+        return;
+    }
+
+    // Every response has to echo CSeq, so requests without a usable one are answered right away
+    if (request.cseq_ < 0) {
+        RTSP_LOGW("Missing or invalid CSeq in %s request", request.method_.c_str());
+        server->SendErrorResponse(session, request, 400, "Bad Request");
+        return;
+    }
+
+    // DESCRIBE and SETUP may be finished later by the application
+    if (server->DeferRequest(session, request, weak_from_this())) {
+        return;
+    }
+
+    // Handle stateless requests (OPTIONS, DESCRIBE) directly without creating session
+    if (request.method_id_ == RTSPMethod::OPTIONS || request.method_id_ == RTSPMethod::DESCRIBE) {
+        server->HandleStatelessRequest(session, request);
+        return;
+    }
+
+    // Stateful requests go through their RTSP session
+    server->HandleSessionRequest(session, request);
 }
 
 } // namespace lmshao::lmrtsp
\ No newline at end of file
@@ -12,18 +12,37 @@
 #include <lmnet/common.h>
 #include <lmnet/iserver_listener.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "rtsp_request_parser.h"
 
 namespace lmshao::lmrtsp {
 
+class RTSPRequest;
 class RTSPServer;
 
 // Observer pattern: RTSP server listener
-class RTSPServerListener : public lmnet::IServerListener {
+class RTSPServerListener : public lmnet::IServerListener,
+                           public std::enable_shared_from_this<RTSPServerListener> {
 public:
-    explicit RTSPServerListener(std::shared_ptr<RTSPServer> server);
+    // With reactors > 0, parsing and request handling run on that many threads instead of the network thread.
+    // Connections are spread by socket, so each connection's requests are still handled in order.
+    explicit RTSPServerListener(std::shared_ptr<RTSPServer> server, size_t reactors = 0);
+    ~RTSPServerListener();
+
+    void Start();
+    // Finish the work already handed to the reactors
+    void Stop();
 
     // Implement IServerListener interface
     void OnError(std::shared_ptr<lmnet::Session> session, const std::string &errorInfo) override;
@@ -31,17 +50,82 @@ public:
     void OnAccept(std::shared_ptr<lmnet::Session> session) override;
     void OnReceive(std::shared_ptr<lmnet::Session> session, std::shared_ptr<lmcore::DataBuffer> buffer) override;
 
+    // Run the rest of a deferred request on the connection's reactor, after the requests already queued there.
+    // Dropped if the connection closed in the meantime, even if its socket went to a new connection.
+    void Resume(std::shared_ptr<lmnet::Session> session, std::function<void()> task);
+
+    // Close refused connections that sent no request before their deadline
+    void CloseRefused(std::chrono::steady_clock::time_point now);
+
+    // Limits applied to every request received on a connection
+    static constexpr size_t kMaxHeaderSize = 8 * 1024;
+    static constexpr size_t kMaxBodySize = 64 * 1024;
+    // Time a refused connection gets to send the request its 503 answers
+    static constexpr std::chrono::milliseconds kRefusedGrace{2000};
+
 private:
-    // Parse RTSP request
-    bool ParseRTSPRequest(const std::string &data, std::shared_ptr<lmnet::Session> session);
+    // Bytes received on one connection; everything before consumed has already been dispatched
+    struct ReceiveBuffer {
+        ReceiveBuffer() { parser.SetLimits(kMaxHeaderSize, kMaxBodySize); }
+
+        std::vector<char> data;
+        size_t consumed = 0;
+        RTSPRequestParser parser;
+        bool rejected = false; // Framing was lost, further data is ignored until the connection closes
+        bool refused = false;  // Over the admission limits: one 503, then the connection is closed
+        std::weak_ptr<lmnet::Session> connection; // Tells the connection apart from a later one on the same socket
+    };
+
+    // Owns the receive buffers of its connections; without a thread it runs on the network thread
+    struct Reactor {
+        std::unordered_map<lmnet::socket_t, ReceiveBuffer> receiveBuffers;
+        std::mutex mutex;
+        // Serializes tasks run on the caller's thread, i.e. without a reactor thread
+        std::recursive_mutex inlineMutex;
+        std::condition_variable condition;
+        std::deque<std::function<void()>> tasks;
+        bool running = false;
+        std::thread thread;
+    };
 
-    // Handle incomplete request data
-    void HandleIncompleteData(std::shared_ptr<lmnet::Session> session, const std::string &data);
+    // Run task on the reactor that owns the connection
+    void Execute(lmnet::socket_t fd, std::function<void(Reactor &)> task);
+    static void RunReactor(Reactor &reactor);
+
+    // Release the admission of a connection once, whether it ends in an error or a close
+    void ReleaseConnection(lmnet::socket_t fd);
+    // Shut a refused connection's socket down if it is still open; the network thread sees the end of the stream
+    // and closes it as usual
+    void CloseConnection(const std::shared_ptr<lmnet::Session> &session);
+    // Only called under refusedMutex_ for a socket still in refused_
+    static void ShutdownSocket(lmnet::socket_t fd);
+
+    void HandleReceive(Reactor &reactor, std::shared_ptr<lmnet::Session> session,
+                       std::shared_ptr<lmcore::DataBuffer> buffer);
+
+    // Frame and dispatch every complete request in the buffer
+    void ProcessReceiveBuffer(std::shared_ptr<lmnet::Session> session, ReceiveBuffer &buffer);
+
+    // Route one complete request to the server
+    void DispatchRequest(std::shared_ptr<lmnet::Session> session, const RTSPRequest &request);
 
     std::weak_ptr<RTSPServer> rtspServer_;
 
-    // Store incomplete request data
-    std::unordered_map<lmnet::socket_t, std::string> incompleteRequests_;
+    // Connection state partitioned by socket, each part only touched by its reactor
+    std::vector<std::unique_ptr<Reactor>> reactors_;
+    bool threaded_ = false;
+
+    // Connections counted by admission control
+    std::mutex admittedMutex_;
+    std::unordered_set<lmnet::socket_t> admitted_;
+
+    // Refused connections still open, closed at the latest when their deadline passes
+    struct RefusedConnection {
+        std::weak_ptr<lmnet::Session> session;
+        std::chrono::steady_clock::time_point deadline;
+    };
+    std::mutex refusedMutex_;
+    std::unordered_map<lmnet::socket_t, RefusedConnection> refused_;
 };
 
 } // namespace lmshao::lmrtsp
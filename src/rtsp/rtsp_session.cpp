@@ -8,9 +8,11 @@
 
 #include "rtsp_session.h"
 
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <ctime>
 #include <functional>
-#include <random>
 #include <string>
 #include <unordered_map>
 
@@ -20,45 +22,74 @@
 #include "rtsp_response.h"
 #include "rtsp_server.h"
 #include "rtsp_session_state.h"
+#include "rtsp_transport.h"
+#include "rtsp_utils.h"
+#include "session_id.h"
 
 namespace lmshao::lmrtsp {
 
-RTSPSession::RTSPSession(std::shared_ptr<lmnet::Session> lmnetSession) : lmnetSession_(lmnetSession), timeout_(60)
-{ // Default 60 seconds timeout
+namespace {
+
+using StateHandler = RTSPResponse (RTSPSessionState::*)(RTSPSession *, const RTSPRequest &);
+
+// State machine entry point for each RTSPMethod, nullptr where the server has no implementation
+constexpr std::array<StateHandler, kRTSPMethodCount> kStateHandlers = {
+    &RTSPSessionState::OnOptions,      // OPTIONS
+    &RTSPSessionState::OnDescribe,     // DESCRIBE
+    &RTSPSessionState::OnAnnounce,     // ANNOUNCE
+    &RTSPSessionState::OnSetup,        // SETUP
+    &RTSPSessionState::OnPlay,         // PLAY
+    &RTSPSessionState::OnPause,        // PAUSE
+    &RTSPSessionState::OnTeardown,     // TEARDOWN
+    &RTSPSessionState::OnRecord,       // RECORD
+    &RTSPSessionState::OnGetParameter, // GET_PARAMETER
+    &RTSPSessionState::OnSetParameter, // SET_PARAMETER
+    nullptr,                           // REDIRECT
+    nullptr,                           // UNKNOWN
+};
+
+} // namespace
+
+RTSPSession::RTSPSession(std::shared_ptr<lmnet::Session> lmnetSession)
+    : lmnetSession_(lmnetSession), timeout_(kDefaultTimeout)
+{
 
     // Generate session ID
-    sessionId_ = GenerateSessionId();
+    sessionKey_ = SessionId::Generate();
 
     // Initialize last active time
-    lastActiveTime_ = std::time(nullptr);
+    UpdateLastActiveTime();
 
     // Initialize state machine to Initial state
     currentState_ = InitialState::GetInstance();
 
-    RTSP_LOGD("RTSPSession created with ID: %s", sessionId_.c_str());
+    RTSP_LOGD("RTSPSession created with ID: %s", GetSessionId().c_str());
 }
 
 RTSPSession::RTSPSession(std::shared_ptr<lmnet::Session> lmnetSession, std::weak_ptr<RTSPServer> server)
-    : lmnetSession_(lmnetSession), rtspServer_(server), timeout_(60)
+    : lmnetSession_(lmnetSession), rtspServer_(server), timeout_(kDefaultTimeout)
 {
     // Generate session ID
-    sessionId_ = GenerateSessionId();
+    sessionKey_ = SessionId::Generate();
 
     // Initialize last active time
-    lastActiveTime_ = std::time(nullptr);
+    UpdateLastActiveTime();
 
     // Initialize state machine to Initial state
     currentState_ = InitialState::GetInstance();
 
-    RTSP_LOGD("RTSPSession created with ID: %s and server reference", sessionId_.c_str());
+    RTSP_LOGD("RTSPSession created with ID: %s and server reference", GetSessionId().c_str());
 }
 
 RTSPSession::~RTSPSession()
 {
-    RTSP_LOGD("RTSPSession destroyed: %s", sessionId_.c_str());
+    RTSP_LOGD("RTSPSession destroyed: %s", GetSessionId().c_str());
 
-    // Clean up media streams
-    mediaStreams_.clear();
+    // Release media streams off the network thread while the server is still there
+    ReleaseReservedBitrate();
+    if (media_) {
+        ReleaseMediaStreams(std::move(media_->streams));
+    }
 }
 
 RTSPResponse RTSPSession::ProcessRequest(const RTSPRequest &request)
@@ -66,44 +97,27 @@ RTSPResponse RTSPSession::ProcessRequest(const RTSPRequest &request)
     // Update last active time
     UpdateLastActiveTime();
 
+    // Clients may ask for their own timeout in the Session header, up to the one the server is configured with
+    auto sessionHeader = request.general_header_.find(HeaderId::SESSION);
+    if (sessionHeader != request.general_header_.end()) {
+        if (uint32_t timeout = RTSPUtils::sessionTimeout(sessionHeader->second); timeout != 0) {
+            auto server = rtspServer_.lock();
+            SetTimeout(std::min(timeout, server ? server->GetSessionTimeout() : kDefaultTimeout));
+        }
+    }
+
     // Use state machine to process request
     if (!currentState_) {
         // Fallback: initialize to Initial state if not set
         currentState_ = InitialState::GetInstance();
     }
 
-    const std::string &method = request.method_;
-
-    // Delegate to state machine based on method
-    if (method == "OPTIONS") {
-        return currentState_->OnOptions(this, request);
-    } else if (method == "DESCRIBE") {
-        return currentState_->OnDescribe(this, request);
-    } else if (method == "ANNOUNCE") {
-        return currentState_->OnAnnounce(this, request);
-    } else if (method == "RECORD") {
-        return currentState_->OnRecord(this, request);
-    } else if (method == "SETUP") {
-        return currentState_->OnSetup(this, request);
-    } else if (method == "PLAY") {
-        return currentState_->OnPlay(this, request);
-    } else if (method == "PAUSE") {
-        return currentState_->OnPause(this, request);
-    } else if (method == "TEARDOWN") {
-        return currentState_->OnTeardown(this, request);
-    } else if (method == "GET_PARAMETER") {
-        return currentState_->OnGetParameter(this, request);
-    } else if (method == "SET_PARAMETER") {
-        return currentState_->OnSetParameter(this, request);
-    } else {
-        // Unknown method
-        int cseq = 0;
-        auto cseq_it = request.general_header_.find("CSeq");
-        if (cseq_it != request.general_header_.end()) {
-            cseq = std::stoi(cseq_it->second);
-        }
-        return RTSPResponseBuilder().SetStatus(StatusCode::NotImplemented).SetCSeq(cseq).Build();
+    // Delegate to the state machine through the per-method handler table
+    auto handler = kStateHandlers[static_cast<size_t>(request.method_id_)];
+    if (!handler) {
+        return RTSPResponseBuilder().SetStatus(StatusCode::NotImplemented).SetCSeq(request.cseq_).Build();
     }
+    return (currentState_.get()->*handler)(this, request);
 }
 
 void RTSPSession::ChangeState(std::shared_ptr<RTSPSessionState> newState)
@@ -118,7 +132,7 @@ std::shared_ptr<RTSPSessionState> RTSPSession::GetCurrentState() const
 
 std::string RTSPSession::GetSessionId() const
 {
-    return sessionId_;
+    return SessionId::Format(sessionKey_);
 }
 
 std::string RTSPSession::GetClientIP() const
@@ -151,37 +165,67 @@ bool RTSPSession::SetupMedia(const std::string &uri, const std::string &transpor
 {
     RTSP_LOGD("Setting up media for URI: %s, Transport: %s", uri.c_str(), transport.c_str());
 
-    // Parse transport parameters
-    rtpTransportParams_ = ParseTransportHeader(transport);
-
-    // Extract client ports from transport header
-    uint16_t clientRtpPort = 0, clientRtcpPort = 0;
-    size_t clientPortPos = transport.find("client_port=");
-    if (clientPortPos != std::string::npos) {
-        size_t portStart = clientPortPos + 12; // Length of "client_port="
-        size_t portEnd = transport.find(';', portStart);
-        if (portEnd == std::string::npos) {
-            portEnd = transport.length();
-        }
-        std::string portRange = transport.substr(portStart, portEnd - portStart);
-        size_t dashPos = portRange.find('-');
-        if (dashPos != std::string::npos) {
-            clientRtpPort = static_cast<uint16_t>(std::stoi(portRange.substr(0, dashPos)));
-            clientRtcpPort = static_cast<uint16_t>(std::stoi(portRange.substr(dashPos + 1)));
-        }
+    TransportSupport support;
+    if (auto server = rtspServer_.lock()) {
+        support = server->GetTransportSupport();
+    }
+
+    // Multicast goes to the group configured for the stream, never to one a client names
+    auto info = GetMediaStreamInfo();
+    MulticastGroup group;
+    if (info && !info->multicast_ip.empty() && info->rtp_port != 0) {
+        group.address = info->multicast_ip;
+        group.rtp_port = info->rtp_port;
+        group.rtcp_port = info->rtcp_port != 0 ? info->rtcp_port : static_cast<uint16_t>(info->rtp_port + 1);
+        group.ttl = info->ttl;
+    }
+    support.multicast = support.multicast && !group.address.empty();
+
+    TransportOffer offer;
+    const TransportSpec *spec = ParseTransport(transport, offer) ? SelectTransport(offer, support) : nullptr;
+    if (!spec) {
+        RTSP_LOGW("No supported transport in: %s", transport.c_str());
+        return false;
     }
 
-    // Allocate server ports (simple allocation for demo)
-    uint16_t serverRtpPort = 6000 + (std::hash<std::string>{}(sessionId_) % 1000) * 2;
-    uint16_t serverRtcpPort = serverRtpPort + 1;
+    RTPTransportParams params;
+    ApplyTransport(*spec, group, params);
+    params.client_ip = GetClientIP();
 
     // Build transport info for response
-    transportInfo_ = transport + ";server_port=" + std::to_string(serverRtpPort) + "-" + std::to_string(serverRtcpPort);
+    std::string transportInfo;
+    AppendTransport(transportInfo, *spec, group);
+
+    // Unicast UDP is sent by a stream of the session, interleaved and multicast media by the application's sender
+    std::shared_ptr<MediaStream> stream;
+    if (spec->unicast && spec->lower_transport == LowerTransport::UDP) {
+        stream = MediaStreamFactory::CreateStream(uri, info ? info->media_type : "video");
+        stream->SetSession(weak_from_this());
+        if (!stream->Setup(transport, params.client_ip)) {
+            RTSP_LOGE("Failed to set up media stream for %s", uri.c_str());
+            stream->Teardown();
+            return false;
+        }
+        params.server_rtp_port = stream->GetServerRtpPort();
+        params.server_rtcp_port = stream->GetServerRtcpPort();
+        transportInfo += ";server_port=" + std::to_string(params.server_rtp_port) + "-" +
+                         std::to_string(params.server_rtcp_port);
+    }
+    {
+        std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+        MediaState &media = Media();
+        media.params = params;
+        media.transportInfo = transportInfo;
+        if (stream) {
+            stream->SetTrackIndex(static_cast<int>(media.streams.size()));
+            media.streams.push_back(stream);
+        }
+    }
 
     // Set setup flag
     isSetup_ = true;
 
-    RTSP_LOGD("Media setup completed for session: %s, Transport: %s", sessionId_.c_str(), transportInfo_.c_str());
+    RTSP_LOGD("Media setup completed for session: %s, Transport: %s", GetSessionId().c_str(), transportInfo.c_str());
     return true;
 }
 
@@ -194,11 +238,26 @@ bool RTSPSession::PlayMedia(const std::string &uri, const std::string &range)
         return false;
     }
 
+    for (const auto &stream : CopyMediaStreams()) {
+        StreamState state = stream->GetState();
+        if ((state == StreamState::READY || state == StreamState::PAUSED) && !stream->Play(range)) {
+            RTSP_LOGE("Failed to play media stream %s", stream->GetUri().c_str());
+            return false;
+        }
+    }
+
     // Set playing state
     isPlaying_ = true;
     isPaused_ = false;
 
-    RTSP_LOGD("Media playback started for session: %s", sessionId_.c_str());
+    // Start receiving the frames published for the stream
+    if (auto server = rtspServer_.lock()) {
+        if (auto self = weak_from_this().lock()) {
+            server->Subscribe(uri, self);
+        }
+    }
+
+    RTSP_LOGD("Media playback started for session: %s", GetSessionId().c_str());
     return true;
 }
 
@@ -215,7 +274,18 @@ bool RTSPSession::PauseMedia(const std::string &uri)
     isPaused_ = true;
     isPlaying_ = false;
 
-    RTSP_LOGD("Media playback paused for session: %s", sessionId_.c_str());
+    for (const auto &stream : CopyMediaStreams()) {
+        if (stream->GetState() == StreamState::PLAYING) {
+            stream->Pause();
+        }
+    }
+
+    if (auto server = rtspServer_.lock()) {
+        server->Unsubscribe(GetStreamPath(), this);
+    }
+    ReleaseReservedBitrate();
+
+    RTSP_LOGD("Media playback paused for session: %s", GetSessionId().c_str());
     return true;
 }
 
@@ -228,44 +298,108 @@ bool RTSPSession::TeardownMedia(const std::string &uri)
     isPaused_ = false;
     isSetup_ = false;
 
-    // Clear media streams
-    mediaStreams_.clear();
+    if (auto server = rtspServer_.lock()) {
+        server->Unsubscribe(GetStreamPath(), this);
+    }
+    ReleaseReservedBitrate();
+
+    // The TEARDOWN reply goes out right away, the streams stop and close on the reclaimer
+    std::vector<std::shared_ptr<MediaStream>> streams;
+    {
+        std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+        if (media_) {
+            streams.swap(media_->streams);
+        }
+    }
+    ReleaseMediaStreams(std::move(streams));
 
-    RTSP_LOGD("Media teardown completed for session: %s", sessionId_.c_str());
+    RTSP_LOGD("Media teardown completed for session: %s", GetSessionId().c_str());
     return true;
 }
 
+void RTSPSession::SetReservedBitrate(uint32_t bitrate)
+{
+    // A reservation being replaced is given back
+    if (uint32_t previous = reservedBitrate_.exchange(bitrate); previous != 0) {
+        if (auto server = rtspServer_.lock()) {
+            server->ReleaseEgress(previous);
+        }
+    }
+}
+
+void RTSPSession::ReleaseReservedBitrate()
+{
+    SetReservedBitrate(0);
+}
+
+void RTSPSession::ReleaseMediaStreams(std::vector<std::shared_ptr<MediaStream>> streams)
+{
+    if (streams.empty()) {
+        return;
+    }
+    auto release = [streams = std::move(streams)]() {
+        for (const auto &stream : streams) {
+            stream->Teardown();
+        }
+    };
+    if (auto server = rtspServer_.lock()) {
+        server->Reclaim(std::move(release));
+    } else {
+        release();
+    }
+}
+
+RTSPSession::MediaState &RTSPSession::Media()
+{
+    if (!media_) {
+        media_ = std::make_unique<MediaState>();
+    }
+    return *media_;
+}
+
 void RTSPSession::SetSdpDescription(const std::string &sdp)
 {
-    sdpDescription_ = sdp;
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    Media().sdpDescription = sdp;
 }
 
 std::string RTSPSession::GetSdpDescription() const
 {
-    return sdpDescription_;
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    return media_ ? media_->sdpDescription : std::string();
 }
 
 void RTSPSession::SetTransportInfo(const std::string &transport)
 {
-    transportInfo_ = transport;
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    Media().transportInfo = transport;
 }
 
 std::string RTSPSession::GetTransportInfo() const
 {
-    return transportInfo_;
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    return media_ ? media_->transportInfo : std::string();
 }
 
 std::shared_ptr<MediaStream> RTSPSession::GetMediaStream(int track_index)
 {
-    if (track_index >= 0 && track_index < static_cast<int>(mediaStreams_.size())) {
-        return mediaStreams_[track_index];
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    if (media_ && track_index >= 0 && track_index < static_cast<int>(media_->streams.size())) {
+        return media_->streams[track_index];
     }
     return nullptr;
 }
 
+std::vector<std::shared_ptr<MediaStream>> RTSPSession::CopyMediaStreams() const
+{
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    return media_ ? media_->streams : std::vector<std::shared_ptr<MediaStream>>();
+}
+
 const std::vector<std::shared_ptr<MediaStream>> &RTSPSession::GetMediaStreams() const
 {
-    return mediaStreams_;
+    static const std::vector<std::shared_ptr<MediaStream>> kNoStreams;
+    return media_ ? media_->streams : kNoStreams;
 }
 
 bool RTSPSession::IsPlaying() const
@@ -283,91 +417,146 @@ bool RTSPSession::IsSetup() const
     return isSetup_;
 }
 
+uint64_t RTSPSession::MonotonicSeconds()
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(now).count());
+}
+
 void RTSPSession::UpdateLastActiveTime()
 {
-    lastActiveTime_ = std::time(nullptr);
+    lastActiveTime_.store(MonotonicSeconds(), std::memory_order_relaxed);
 }
 
 bool RTSPSession::IsExpired(uint32_t timeout_seconds) const
 {
-    time_t current_time = std::time(nullptr);
-    return (current_time - lastActiveTime_) > timeout_seconds;
+    return MonotonicSeconds() - lastActiveTime_.load(std::memory_order_relaxed) > timeout_seconds;
 }
 
 time_t RTSPSession::GetLastActiveTime() const
 {
-    return lastActiveTime_;
+    // Activity is tracked on the monotonic clock, converted back to wall time for callers
+    uint64_t idle = MonotonicSeconds() - lastActiveTime_.load(std::memory_order_relaxed);
+    return std::time(nullptr) - static_cast<time_t>(idle);
 }
 
-std::string RTSPSession::GenerateSessionId()
+void RTSPSession::SetTimeout(uint32_t timeout_seconds)
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> dis(100000, 999999);
+    timeout_.store(std::clamp(timeout_seconds, kMinTimeout, kMaxTimeout), std::memory_order_relaxed);
+}
 
-    return std::to_string(dis(gen));
+uint32_t RTSPSession::GetTimeout() const
+{
+    return timeout_.load(std::memory_order_relaxed);
 }
 
-RTPTransportParams RTSPSession::ParseTransportHeader(const std::string &transport) const
+uint64_t RTSPSession::GetExpiryTime() const
 {
-    RTPTransportParams params;
-    // TODO: Implement transport header parsing
-    return params;
+    return lastActiveTime_.load(std::memory_order_relaxed) + GetTimeout();
+}
+
+void RTSPSession::SetStreamPath(std::shared_ptr<const std::string> stream_path)
+{
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    streamPath_ = std::move(stream_path);
+}
+
+std::string RTSPSession::GetStreamPath() const
+{
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    return streamPath_ ? *streamPath_ : std::string();
+}
+
+size_t RTSPSession::DeliverFrame(const std::shared_ptr<const lmrtp::MediaFrame> &frame)
+{
+    if (!isPlaying_) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    if (!media_) {
+        return 0;
+    }
+    size_t queued = 0;
+    for (const auto &stream : media_->streams) {
+        if (stream && stream->GetState() == StreamState::PLAYING) {
+            stream->PushFrame(frame);
+            queued++;
+        }
+    }
+    return queued;
 }
 
 void RTSPSession::SetMediaStreamInfo(std::shared_ptr<MediaStreamInfo> stream_info)
 {
     std::lock_guard<std::mutex> lock(mediaInfoMutex_);
-    mediaStreamInfo_ = stream_info;
+    Media().info = stream_info;
 }
 
 std::shared_ptr<MediaStreamInfo> RTSPSession::GetMediaStreamInfo() const
 {
     std::lock_guard<std::mutex> lock(mediaInfoMutex_);
-    return mediaStreamInfo_;
+    return media_ ? media_->info : nullptr;
 }
 
 void RTSPSession::SetRTPSender(std::shared_ptr<IRTPSender> rtp_sender)
 {
     std::lock_guard<std::mutex> lock(mediaInfoMutex_);
-    rtpSender_ = rtp_sender;
+    Media().sender = rtp_sender;
 }
 
 std::shared_ptr<IRTPSender> RTSPSession::GetRTPSender() const
 {
     std::lock_guard<std::mutex> lock(mediaInfoMutex_);
-    return rtpSender_;
+    return media_ ? media_->sender : nullptr;
 }
 
 bool RTSPSession::HasRTPSender() const
 {
     std::lock_guard<std::mutex> lock(mediaInfoMutex_);
-    return rtpSender_ != nullptr;
+    return media_ && media_->sender != nullptr;
 }
 
 void RTSPSession::SetRTPTransportParams(const RTPTransportParams &params)
 {
     std::lock_guard<std::mutex> lock(mediaInfoMutex_);
-    rtpTransportParams_ = params;
+    Media().params = params;
 }
 
 RTPTransportParams RTSPSession::GetRTPTransportParams() const
 {
     std::lock_guard<std::mutex> lock(mediaInfoMutex_);
-    return rtpTransportParams_;
+    return media_ ? media_->params : RTPTransportParams();
 }
 
 bool RTSPSession::HasValidTransport() const
 {
     std::lock_guard<std::mutex> lock(mediaInfoMutex_);
-    // TODO: Implement transport validation logic
-    return true;
+    return media_ && (media_->params.interleaved || media_->params.client_rtp_port != 0);
 }
 
 RTPStatistics RTSPSession::GetRTPStatistics() const
 {
     RTPStatistics stats;
-    // TODO: Implement RTP statistics collection
+    std::lock_guard<std::mutex> lock(mediaInfoMutex_);
+    if (!media_) {
+        return stats;
+    }
+    for (const auto &stream : media_->streams) {
+        if (!stream) {
+            continue;
+        }
+        RTPStatistics track = stream->GetStatistics();
+        stats.packets_sent += track.packets_sent;
+        stats.bytes_sent += track.bytes_sent;
+        stats.packets_lost += track.packets_lost;
+        stats.packets_retransmitted += track.packets_retransmitted;
+        stats.bandwidth += track.bandwidth;
+        stats.jitter = std::max(stats.jitter, track.jitter);
+        stats.rtt = std::max(stats.rtt, track.rtt);
+        stats.loss_rate = std::max(stats.loss_rate, track.loss_rate);
+        stats.last_sr_timestamp = std::max(stats.last_sr_timestamp, track.last_sr_timestamp);
+        stats.last_rr_timestamp = std::max(stats.last_rr_timestamp, track.last_rr_timestamp);
+    }
     return stats;
 }
 
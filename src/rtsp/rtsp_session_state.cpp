@@ -21,7 +21,7 @@ namespace {
 RTSPResponse HandleOptions(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing OPTIONS request");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder()
                         .SetStatus(StatusCode::OK)
                         .SetCSeq(cseq)
@@ -33,7 +33,7 @@ RTSPResponse HandleOptions(RTSPSession *session, const RTSPRequest &request)
 RTSPResponse HandleDescribe(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing DESCRIBE request");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     RTSPResponseBuilder builder;
 
     // Get server reference from session
@@ -43,11 +43,9 @@ RTSPResponse HandleDescribe(RTSPSession *session, const RTSPRequest &request)
         std::string uri = request.uri_;
         std::string streamName = uri.substr(uri.find_last_of('/') + 1);
 
-        // Check if stream exists using GetMediaStream
-        auto streamInfo = serverPtr->GetMediaStream(streamName);
-        if (streamInfo) {
-            // Generate SDP description for the stream
-            std::string sdp = serverPtr->GenerateSDP(streamName, serverPtr->GetServerIP(), serverPtr->GetServerPort());
+        // Generate SDP description for the stream, empty if the stream does not exist
+        std::string sdp = serverPtr->GenerateSDP(streamName, serverPtr->GetServerIP(), serverPtr->GetServerPort());
+        if (!sdp.empty()) {
             session->SetSdpDescription(sdp);
 
             return builder.SetStatus(StatusCode::OK)
@@ -68,15 +66,16 @@ RTSPResponse HandleDescribe(RTSPSession *session, const RTSPRequest &request)
 RTSPResponse HandleGetParameter(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing GET_PARAMETER request");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
-    auto response = RTSPResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
+    int cseq = request.cseq_;
+    auto response =
+        RTSPResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).SetSession(session->GetSessionId()).Build();
     return response;
 }
 
 RTSPResponse HandleSetParameter(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing SET_PARAMETER request");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
     return response;
 }
@@ -84,7 +83,7 @@ RTSPResponse HandleSetParameter(RTSPSession *session, const RTSPRequest &request
 RTSPResponse HandleAnnounce(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing ANNOUNCE request");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::NotImplemented).SetCSeq(cseq).Build();
     return response;
 }
@@ -92,7 +91,7 @@ RTSPResponse HandleAnnounce(RTSPSession *session, const RTSPRequest &request)
 RTSPResponse HandleRecord(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing RECORD request");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::NotImplemented).SetCSeq(cseq).Build();
     return response;
 }
@@ -133,40 +132,46 @@ RTSPResponse InitialState::OnSetParameter(RTSPSession *session, const RTSPReques
 RTSPResponse InitialState::OnSetup(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing SETUP request in InitialState");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
+
+    auto transport = request.general_header_.find(TRANSPORT);
+    if (transport == request.general_header_.end()) {
+        return RTSPResponseBuilder().SetStatus(StatusCode::UnsupportedTransport).SetCSeq(cseq).Build();
+    }
 
-    if (session->SetupMedia(request.uri_, request.general_header_.at("Transport"))) {
+    if (session->SetupMedia(request.uri_, transport->second)) {
         session->ChangeState(ReadyState::GetInstance());
         auto response = RTSPResponseBuilder()
                             .SetStatus(StatusCode::OK)
                             .SetCSeq(cseq)
-                            .SetSession(session->GetSessionId())
+                            .SetSession(session->GetSessionId() + ";timeout=" + std::to_string(session->GetTimeout()))
                             .SetTransport(session->GetTransportInfo())
                             .Build();
         return response;
     } else {
-        auto response = RTSPResponseBuilder().SetStatus(StatusCode::InternalServerError).SetCSeq(cseq).Build();
+        // None of the offered transports can be served
+        auto response = RTSPResponseBuilder().SetStatus(StatusCode::UnsupportedTransport).SetCSeq(cseq).Build();
         return response;
     }
 }
 
 RTSPResponse InitialState::OnPlay(RTSPSession *session, const RTSPRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
 
 RTSPResponse InitialState::OnPause(RTSPSession *session, const RTSPRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
 
 RTSPResponse InitialState::OnTeardown(RTSPSession *session, const RTSPRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
     return response;
 }
@@ -204,7 +209,7 @@ RTSPResponse ReadyState::OnSetParameter(RTSPSession *session, const RTSPRequest
 
 RTSPResponse ReadyState::OnSetup(RTSPSession *session, const RTSPRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
@@ -212,7 +217,7 @@ RTSPResponse ReadyState::OnSetup(RTSPSession *session, const RTSPRequest &reques
 RTSPResponse ReadyState::OnPlay(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing PLAY request in ReadyState");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
 
     std::string range = "";
     if (request.request_header_.range_) {
@@ -236,7 +241,7 @@ RTSPResponse ReadyState::OnPlay(RTSPSession *session, const RTSPRequest &request
 
 RTSPResponse ReadyState::OnPause(RTSPSession *session, const RTSPRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
@@ -244,7 +249,7 @@ RTSPResponse ReadyState::OnPause(RTSPSession *session, const RTSPRequest &reques
 RTSPResponse ReadyState::OnTeardown(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing TEARDOWN request in ReadyState");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
 
     session->TeardownMedia(request.uri_);
     session->ChangeState(InitialState::GetInstance());
@@ -286,14 +291,14 @@ RTSPResponse PlayingState::OnSetParameter(RTSPSession *session, const RTSPReques
 
 RTSPResponse PlayingState::OnSetup(RTSPSession *session, const RTSPRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
 
 RTSPResponse PlayingState::OnPlay(RTSPSession *session, const RTSPRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
     return response;
 }
@@ -301,7 +306,7 @@ RTSPResponse PlayingState::OnPlay(RTSPSession *session, const RTSPRequest &reque
 RTSPResponse PlayingState::OnPause(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing PAUSE request in PlayingState");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
 
     if (session->PauseMedia(request.uri_)) {
         session->ChangeState(PausedState::GetInstance());
@@ -316,7 +321,7 @@ RTSPResponse PlayingState::OnPause(RTSPSession *session, const RTSPRequest &requ
 RTSPResponse PlayingState::OnTeardown(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing TEARDOWN request in PlayingState");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
 
     session->TeardownMedia(request.uri_);
     session->ChangeState(InitialState::GetInstance());
@@ -358,7 +363,7 @@ RTSPResponse PausedState::OnSetParameter(RTSPSession *session, const RTSPRequest
 
 RTSPResponse PausedState::OnSetup(RTSPSession *session, const RTSPRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::MethodNotValidInThisState).SetCSeq(cseq).Build();
     return response;
 }
@@ -366,7 +371,7 @@ RTSPResponse PausedState::OnSetup(RTSPSession *session, const RTSPRequest &reque
 RTSPResponse PausedState::OnPlay(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing PLAY request in PausedState");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
 
     std::string range = "";
     if (request.request_header_.range_) {
@@ -390,7 +395,7 @@ RTSPResponse PausedState::OnPlay(RTSPSession *session, const RTSPRequest &reques
 
 RTSPResponse PausedState::OnPause(RTSPSession *session, const RTSPRequest &request)
 {
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
     auto response = RTSPResponseBuilder().SetStatus(StatusCode::OK).SetCSeq(cseq).Build();
     return response;
 }
@@ -398,7 +403,7 @@ RTSPResponse PausedState::OnPause(RTSPSession *session, const RTSPRequest &reque
 RTSPResponse PausedState::OnTeardown(RTSPSession *session, const RTSPRequest &request)
 {
     RTSP_LOGD("Processing TEARDOWN request in PausedState");
-    int cseq = std::stoi(request.general_header_.at("CSeq"));
+    int cseq = request.cseq_;
 
     session->TeardownMedia(request.uri_);
     session->ChangeState(InitialState::GetInstance());
@@ -0,0 +1,204 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rtsp_session_table.h"
+
+#include <algorithm>
+
+namespace lmshao::lmrtsp {
+
+namespace {
+
+template <typename Index, typename Key>
+void EraseId(Index &index, const Key &key, uint64_t id)
+{
+    auto it = index.find(key);
+    if (it == index.end()) {
+        return;
+    }
+    auto &ids = it->second;
+    ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+    if (ids.empty()) {
+        index.erase(it);
+    }
+}
+
+} // namespace
+
+void RTSPSessionTable::Insert(uint64_t id, std::shared_ptr<RTSPSession> session, int connection,
+                              const std::string &client_ip)
+{
+    Slot replaced;
+    Shard &shard = ShardOf(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto &slot = shard.sessions[id];
+    bool existed = slot.session != nullptr;
+    replaced = std::move(slot);
+    slot = Slot{std::move(session), connection, client_ip};
+
+    std::lock_guard<std::mutex> indexLock(indexMutex_);
+    if (existed) {
+        Unindex(id, replaced.connection, replaced.client_ip);
+    }
+    Index(id, connection, client_ip);
+}
+
+bool RTSPSessionTable::TryInsert(uint64_t id, std::shared_ptr<RTSPSession> session, int connection,
+                                 const std::string &client_ip)
+{
+    Shard &shard = ShardOf(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto result = shard.sessions.try_emplace(id, Slot{std::move(session), connection, client_ip});
+    if (!result.second) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> indexLock(indexMutex_);
+    Index(id, connection, client_ip);
+    return true;
+}
+
+std::shared_ptr<RTSPSession> RTSPSessionTable::Find(uint64_t id) const
+{
+    const Shard &shard = ShardOf(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(id);
+    return it != shard.sessions.end() ? it->second.session : nullptr;
+}
+
+std::shared_ptr<RTSPSession> RTSPSessionTable::Remove(uint64_t id)
+{
+    Slot removed;
+    {
+        Shard &shard = ShardOf(id);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(id);
+        if (it == shard.sessions.end()) {
+            return nullptr;
+        }
+        removed = std::move(it->second);
+        shard.sessions.erase(it);
+
+        std::lock_guard<std::mutex> indexLock(indexMutex_);
+        Unindex(id, removed.connection, removed.client_ip);
+    }
+    // The session is released outside the locks
+    return removed.session;
+}
+
+std::vector<std::shared_ptr<RTSPSession>> RTSPSessionTable::RemoveConnection(int connection)
+{
+    std::vector<uint64_t> ids;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        auto it = byConnection_.find(connection);
+        if (it == byConnection_.end()) {
+            return {};
+        }
+        ids = it->second;
+    }
+    return RemoveIds(ids);
+}
+
+std::vector<std::shared_ptr<RTSPSession>> RTSPSessionTable::RemoveClient(const std::string &client_ip)
+{
+    std::vector<uint64_t> ids;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex_);
+        auto it = byClient_.find(client_ip);
+        if (it == byClient_.end()) {
+            return {};
+        }
+        ids = it->second;
+    }
+    return RemoveIds(ids);
+}
+
+std::vector<std::shared_ptr<RTSPSession>> RTSPSessionTable::RemoveIds(const std::vector<uint64_t> &ids)
+{
+    std::vector<std::shared_ptr<RTSPSession>> removed;
+    removed.reserve(ids.size());
+    for (uint64_t id : ids) {
+        if (auto session = Remove(id)) {
+            removed.push_back(std::move(session));
+        }
+    }
+    return removed;
+}
+
+void RTSPSessionTable::ForEach(
+    const std::function<void(uint64_t id, const std::shared_ptr<RTSPSession> &session)> &func) const
+{
+    for (const Shard &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto &pair : shard.sessions) {
+            func(pair.first, pair.second.session);
+        }
+    }
+}
+
+std::vector<std::string> RTSPSessionTable::Clients() const
+{
+    std::lock_guard<std::mutex> lock(indexMutex_);
+    std::vector<std::string> clients;
+    clients.reserve(byClient_.size());
+    for (const auto &pair : byClient_) {
+        if (pair.first.empty()) {
+            continue;
+        }
+        clients.insert(clients.end(), pair.second.size(), pair.first);
+    }
+    return clients;
+}
+
+size_t RTSPSessionTable::CountClient(const std::string &client_ip) const
+{
+    std::lock_guard<std::mutex> lock(indexMutex_);
+    auto it = byClient_.find(client_ip);
+    return it != byClient_.end() ? it->second.size() : 0;
+}
+
+size_t RTSPSessionTable::Size() const
+{
+    size_t size = 0;
+    for (const Shard &shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        size += shard.sessions.size();
+    }
+    return size;
+}
+
+void RTSPSessionTable::Clear()
+{
+    for (Shard &shard : shards_) {
+        std::unordered_map<uint64_t, Slot> sessions;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            sessions.swap(shard.sessions);
+            std::lock_guard<std::mutex> indexLock(indexMutex_);
+            for (const auto &pair : sessions) {
+                Unindex(pair.first, pair.second.connection, pair.second.client_ip);
+            }
+        }
+        // Sessions are destroyed outside the lock
+    }
+}
+
+void RTSPSessionTable::Index(uint64_t id, int connection, const std::string &client_ip)
+{
+    byConnection_[connection].push_back(id);
+    byClient_[client_ip].push_back(id);
+}
+
+void RTSPSessionTable::Unindex(uint64_t id, int connection, const std::string &client_ip)
+{
+    EraseId(byConnection_, connection, id);
+    EraseId(byClient_, client_ip, id);
+}
+
+} // namespace lmshao::lmrtsp
@@ -0,0 +1,80 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_RTSP_SESSION_TABLE_H
+#define LMSHAO_LMRTSP_RTSP_SESSION_TABLE_H
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lmshao::lmrtsp {
+
+class RTSPSession;
+
+// Sessions keyed by their numeric id, spread over independently locked shards.
+// Secondary indexes map the control connection (fd) and the client IP to the sessions they own, so closing a
+// connection or disconnecting a client touches only those sessions.
+class RTSPSessionTable {
+public:
+    static constexpr size_t kShardCount = 16;
+
+    // Replaces a session already stored under id
+    void Insert(uint64_t id, std::shared_ptr<RTSPSession> session, int connection, const std::string &client_ip);
+    // Leaves a session already stored under id alone and returns false
+    bool TryInsert(uint64_t id, std::shared_ptr<RTSPSession> session, int connection, const std::string &client_ip);
+    std::shared_ptr<RTSPSession> Find(uint64_t id) const;
+    std::shared_ptr<RTSPSession> Remove(uint64_t id);
+
+    // Remove and return every session of a connection or client
+    std::vector<std::shared_ptr<RTSPSession>> RemoveConnection(int connection);
+    std::vector<std::shared_ptr<RTSPSession>> RemoveClient(const std::string &client_ip);
+
+    // Visit every session, one shard locked at a time
+    void ForEach(const std::function<void(uint64_t id, const std::shared_ptr<RTSPSession> &session)> &func) const;
+    std::vector<std::string> Clients() const;
+    size_t CountClient(const std::string &client_ip) const;
+    size_t Size() const;
+    void Clear();
+
+private:
+    struct Slot {
+        std::shared_ptr<RTSPSession> session;
+        int connection = -1;
+        std::string client_ip;
+    };
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, Slot> sessions;
+    };
+
+    Shard &ShardOf(uint64_t id) { return shards_[id % kShardCount]; }
+    const Shard &ShardOf(uint64_t id) const { return shards_[id % kShardCount]; }
+
+    // Add id to or drop it from both indexes; the shard's mutex and indexMutex_ must be held
+    void Index(uint64_t id, int connection, const std::string &client_ip);
+    void Unindex(uint64_t id, int connection, const std::string &client_ip);
+    std::vector<std::shared_ptr<RTSPSession>> RemoveIds(const std::vector<uint64_t> &ids);
+
+    std::array<Shard, kShardCount> shards_;
+
+    // Always locked inside a shard's mutex, never the other way round, so an id is either in its shard and both
+    // indexes or in none of them
+    mutable std::mutex indexMutex_;
+    std::unordered_map<int, std::vector<uint64_t>> byConnection_;
+    std::unordered_map<std::string, std::vector<uint64_t>> byClient_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_RTSP_SESSION_TABLE_H
@@ -0,0 +1,285 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "rtsp_transport.h"
+
+#include <charconv>
+
+namespace lmshao::lmrtsp {
+
+namespace {
+
+std::string_view Trim(std::string_view str)
+{
+    size_t start = str.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    size_t end = str.find_last_not_of(" \t");
+    return str.substr(start, end - start + 1);
+}
+
+template <typename T>
+bool ParseNumber(std::string_view str, T &value, int base = 10)
+{
+    const char *last = str.data() + str.size();
+    auto result = std::from_chars(str.data(), last, value, base);
+    return !str.empty() && result.ec == std::errc() && result.ptr == last;
+}
+
+// "a-b" or "a"; a single value implies b = a + 1
+template <typename T>
+bool ParseRange(std::string_view str, T &first, T &second)
+{
+    size_t dash = str.find('-');
+    if (dash == std::string_view::npos) {
+        if (!ParseNumber(str, first) || first == static_cast<T>(~T(0))) {
+            return false;
+        }
+        second = static_cast<T>(first + 1);
+        return true;
+    }
+    return ParseNumber(str.substr(0, dash), first) && ParseNumber(str.substr(dash + 1), second);
+}
+
+// transport-protocol/profile[/lower-transport]
+bool ParseProtocol(std::string_view token, TransportSpec &spec)
+{
+    if (token.substr(0, 4) != "RTP/") {
+        return false;
+    }
+    token.remove_prefix(4);
+    size_t slash = token.find('/');
+    std::string_view profile = token.substr(0, slash);
+    std::string_view lower = slash == std::string_view::npos ? std::string_view() : token.substr(slash + 1);
+
+    if (profile == "AVP") {
+        spec.profile = TransportProfile::AVP;
+    } else if (profile == "AVPF") {
+        spec.profile = TransportProfile::AVPF;
+    } else if (profile == "SAVP") {
+        spec.profile = TransportProfile::SAVP;
+    } else if (profile == "SAVPF") {
+        spec.profile = TransportProfile::SAVPF;
+    } else {
+        return false;
+    }
+
+    if (lower.empty() || lower == "UDP") {
+        spec.lower_transport = LowerTransport::UDP;
+    } else if (lower == "TCP") {
+        spec.lower_transport = LowerTransport::TCP;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseParameter(std::string_view param, TransportSpec &spec)
+{
+    size_t equals = param.find('=');
+    std::string_view name = Trim(param.substr(0, equals));
+    std::string_view value = equals == std::string_view::npos ? std::string_view() : Trim(param.substr(equals + 1));
+
+    if (name == "unicast") {
+        spec.unicast = true;
+    } else if (name == "multicast") {
+        spec.unicast = false;
+    } else if (name == "destination") {
+        spec.destination = value;
+    } else if (name == "client_port") {
+        return ParseRange(value, spec.client_rtp_port, spec.client_rtcp_port);
+    } else if (name == "port") {
+        return ParseRange(value, spec.multicast_rtp_port, spec.multicast_rtcp_port);
+    } else if (name == "interleaved") {
+        spec.interleaved = true;
+        return ParseRange(value, spec.rtp_channel, spec.rtcp_channel);
+    } else if (name == "ttl") {
+        return ParseNumber(value, spec.ttl);
+    } else if (name == "ssrc") {
+        spec.has_ssrc = ParseNumber(value, spec.ssrc, 16);
+        return spec.has_ssrc;
+    } else if (name == "mode") {
+        if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+            value = value.substr(1, value.size() - 2);
+        }
+        spec.mode = value;
+    }
+    // Other parameters (append, layers, server_port...) do not affect negotiation
+    return true;
+}
+
+bool ParseSpec(std::string_view text, TransportSpec &spec)
+{
+    spec = TransportSpec();
+    size_t start = 0;
+    bool first = true;
+    while (start <= text.size()) {
+        size_t end = text.find(';', start);
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+        std::string_view token = Trim(text.substr(start, end - start));
+        if (first) {
+            if (!ParseProtocol(token, spec)) {
+                return false;
+            }
+            first = false;
+        } else if (!token.empty() && !ParseParameter(token, spec)) {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+int TransportCost(const TransportSpec &spec)
+{
+    if (!spec.unicast) {
+        return 0; // One copy on the wire however many clients watch
+    }
+    return spec.lower_transport == LowerTransport::UDP ? 1 : 2;
+}
+
+bool IsSupported(const TransportSpec &spec, const TransportSupport &support)
+{
+    bool secure = spec.profile == TransportProfile::SAVP || spec.profile == TransportProfile::SAVPF;
+    if (secure && !support.secure) {
+        return false;
+    }
+    if (spec.lower_transport == LowerTransport::TCP) {
+        // Multicast has no meaning over a TCP connection
+        return support.tcp && spec.unicast;
+    }
+    if (!spec.unicast) {
+        return support.multicast;
+    }
+    return support.udp && spec.client_rtp_port != 0;
+}
+
+std::string_view ProfileName(TransportProfile profile)
+{
+    switch (profile) {
+        case TransportProfile::AVPF:
+            return "RTP/AVPF";
+        case TransportProfile::SAVP:
+            return "RTP/SAVP";
+        case TransportProfile::SAVPF:
+            return "RTP/SAVPF";
+        default:
+            return "RTP/AVP";
+    }
+}
+
+void AppendNumber(std::string &out, uint32_t value, int base = 10)
+{
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, base);
+    out.append(digits, result.ptr);
+}
+
+void AppendRange(std::string &out, std::string_view name, uint32_t first, uint32_t second)
+{
+    out.append(";").append(name).append("=");
+    AppendNumber(out, first);
+    out.append("-");
+    AppendNumber(out, second);
+}
+
+} // namespace
+
+bool ParseTransport(std::string_view header, TransportOffer &offer)
+{
+    offer.count = 0;
+    size_t start = 0;
+    while (start < header.size() && offer.count < TransportOffer::kMaxSpecs) {
+        size_t end = header.find(',', start);
+        if (end == std::string_view::npos) {
+            end = header.size();
+        }
+        if (ParseSpec(header.substr(start, end - start), offer.specs[offer.count])) {
+            offer.count++;
+        }
+        start = end + 1;
+    }
+    return offer.count > 0;
+}
+
+const TransportSpec *SelectTransport(const TransportOffer &offer, const TransportSupport &support)
+{
+    const TransportSpec *best = nullptr;
+    for (size_t i = 0; i < offer.count; ++i) {
+        const TransportSpec &spec = offer.specs[i];
+        if (IsSupported(spec, support) && (!best || TransportCost(spec) < TransportCost(*best))) {
+            best = &spec;
+        }
+    }
+    return best;
+}
+
+void ApplyTransport(const TransportSpec &spec, const MulticastGroup &group, RTPTransportParams &params)
+{
+    params.transport_mode.assign(ProfileName(spec.profile));
+    params.transport_mode.append(spec.lower_transport == LowerTransport::TCP ? "/TCP" : "/UDP");
+    params.unicast = spec.unicast;
+    params.interleaved = spec.interleaved;
+    params.rtp_channel = spec.rtp_channel;
+    params.rtcp_channel = spec.rtcp_channel;
+    if (spec.unicast) {
+        params.client_rtp_port = spec.client_rtp_port;
+        params.client_rtcp_port = spec.client_rtcp_port;
+        params.multicast_ip.clear();
+        if (spec.ttl != 0) {
+            params.ttl = spec.ttl;
+        }
+    } else {
+        params.client_rtp_port = group.rtp_port;
+        params.client_rtcp_port = group.rtcp_port;
+        params.multicast_ip.assign(group.address);
+        if (group.ttl != 0) {
+            params.ttl = group.ttl;
+        }
+    }
+    if (spec.has_ssrc) {
+        params.ssrc = spec.ssrc;
+    }
+}
+
+void AppendTransport(std::string &out, const TransportSpec &spec, const MulticastGroup &group)
+{
+    out.append(ProfileName(spec.profile));
+    if (spec.lower_transport == LowerTransport::TCP) {
+        out.append("/TCP");
+    }
+    out.append(spec.unicast ? ";unicast" : ";multicast");
+    std::string_view destination = spec.unicast ? spec.destination : group.address;
+    if (!destination.empty()) {
+        out.append(";destination=").append(destination);
+    }
+    if (spec.interleaved) {
+        AppendRange(out, "interleaved", spec.rtp_channel, spec.rtcp_channel);
+    } else if (spec.unicast) {
+        AppendRange(out, "client_port", spec.client_rtp_port, spec.client_rtcp_port);
+    } else if (group.rtp_port != 0) {
+        AppendRange(out, "port", group.rtp_port, group.rtcp_port);
+    }
+    uint8_t ttl = spec.unicast ? spec.ttl : group.ttl;
+    if (ttl != 0) {
+        out.append(";ttl=");
+        AppendNumber(out, ttl);
+    }
+    if (spec.has_ssrc) {
+        out.append(";ssrc=");
+        AppendNumber(out, spec.ssrc, 16);
+    }
+    if (!spec.mode.empty()) {
+        out.append(";mode=").append(spec.mode);
+    }
+}
+
+} // namespace lmshao::lmrtsp
@@ -48,4 +48,73 @@ std::vector<std::string> RTSPUtils::split(const std::string &str, const std::str
     return tokens;
 }
 
+bool RTSPUtils::parseClientPorts(std::string_view transport, uint16_t &rtpPort, uint16_t &rtcpPort)
+{
+    constexpr std::string_view key = "client_port=";
+    size_t portStart = transport.find(key);
+    if (portStart == std::string_view::npos) {
+        return false;
+    }
+    portStart += key.size();
+    size_t portEnd = transport.find(';', portStart);
+    if (portEnd == std::string_view::npos) {
+        portEnd = transport.size();
+    }
+    std::string_view portRange = transport.substr(portStart, portEnd - portStart);
+
+    size_t dashPos = portRange.find('-');
+    if (dashPos == std::string_view::npos) {
+        return false;
+    }
+    uint16_t rtp = 0;
+    uint16_t rtcp = 0;
+    if (!parseNumber(portRange.substr(0, dashPos), rtp) || !parseNumber(portRange.substr(dashPos + 1), rtcp)) {
+        return false;
+    }
+    rtpPort = rtp;
+    rtcpPort = rtcp;
+    return true;
+}
+
+std::string_view RTSPUtils::sessionId(std::string_view session)
+{
+    session = session.substr(0, session.find(';'));
+    size_t start = session.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    size_t end = session.find_last_not_of(" \t");
+    return session.substr(start, end - start + 1);
+}
+
+std::string_view RTSPUtils::urlPath(std::string_view uri)
+{
+    if (uri.substr(0, 7) != "rtsp://") {
+        return uri;
+    }
+    size_t pathStart = uri.find('/', 7);
+    return pathStart == std::string_view::npos ? uri : uri.substr(pathStart);
+}
+
+uint32_t RTSPUtils::sessionTimeout(std::string_view session)
+{
+    // session-id *( ";" parameter ), timeout being the only parameter defined
+    size_t next = session.find(';');
+    while (next != std::string_view::npos) {
+        session.remove_prefix(next + 1);
+        next = session.find(';');
+        std::string_view param = session.substr(0, next);
+        size_t start = param.find_first_not_of(" \t");
+        if (start == std::string_view::npos) {
+            continue;
+        }
+        param = param.substr(start, param.find_last_not_of(" \t") - start + 1);
+        if (param.substr(0, 8) == "timeout=") {
+            uint32_t timeout = 0;
+            return parseNumber(param.substr(8), timeout) ? timeout : 0;
+        }
+    }
+    return 0;
+}
+
 } // namespace lmshao::lmrtsp
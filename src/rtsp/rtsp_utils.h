@@ -9,7 +9,10 @@
 #ifndef LMSHAO_LMRTSP_RTSP_UTILS_H
 #define LMSHAO_LMRTSP_RTSP_UTILS_H
 
+#include <charconv>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace lmshao::lmrtsp {
@@ -41,6 +44,50 @@ public:
      */
     static std::vector<std::string> split(const std::string &str, const std::string &delimiter);
 
+    /**
+     * @brief Parse an unsigned decimal number without throwing
+     * @param str Digits only, surrounding whitespace is not accepted
+     * @param value Receives the number, untouched on failure
+     * @return False on empty input, trailing garbage or overflow
+     */
+    template <typename T>
+    static bool parseNumber(std::string_view str, T &value)
+    {
+        const char *last = str.data() + str.size();
+        auto result = std::from_chars(str.data(), last, value);
+        return !str.empty() && str[0] != '-' && result.ec == std::errc() && result.ptr == last;
+    }
+
+    /**
+     * @brief Extract the client_port=rtp-rtcp pair of a Transport header
+     * @param transport Transport header value
+     * @param rtpPort Receives the RTP port
+     * @param rtcpPort Receives the RTCP port
+     * @return False if the parameter is missing or malformed
+     */
+    static bool parseClientPorts(std::string_view transport, uint16_t &rtpPort, uint16_t &rtcpPort);
+
+    /**
+     * @brief Session identifier of a Session header, without the ;timeout parameter
+     * @param session Session header value
+     * @return View into session
+     */
+    static std::string_view sessionId(std::string_view session);
+
+    /**
+     * @brief Path of an absolute rtsp:// URL, e.g. "/live" for rtsp://host:554/live
+     * @param uri Request URI
+     * @return View into uri, uri itself if it is not an absolute URL
+     */
+    static std::string_view urlPath(std::string_view uri);
+
+    /**
+     * @brief Value of the ;timeout= parameter of a Session header
+     * @param session Session header value
+     * @return Timeout in seconds, 0 if absent or malformed
+     */
+    static uint32_t sessionTimeout(std::string_view session);
+
 private:
     // Prevent instantiation
     RTSPUtils() = delete;
@@ -0,0 +1,154 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "session_id.h"
+
+#include <array>
+#include <random>
+
+namespace lmshao::lmrtsp {
+
+namespace {
+
+inline uint32_t Rotl(uint32_t v, int n)
+{
+    return (v << n) | (v >> (32 - n));
+}
+
+inline void QuarterRound(uint32_t *x, int a, int b, int c, int d)
+{
+    x[a] += x[b];
+    x[d] = Rotl(x[d] ^ x[a], 16);
+    x[c] += x[d];
+    x[b] = Rotl(x[b] ^ x[c], 12);
+    x[a] += x[b];
+    x[d] = Rotl(x[d] ^ x[a], 8);
+    x[c] += x[d];
+    x[b] = Rotl(x[b] ^ x[c], 7);
+}
+
+// ChaCha20 keystream generator with fast key erasure: half of every block becomes the next key and is never
+// handed out, the other half is output. Once drawn, earlier outputs cannot be recovered from the state.
+class ChaChaGenerator {
+public:
+    ChaChaGenerator()
+    {
+        std::random_device entropy;
+        for (auto &word : key_) {
+            word = entropy();
+        }
+    }
+
+    uint64_t Next()
+    {
+        if (available_ == 0) {
+            Refill();
+        }
+        return output_[--available_];
+    }
+
+private:
+    static constexpr size_t kOutputs = 4;
+
+    void Refill()
+    {
+        // "expand 32-byte k", key, 64-bit block counter, zero nonce
+        std::array<uint32_t, 16> input = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+        for (size_t i = 0; i < key_.size(); ++i) {
+            input[4 + i] = key_[i];
+        }
+        input[12] = static_cast<uint32_t>(counter_);
+        input[13] = static_cast<uint32_t>(counter_ >> 32);
+        ++counter_;
+
+        std::array<uint32_t, 16> x = input;
+        for (int round = 0; round < 10; ++round) {
+            QuarterRound(x.data(), 0, 4, 8, 12);
+            QuarterRound(x.data(), 1, 5, 9, 13);
+            QuarterRound(x.data(), 2, 6, 10, 14);
+            QuarterRound(x.data(), 3, 7, 11, 15);
+            QuarterRound(x.data(), 0, 5, 10, 15);
+            QuarterRound(x.data(), 1, 6, 11, 12);
+            QuarterRound(x.data(), 2, 7, 8, 13);
+            QuarterRound(x.data(), 3, 4, 9, 14);
+        }
+        for (size_t i = 0; i < x.size(); ++i) {
+            x[i] += input[i];
+        }
+
+        for (size_t i = 0; i < key_.size(); ++i) {
+            key_[i] = x[i];
+        }
+        for (size_t i = 0; i < kOutputs; ++i) {
+            output_[i] = static_cast<uint64_t>(x[8 + 2 * i]) << 32 | x[9 + 2 * i];
+        }
+        available_ = kOutputs;
+    }
+
+    std::array<uint32_t, 8> key_{};
+    uint64_t counter_ = 0;
+    std::array<uint64_t, kOutputs> output_{};
+    size_t available_ = 0;
+};
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+inline int HexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = static_cast<char>(c | 0x20);
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+} // namespace
+
+uint64_t SessionId::Generate()
+{
+    thread_local ChaChaGenerator generator;
+    uint64_t key = 0;
+    while (key == 0) {
+        key = generator.Next();
+    }
+    return key;
+}
+
+std::string SessionId::Format(uint64_t key)
+{
+    std::string text(kLength, '0');
+    for (size_t i = kLength; i-- > 0; key >>= 4) {
+        text[i] = kHexDigits[key & 0xf];
+    }
+    return text;
+}
+
+bool SessionId::Parse(std::string_view text, uint64_t &key)
+{
+    if (text.size() != kLength) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (char c : text) {
+        int digit = HexValue(c);
+        if (digit < 0) {
+            return false;
+        }
+        value = value << 4 | static_cast<uint64_t>(digit);
+    }
+    if (value == 0) {
+        return false;
+    }
+    key = value;
+    return true;
+}
+
+} // namespace lmshao::lmrtsp
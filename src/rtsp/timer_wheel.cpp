@@ -0,0 +1,101 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "timer_wheel.h"
+
+namespace lmshao::lmrtsp {
+
+void TimerWheel::Reset(uint64_t now)
+{
+    for (auto &level : levels_) {
+        for (auto &slot : level) {
+            slot.clear();
+        }
+    }
+    counts_.fill(0);
+    size_ = 0;
+    current_ = now;
+}
+
+void TimerWheel::Schedule(uint64_t id, uint64_t deadline)
+{
+    if (deadline <= current_) {
+        deadline = current_ + 1;
+    } else if (deadline - current_ > kMaxDelay) {
+        deadline = current_ + kMaxDelay;
+    }
+    Place({id, deadline});
+    size_++;
+}
+
+void TimerWheel::Place(const Timer &timer)
+{
+    // Coarsest level whose slot for the deadline comes round no later than the deadline
+    uint64_t delay = timer.deadline - current_;
+    size_t level = 0;
+    while (level + 1 < kLevels && delay >= (1ULL << (kSlotBits * (level + 1)))) {
+        level++;
+    }
+    size_t slot = (timer.deadline >> (kSlotBits * level)) & (kSlots - 1);
+    levels_[level][slot].push_back(timer);
+    counts_[level]++;
+}
+
+void TimerWheel::Cascade(size_t level, std::vector<uint64_t> &expired)
+{
+    Slot timers;
+    timers.swap(levels_[level][(current_ >> (kSlotBits * level)) & (kSlots - 1)]);
+    counts_[level] -= timers.size();
+    for (const Timer &timer : timers) {
+        if (timer.deadline <= current_) {
+            expired.push_back(timer.id);
+            size_--;
+        } else {
+            Place(timer);
+        }
+    }
+}
+
+void TimerWheel::Advance(uint64_t now, std::vector<uint64_t> &expired)
+{
+    if (size_ == 0) {
+        current_ = now > current_ ? now : current_;
+        return;
+    }
+
+    while (current_ < now && size_ > 0) {
+        // With the lower levels empty nothing happens before the next slot of the lowest used level
+        size_t lowest = 0;
+        while (counts_[lowest] == 0) {
+            lowest++;
+        }
+        if (lowest > 0) {
+            uint64_t idle = current_ | ((1ULL << (kSlotBits * lowest)) - 1);
+            if (idle >= now) {
+                break;
+            }
+            current_ = idle;
+        }
+
+        current_++;
+        // Higher levels come due when all the lower-level bits wrap to zero
+        size_t top = 0;
+        while (top + 1 < kLevels && (current_ & ((1ULL << (kSlotBits * (top + 1))) - 1)) == 0) {
+            top++;
+        }
+        for (size_t level = top; level > 0; --level) {
+            Cascade(level, expired);
+        }
+        Cascade(0, expired);
+    }
+    if (current_ < now) {
+        current_ = now;
+    }
+}
+
+} // namespace lmshao::lmrtsp
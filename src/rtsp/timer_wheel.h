@@ -0,0 +1,63 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef LMSHAO_LMRTSP_TIMER_WHEEL_H
+#define LMSHAO_LMRTSP_TIMER_WHEEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lmshao::lmrtsp {
+
+// Hierarchical timer wheel over abstract ticks.
+// Scheduling is O(1); a timer lives in the coarsest level that still resolves its deadline and moves down one
+// level each time that slot comes round. Timers are never cancelled: owners whose deadline moved simply
+// re-schedule when the old one fires, which keeps refreshing a deadline free of any wheel operation.
+class TimerWheel {
+public:
+    static constexpr size_t kLevels = 4;
+    static constexpr size_t kSlotBits = 6;
+    static constexpr size_t kSlots = 1 << kSlotBits;
+    // Deadlines further away are clamped and re-scheduled when they fire
+    static constexpr uint64_t kMaxDelay = (1ULL << (kSlotBits * kLevels)) - 1;
+
+    explicit TimerWheel(uint64_t now = 0) : current_(now) {}
+
+    // Forget all timers and restart at now
+    void Reset(uint64_t now);
+
+    // A deadline that already passed fires on the next tick
+    void Schedule(uint64_t id, uint64_t deadline);
+
+    // Move to now, appending the ids of timers whose deadline was reached
+    void Advance(uint64_t now, std::vector<uint64_t> &expired);
+
+    uint64_t Now() const { return current_; }
+    size_t Size() const { return size_; }
+
+private:
+    struct Timer {
+        uint64_t id;
+        uint64_t deadline;
+    };
+    using Slot = std::vector<Timer>;
+
+    void Place(const Timer &timer);
+    void Cascade(size_t level, std::vector<uint64_t> &expired);
+
+    uint64_t current_;
+    size_t size_ = 0;
+    std::array<size_t, kLevels> counts_{}; // Timers per level
+    std::array<std::array<Slot, kSlots>, kLevels> levels_;
+};
+
+} // namespace lmshao::lmrtsp
+
+#endif // LMSHAO_LMRTSP_TIMER_WHEEL_H
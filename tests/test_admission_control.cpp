@@ -0,0 +1,106 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "lmrtsp/rtsp_response.h"
+#include "rtsp/admission_control.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+void test_admission_unlimited()
+{
+    AdmissionControl admission;
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_TRUE(admission.AdmitConnection(0));
+    }
+    ASSERT_EQ(1000u, admission.Connections());
+    ASSERT_TRUE(admission.AdmitSession(1000));
+    ASSERT_TRUE(admission.AdmitPlay(1000));
+    ASSERT_EQ(0u, admission.Refused());
+}
+
+void test_admission_connections()
+{
+    AdmissionControl admission;
+    AdmissionLimits limits;
+    limits.max_connections = 2;
+    admission.SetLimits(limits);
+
+    ASSERT_TRUE(admission.AdmitConnection(0));
+    ASSERT_TRUE(admission.AdmitConnection(0));
+    ASSERT_FALSE(admission.AdmitConnection(0));
+    ASSERT_EQ(2u, admission.Connections());
+
+    admission.ReleaseConnection();
+    ASSERT_TRUE(admission.AdmitConnection(0));
+    ASSERT_EQ(1u, admission.Refused());
+}
+
+void test_admission_accept_rate()
+{
+    AdmissionControl admission;
+    AdmissionLimits limits;
+    limits.max_accepts_per_second = 10;
+    admission.SetLimits(limits);
+
+    // A full second's worth right away, then one per 100 ms
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(admission.AdmitConnection(5000));
+    }
+    ASSERT_FALSE(admission.AdmitConnection(5000));
+    ASSERT_FALSE(admission.AdmitConnection(5099));
+    ASSERT_TRUE(admission.AdmitConnection(5100));
+    ASSERT_FALSE(admission.AdmitConnection(5150));
+
+    // The bucket never holds more than one second
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(admission.AdmitConnection(60000));
+    }
+    ASSERT_FALSE(admission.AdmitConnection(60000));
+    ASSERT_EQ(4u, admission.Refused());
+}
+
+void test_admission_sessions_and_players()
+{
+    AdmissionControl admission;
+    AdmissionLimits limits;
+    limits.max_sessions_per_client = 4;
+    limits.max_playing_per_stream = 100;
+    limits.retry_after_seconds = 30;
+    admission.SetLimits(limits);
+
+    ASSERT_TRUE(admission.AdmitSession(3));
+    ASSERT_FALSE(admission.AdmitSession(4));
+    ASSERT_TRUE(admission.AdmitPlay(99));
+    ASSERT_FALSE(admission.AdmitPlay(100));
+    ASSERT_EQ(30u, admission.RetryAfter());
+}
+
+void test_service_unavailable_response()
+{
+    auto response = RTSPResponseFactory::CreateServiceUnavailable(7, 30).Build();
+    std::string text = response.ToString();
+    ASSERT_TRUE(text.find("RTSP/1.0 503 Service Unavailable\r\n") == 0);
+    ASSERT_TRUE(text.find("CSeq: 7\r\n") != std::string::npos);
+    ASSERT_TRUE(text.find("Retry-After: 30\r\n") != std::string::npos);
+}
+
+int main()
+{
+    TestSuite suite("Admission Control Tests");
+
+    suite.AddTest("Unlimited", test_admission_unlimited);
+    suite.AddTest("Connection Limit", test_admission_connections);
+    suite.AddTest("Accept Rate", test_admission_accept_rate);
+    suite.AddTest("Sessions And Players", test_admission_sessions_and_players);
+    suite.AddTest("Service Unavailable Response", test_service_unavailable_response);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,196 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lmrtsp/rtsp_continuation.h"
+#include "rtsp/callback_dispatcher.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+// Executor that only runs tasks when told to
+struct ManualExecutor {
+    std::vector<CallbackDispatcher::Task> tasks;
+
+    CallbackDispatcher::Executor Get()
+    {
+        return [this](CallbackDispatcher::Task task) { tasks.push_back(std::move(task)); };
+    }
+
+    size_t RunAll()
+    {
+        size_t ran = 0;
+        while (!tasks.empty()) {
+            auto pending = std::move(tasks);
+            tasks.clear();
+            for (auto &task : pending) {
+                task();
+                ++ran;
+            }
+        }
+        return ran;
+    }
+};
+
+void test_dispatcher_order_and_single_drain()
+{
+    ManualExecutor executor;
+    auto dispatcher = std::make_shared<CallbackDispatcher>(executor.Get(), 16);
+
+    std::vector<int> order;
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(dispatcher->Post([&order, i] { order.push_back(i); }));
+    }
+    // One drain for the whole burst
+    ASSERT_EQ(1u, executor.tasks.size());
+    ASSERT_EQ(10u, dispatcher->Pending());
+
+    executor.RunAll();
+    ASSERT_EQ(10u, order.size());
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(i, order[i]);
+    }
+    ASSERT_EQ(0u, dispatcher->Pending());
+
+    // Posting after the queue went idle schedules a new drain
+    ASSERT_TRUE(dispatcher->Post([] {}));
+    ASSERT_EQ(1u, executor.tasks.size());
+    executor.RunAll();
+}
+
+void test_dispatcher_bounded()
+{
+    ManualExecutor executor;
+    auto dispatcher = std::make_shared<CallbackDispatcher>(executor.Get(), 2);
+
+    int ran = 0;
+    ASSERT_TRUE(dispatcher->Post([&ran] { ++ran; }));
+    ASSERT_TRUE(dispatcher->Post([&ran] { ++ran; }));
+    ASSERT_FALSE(dispatcher->Post([&ran] { ++ran; }));
+    executor.RunAll();
+    ASSERT_EQ(2, ran);
+    ASSERT_TRUE(dispatcher->Post([&ran] { ++ran; }));
+    executor.RunAll();
+    ASSERT_EQ(3, ran);
+}
+
+void test_dispatcher_batches()
+{
+    ManualExecutor executor;
+    const size_t total = CallbackDispatcher::kDrainBatch * 2 + 1;
+    auto dispatcher = std::make_shared<CallbackDispatcher>(executor.Get(), total);
+
+    size_t ran = 0;
+    for (size_t i = 0; i < total; ++i) {
+        dispatcher->Post([&ran] { ++ran; });
+    }
+    // A drain yields the executor after each batch
+    ASSERT_EQ(3u, executor.RunAll());
+    ASSERT_EQ(total, ran);
+}
+
+void test_dispatcher_producers()
+{
+    // Executor that runs the drain on a thread of its own
+    std::vector<std::thread> drains;
+    std::mutex drainsMutex;
+    auto dispatcher = std::make_shared<CallbackDispatcher>(
+        [&](CallbackDispatcher::Task task) {
+            std::lock_guard<std::mutex> lock(drainsMutex);
+            drains.emplace_back(std::move(task));
+        },
+        100000);
+
+    std::atomic<int> ran{0};
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                dispatcher->Post([&] {
+                    if (running.fetch_add(1) != 0) {
+                        overlapped = true;
+                    }
+                    ++ran;
+                    running.fetch_sub(1);
+                });
+            }
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    while (dispatcher->Pending() > 0) {
+        std::this_thread::yield();
+    }
+    for (size_t i = 0;; ++i) {
+        std::thread drain;
+        {
+            std::lock_guard<std::mutex> lock(drainsMutex);
+            if (i == drains.size()) {
+                break;
+            }
+            drain = std::move(drains[i]);
+        }
+        drain.join();
+    }
+    ASSERT_EQ(4000, ran.load());
+    ASSERT_FALSE(overlapped.load());
+}
+
+void test_continuation()
+{
+    int result = -1;
+    int calls = 0;
+    auto completion = [&](int status_code) {
+        result = status_code;
+        ++calls;
+    };
+
+    {
+        RTSPContinuation continuation(completion);
+        continuation.Resume();
+        continuation.Reject(404);
+        ASSERT_TRUE(continuation.IsDone());
+    }
+    ASSERT_EQ(0, result);
+    ASSERT_EQ(1, calls);
+
+    {
+        RTSPContinuation continuation(completion);
+        continuation.Reject(503);
+    }
+    ASSERT_EQ(503, result);
+    ASSERT_EQ(2, calls);
+
+    // Released without an answer
+    { RTSPContinuation continuation(completion); }
+    ASSERT_EQ(500, result);
+    ASSERT_EQ(3, calls);
+}
+
+int main()
+{
+    TestSuite suite("Callback Dispatcher Tests");
+
+    suite.AddTest("Order And Single Drain", test_dispatcher_order_and_single_drain);
+    suite.AddTest("Bounded Queue", test_dispatcher_bounded);
+    suite.AddTest("Drain Batches", test_dispatcher_batches);
+    suite.AddTest("Concurrent Producers", test_dispatcher_producers);
+    suite.AddTest("Continuation", test_continuation);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <thread>
+#include <vector>
+
+#include "rtsp/egress_budget.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+void test_egress_unlimited()
+{
+    EgressBudget budget;
+    ASSERT_TRUE(budget.Reserve(1000000000));
+    ASSERT_TRUE(budget.Consume(1 << 30, 0));
+    ASSERT_EQ(0u, budget.DroppedBytes());
+}
+
+void test_egress_reservations()
+{
+    EgressBudget budget;
+    budget.SetCapacity(10000000); // 10 Mbit/s
+
+    // Two 4 Mbit/s viewers fit, the third does not
+    ASSERT_TRUE(budget.Reserve(4000000));
+    ASSERT_TRUE(budget.Reserve(4000000));
+    ASSERT_FALSE(budget.Reserve(4000000));
+    ASSERT_TRUE(budget.Reserve(2000000));
+    ASSERT_EQ(10000000u, budget.Reserved());
+    ASSERT_FALSE(budget.Reserve(1));
+    ASSERT_FALSE(budget.Reserve(20000000));
+
+    budget.Release(4000000);
+    ASSERT_TRUE(budget.Reserve(4000000));
+    budget.Release(100000000);
+    ASSERT_EQ(0u, budget.Reserved());
+}
+
+void test_egress_concurrent_reservations()
+{
+    EgressBudget budget;
+    budget.SetCapacity(1000);
+
+    std::vector<std::thread> threads;
+    std::vector<int> granted(8, 0);
+    for (size_t t = 0; t < granted.size(); ++t) {
+        threads.emplace_back([&budget, &granted, t] {
+            for (int i = 0; i < 1000; ++i) {
+                if (budget.Reserve(1)) {
+                    ++granted[t];
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    int total = 0;
+    for (int count : granted) {
+        total += count;
+    }
+    ASSERT_EQ(1000, total);
+    ASSERT_EQ(1000u, budget.Reserved());
+}
+
+void test_egress_token_bucket()
+{
+    EgressBudget budget;
+    budget.SetCapacity(8000000); // 1 MB/s, bursts of 200 KB
+
+    const uint64_t start = 1000000;
+    ASSERT_TRUE(budget.Consume(150000, start));
+    ASSERT_TRUE(budget.Consume(100000, start)); // Goes into debt
+    ASSERT_FALSE(budget.Consume(1000, start));
+    ASSERT_EQ(1000u, budget.DroppedBytes());
+
+    // 50 ms repay the 50 KB debt, one more byte of credit is needed
+    ASSERT_FALSE(budget.Consume(1000, start + 50000));
+    ASSERT_TRUE(budget.Consume(1000, start + 51000));
+
+    // Credit never exceeds the burst, however long the link was idle
+    ASSERT_TRUE(budget.Consume(200000, start + 10000000));
+    ASSERT_FALSE(budget.Consume(1, start + 10000000));
+}
+
+int main()
+{
+    TestSuite suite("Egress Budget Tests");
+
+    suite.AddTest("Unlimited", test_egress_unlimited);
+    suite.AddTest("Reservations", test_egress_reservations);
+    suite.AddTest("Concurrent Reservations", test_egress_concurrent_reservations);
+    suite.AddTest("Token Bucket", test_egress_token_bucket);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "lmrtp/fec_encoder.h"
+#include "rtp/xor_kernel.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtp;
+
+namespace {
+
+constexpr uint32_t kMediaSsrc = 0x22222222;
+constexpr uint32_t kFecSsrc = 0x33333333;
+
+std::vector<uint8_t> BuildRtpPacket(uint16_t seq, size_t payload_size)
+{
+    std::vector<uint8_t> packet = {0x80, 96, static_cast<uint8_t>(seq >> 8), static_cast<uint8_t>(seq)};
+    uint32_t timestamp = 90000 + seq * 3000;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        packet.push_back(static_cast<uint8_t>(timestamp >> shift));
+    }
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        packet.push_back(static_cast<uint8_t>(kMediaSsrc >> shift));
+    }
+    for (size_t i = 0; i < payload_size; ++i) {
+        packet.push_back(static_cast<uint8_t>(seq * 31 + i));
+    }
+    return packet;
+}
+
+uint16_t ReadU16(const uint8_t *p)
+{
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+FecConfig MakeConfig(FecScheme scheme, uint8_t columns, uint8_t rows)
+{
+    FecConfig config;
+    config.scheme = scheme;
+    config.payload_type = 110;
+    config.ssrc = kFecSsrc;
+    config.columns = columns;
+    config.rows = rows;
+    return config;
+}
+
+// Copies the FEC packets completed by packet
+std::vector<std::vector<uint8_t>> AddPacket(FecEncoder &encoder, const std::vector<uint8_t> &packet)
+{
+    std::vector<std::vector<uint8_t>> fec;
+    size_t count = encoder.AddPacket(packet.data(), packet.size(), [&fec](const uint8_t *data, size_t size) {
+        fec.emplace_back(data, data + size);
+    });
+    return count == fec.size() ? fec : std::vector<std::vector<uint8_t>>();
+}
+
+} // namespace
+
+void test_fec_row_recovery()
+{
+    FecEncoder encoder(MakeConfig(FecScheme::FLEXFEC, 4, 1));
+
+    std::vector<std::vector<uint8_t>> source;
+    std::vector<std::vector<uint8_t>> fec;
+    for (uint16_t seq = 1000; seq < 1004; ++seq) {
+        source.push_back(BuildRtpPacket(seq, 100 + seq % 7 * 10));
+        auto out = AddPacket(encoder, source.back());
+        fec.insert(fec.end(), out.begin(), out.end());
+    }
+    ASSERT_EQ(1u, fec.size());
+
+    const uint8_t *repair = fec[0].data();
+    ASSERT_EQ(0x81, repair[0]); // One CSRC naming the protected stream
+    ASSERT_EQ(110, repair[1]);
+    ASSERT_EQ(1000, ReadU16(repair + 24));
+    ASSERT_EQ(0xF800, ReadU16(repair + 26)); // k bit plus offsets 0-3
+
+    // Rebuild packet 1002 from the parity and the three packets that arrived
+    const uint8_t *header = repair + 16;
+    size_t recoveredLength = ReadU16(header + 2);
+    std::vector<uint8_t> recovered(fec[0].begin() + 28, fec[0].end());
+    for (size_t i = 0; i < source.size(); ++i) {
+        if (i == 2) {
+            continue;
+        }
+        recoveredLength ^= source[i].size() - 12;
+        for (size_t j = 12; j < source[i].size(); ++j) {
+            recovered[j - 12] ^= source[i][j];
+        }
+    }
+    ASSERT_EQ(source[2].size() - 12, recoveredLength);
+    recovered.resize(recoveredLength);
+    ASSERT_TRUE(std::vector<uint8_t>(source[2].begin() + 12, source[2].end()) == recovered);
+}
+
+void test_fec_column_mask()
+{
+    FecEncoder encoder(MakeConfig(FecScheme::FLEXFEC, 5, 4));
+
+    std::vector<std::vector<uint8_t>> fec;
+    for (uint16_t seq = 0; seq < 20; ++seq) {
+        auto packet = BuildRtpPacket(seq, 50);
+        auto out = AddPacket(encoder, packet);
+        fec.insert(fec.end(), out.begin(), out.end());
+    }
+    // Four row parity packets plus five column parity packets
+    ASSERT_EQ(9u, fec.size());
+
+    // First column covers offsets 0, 5, 10 and 15, which needs the second mask chunk
+    const uint8_t *column = fec[4].data() + 16;
+    ASSERT_EQ(0, ReadU16(column + 8));
+    ASSERT_EQ(0x4210, ReadU16(column + 10)); // k=0, offsets 0, 5 and 10
+    ASSERT_EQ(0xC000, ReadU16(column + 12)); // k=1, offset 15
+}
+
+void test_ulpfec_header()
+{
+    FecEncoder encoder(MakeConfig(FecScheme::ULPFEC, 3, 1));
+
+    std::vector<std::vector<uint8_t>> fec;
+    for (uint16_t seq = 65534; seq != 1; ++seq) {
+        auto packet = BuildRtpPacket(seq, 40);
+        auto out = AddPacket(encoder, packet);
+        fec.insert(fec.end(), out.begin(), out.end());
+    }
+    ASSERT_EQ(1u, fec.size());
+
+    const uint8_t *header = fec[0].data() + 12;
+    ASSERT_EQ(0x80, fec[0][0]);
+    ASSERT_EQ(65534, ReadU16(header + 2));
+    ASSERT_EQ(40, ReadU16(header + 8));  // Length recovery
+    ASSERT_EQ(40, ReadU16(header + 10)); // Protection length
+    ASSERT_EQ(0xE000, ReadU16(header + 12));
+    ASSERT_EQ(12u + 14u + 40u, fec[0].size());
+}
+
+void test_fec_sequence_gap()
+{
+    FecEncoder encoder(MakeConfig(FecScheme::FLEXFEC, 4, 1));
+
+    size_t fecCount = 0;
+    for (uint16_t seq : {10, 11, 20, 21, 22, 23}) {
+        auto packet = BuildRtpPacket(seq, 30);
+        fecCount += AddPacket(encoder, packet).size();
+    }
+    // The block restarts at 20, so only 20-23 are protected
+    ASSERT_EQ(1u, fecCount);
+}
+
+void test_fec_buffers_reused()
+{
+    FecEncoder encoder(MakeConfig(FecScheme::FLEXFEC, 2, 1));
+
+    // Every row parity packet is built in the same encoder-owned buffer
+    std::vector<const uint8_t *> starts;
+    for (uint16_t seq = 0; seq < 6; ++seq) {
+        auto packet = BuildRtpPacket(seq, 80);
+        encoder.AddPacket(packet.data(), packet.size(),
+                          [&starts](const uint8_t *data, size_t) { starts.push_back(data); });
+    }
+    ASSERT_EQ(3u, starts.size());
+    ASSERT_TRUE(starts[0] == starts[1]);
+    ASSERT_TRUE(starts[1] == starts[2]);
+}
+
+void test_xor_kernel()
+{
+    // Sizes around the 8, 16 and 32 byte steps of every kernel
+    for (size_t size : {0u, 1u, 7u, 8u, 15u, 16u, 31u, 32u, 33u, 63u, 100u, 1400u}) {
+        std::vector<uint8_t> dst(size);
+        std::vector<uint8_t> src(size);
+        std::vector<uint8_t> expected(size);
+        for (size_t i = 0; i < size; ++i) {
+            dst[i] = static_cast<uint8_t>(i * 7 + 3);
+            src[i] = static_cast<uint8_t>(i * 13 + 5);
+            expected[i] = dst[i] ^ src[i];
+        }
+        XorInto(dst.data(), src.data(), size);
+        ASSERT_TRUE(dst == expected);
+    }
+    ASSERT_TRUE(XorKernelName() != nullptr);
+}
+
+int main()
+{
+    TestSuite suite("FEC Encoder Tests");
+
+    suite.AddTest("FlexFEC Row Recovery", test_fec_row_recovery);
+    suite.AddTest("FlexFEC Column Mask", test_fec_column_mask);
+    suite.AddTest("ULPFEC Header", test_ulpfec_header);
+    suite.AddTest("Sequence Gap", test_fec_sequence_gap);
+    suite.AddTest("Buffers Reused", test_fec_buffers_reused);
+    suite.AddTest("XOR Kernel", test_xor_kernel);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
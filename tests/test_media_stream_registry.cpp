@@ -0,0 +1,210 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lmrtsp/media_stream_registry.h"
+#include "lmrtsp/rtsp_session.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+
+std::shared_ptr<MediaStreamInfo> MakeStream(const std::string &path)
+{
+    auto info = std::make_shared<MediaStreamInfo>();
+    info->stream_path = path;
+    info->media_type = "video";
+    info->codec = "H264";
+    return info;
+}
+
+MediaStreamRegistry::Batch MakeBatch(const std::string &prefix, size_t first, size_t count)
+{
+    MediaStreamRegistry::Batch batch;
+    batch.reserve(count);
+    for (size_t i = first; i < first + count; ++i) {
+        std::string path = prefix + std::to_string(i);
+        batch.emplace_back(path, MakeStream(path));
+    }
+    return batch;
+}
+
+// Average lookup time over all registered "/cam" paths
+double LookupNanoseconds(const MediaStreamRegistry &registry, size_t streams)
+{
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < streams; i += streams / 100) {
+        paths.push_back("/cam" + std::to_string(i));
+    }
+    const int rounds = 200;
+    size_t found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r) {
+        for (const auto &path : paths) {
+            found += registry.Find(path) != nullptr;
+        }
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    ASSERT_EQ(paths.size() * rounds, found);
+    return elapsed / static_cast<double>(paths.size() * rounds);
+}
+
+} // namespace
+
+void test_registry_add_find_remove()
+{
+    MediaStreamRegistry registry;
+    ASSERT_EQ(0u, registry.Size());
+    ASSERT_TRUE(registry.Find("/live") == nullptr);
+
+    registry.Add("/live", MakeStream("/live"));
+    registry.Add("/audio", MakeStream("/audio"));
+    auto entry = registry.Find("/live");
+    ASSERT_TRUE(entry != nullptr);
+    ASSERT_STR_EQ("/live", entry->info->stream_path);
+
+    auto paths = registry.Paths();
+    ASSERT_EQ(2u, paths.size());
+    ASSERT_STR_EQ("/audio", paths[0]);
+
+    ASSERT_TRUE(registry.Remove("/live"));
+    ASSERT_FALSE(registry.Remove("/live"));
+    ASSERT_TRUE(registry.Find("/live") == nullptr);
+    ASSERT_EQ(1u, registry.Size());
+}
+
+void test_registry_sdp_cache()
+{
+    MediaStreamRegistry registry;
+    registry.Add("/live", MakeStream("/live"));
+    auto entry = registry.Find("/live");
+    ASSERT_TRUE(entry->GetSDP() == nullptr);
+
+    auto sdp = std::make_shared<MediaStreamRegistry::Entry::CachedSDP>();
+    sdp->server_port = 554;
+    sdp->text = "m=video 554 RTP/AVP 96\r\n";
+    entry->SetSDP(sdp);
+    ASSERT_EQ(554, registry.Find("/live")->GetSDP()->server_port);
+
+    // Other writes keep the entry and its cache
+    registry.Add("/other", MakeStream("/other"));
+    ASSERT_TRUE(registry.Find("/live")->GetSDP() != nullptr);
+
+    // Replacing the stream starts without a cached SDP
+    registry.Add("/live", MakeStream("/live"));
+    ASSERT_TRUE(registry.Find("/live")->GetSDP() == nullptr);
+    ASSERT_TRUE(entry->GetSDP() != nullptr);
+
+    entry->InvalidateSDP();
+    ASSERT_TRUE(entry->GetSDP() == nullptr);
+}
+
+void test_registry_batch_and_snapshot()
+{
+    MediaStreamRegistry registry;
+    registry.Update(MakeBatch("/cam", 0, 100), {});
+    auto before = registry.Snapshot();
+
+    ASSERT_EQ(2u, registry.Update(MakeBatch("/new", 0, 10), {"/cam0", "/cam1", "/missing"}));
+    ASSERT_EQ(108u, registry.Size());
+    ASSERT_EQ(0u, registry.Update({}, {"/missing"}));
+
+    // A snapshot taken earlier is unaffected by later writes
+    ASSERT_EQ(100u, before->size());
+    ASSERT_EQ(1u, before->count("/cam0"));
+}
+
+void test_registry_subscribers()
+{
+    MediaStreamRegistry registry;
+    registry.Add("/live", MakeStream("/live"));
+    auto entry = registry.Find("/live");
+    ASSERT_TRUE(entry->GetSubscribers() == nullptr);
+
+    auto viewer = std::make_shared<RTSPSession>(nullptr);
+    auto other = std::make_shared<RTSPSession>(nullptr);
+    ASSERT_TRUE(entry->Subscribe(viewer));
+    ASSERT_FALSE(entry->Subscribe(viewer));
+    ASSERT_TRUE(entry->Subscribe(other));
+
+    // Publishers keep iterating the list they loaded while it changes
+    auto published = entry->GetSubscribers();
+    ASSERT_TRUE(entry->Unsubscribe(viewer.get()));
+    ASSERT_FALSE(entry->Unsubscribe(viewer.get()));
+    ASSERT_EQ(2u, published->size());
+    ASSERT_EQ(1u, entry->GetSubscribers()->size());
+
+    // Re-registering the stream keeps its viewers
+    registry.Add("/live", MakeStream("/live"));
+    ASSERT_EQ(1u, registry.Find("/live")->GetSubscribers()->size());
+
+    // Sessions that went away are dropped with the next change
+    other.reset();
+    ASSERT_TRUE(registry.Find("/live")->Subscribe(viewer));
+    ASSERT_EQ(1u, registry.Find("/live")->GetSubscribers()->size());
+}
+
+void test_registry_lookup_under_churn()
+{
+    const size_t small = 1000;
+    const size_t large = 50000;
+
+    MediaStreamRegistry smallRegistry;
+    smallRegistry.Update(MakeBatch("/cam", 0, small), {});
+    MediaStreamRegistry registry;
+    registry.Update(MakeBatch("/cam", 0, large), {});
+
+    // Control plane registers and unregisters camera paths in batches while lookups run
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        size_t next = 0;
+        while (!stop.load()) {
+            auto batch = MakeBatch("/churn", next, 100);
+            std::vector<std::string> removed;
+            if (next >= 100) {
+                for (size_t i = next - 100; i < next; ++i) {
+                    removed.push_back("/churn" + std::to_string(i));
+                }
+            }
+            registry.Update(batch, removed);
+            next += 100;
+        }
+    });
+
+    double smallNs = LookupNanoseconds(smallRegistry, small);
+    double largeNs = LookupNanoseconds(registry, large);
+    stop = true;
+    writer.join();
+
+    std::cout << "    Lookup: " << smallNs << " ns with " << small << " streams, " << largeNs << " ns with " << large
+              << " streams under churn" << std::endl;
+    // The writer keeps at most one batch of churn paths registered
+    ASSERT_TRUE(registry.Size() == large || registry.Size() == large + 100);
+}
+
+int main()
+{
+    TestSuite suite("Media Stream Registry Tests");
+
+    suite.AddTest("Add Find Remove", test_registry_add_find_remove);
+    suite.AddTest("SDP Cache", test_registry_sdp_cache);
+    suite.AddTest("Batch And Snapshot", test_registry_batch_and_snapshot);
+    suite.AddTest("Subscribers", test_registry_subscribers);
+    suite.AddTest("Lookup Under Churn", test_registry_lookup_under_churn);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "rtsp/resource_reclaimer.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+void test_reclaimer_inline_when_stopped()
+{
+    ResourceReclaimer reclaimer;
+    bool ran = false;
+    reclaimer.Post([&ran] { ran = true; });
+    ASSERT_TRUE(ran);
+}
+
+void test_reclaimer_background()
+{
+    ResourceReclaimer reclaimer;
+    reclaimer.Start();
+
+    // A slow release must not hold up the poster
+    std::atomic<bool> release{false};
+    std::thread::id worker;
+    std::vector<int> order;
+    auto start = std::chrono::steady_clock::now();
+    reclaimer.Post([&] {
+        worker = std::this_thread::get_id();
+        while (!release.load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        order.push_back(1);
+    });
+    reclaimer.Post([&order] { order.push_back(2); });
+    ASSERT_TRUE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500));
+
+    release = true;
+    reclaimer.Stop();
+    ASSERT_TRUE(worker != std::this_thread::get_id());
+    ASSERT_EQ(2u, order.size());
+    ASSERT_EQ(1, order[0]);
+    ASSERT_EQ(2, order[1]);
+    ASSERT_EQ(0u, reclaimer.Pending());
+}
+
+void test_reclaimer_destroys_captures_off_thread()
+{
+    struct Resource {
+        std::thread::id *destroyedOn;
+        ~Resource() { *destroyedOn = std::this_thread::get_id(); }
+    };
+
+    std::thread::id destroyedOn;
+    ResourceReclaimer reclaimer;
+    reclaimer.Start();
+    {
+        auto resource = std::make_shared<Resource>();
+        resource->destroyedOn = &destroyedOn;
+        reclaimer.Post([resource = std::move(resource)] {});
+    }
+    reclaimer.Stop();
+    ASSERT_TRUE(destroyedOn != std::thread::id());
+    ASSERT_TRUE(destroyedOn != std::this_thread::get_id());
+}
+
+int main()
+{
+    TestSuite suite("Resource Reclaimer Tests");
+
+    suite.AddTest("Inline When Stopped", test_reclaimer_inline_when_stopped);
+    suite.AddTest("Background Release", test_reclaimer_background);
+    suite.AddTest("Captures Destroyed Off Thread", test_reclaimer_destroys_captures_off_thread);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,344 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "lmrtp/rtcp_packet.h"
+#include "lmrtp/rtp_packet_history.h"
+#include "lmrtp/rtp_sequence.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtp;
+
+namespace {
+
+void AppendU32(std::vector<uint8_t> &buf, uint32_t value)
+{
+    buf.push_back(static_cast<uint8_t>(value >> 24));
+    buf.push_back(static_cast<uint8_t>(value >> 16));
+    buf.push_back(static_cast<uint8_t>(value >> 8));
+    buf.push_back(static_cast<uint8_t>(value));
+}
+
+void AppendHeader(std::vector<uint8_t> &buf, uint8_t count, uint8_t type, uint16_t length_words)
+{
+    buf.push_back(static_cast<uint8_t>(0x80 | count));
+    buf.push_back(type);
+    buf.push_back(static_cast<uint8_t>(length_words >> 8));
+    buf.push_back(static_cast<uint8_t>(length_words));
+}
+
+// RR from 0x11111111 reporting on 0x22222222, followed by SDES CNAME and BYE
+std::vector<uint8_t> BuildCompound()
+{
+    std::vector<uint8_t> buf;
+    AppendHeader(buf, 1, 201, 7);
+    AppendU32(buf, 0x11111111);
+    AppendU32(buf, 0x22222222);
+    AppendU32(buf, (64u << 24) | 0xFFFFFE); // 25% lost, cumulative -2
+    AppendU32(buf, 0x00010064);
+    AppendU32(buf, 120);
+    AppendU32(buf, 0x12345678);
+    AppendU32(buf, 0x00008000);
+
+    // SDES: ssrc + CNAME "abc" + end, padded to 12 bytes
+    AppendHeader(buf, 1, 202, 3);
+    AppendU32(buf, 0x11111111);
+    buf.insert(buf.end(), {1, 3, 'a', 'b', 'c', 0, 0, 0});
+
+    AppendHeader(buf, 1, 203, 1);
+    AppendU32(buf, 0x11111111);
+    return buf;
+}
+
+class RecordingListener : public IRtcpListener {
+public:
+    void OnSenderReport(const RtcpReport &report) override
+    {
+        sender_reports++;
+        last_report = report;
+    }
+    void OnReceiverReport(const RtcpReport &report) override
+    {
+        receiver_reports++;
+        last_report = report;
+    }
+    void OnSourceDescription(uint32_t ssrc, const char *cname, size_t cname_length) override
+    {
+        this->cname.assign(cname, cname_length);
+    }
+    void OnBye(uint32_t ssrc) override { bye_ssrc = ssrc; }
+    void OnNack(const RtcpNack &nack) override { nacks.push_back(nack); }
+    void OnPictureLoss(uint32_t sender_ssrc, uint32_t media_ssrc) override { pli_ssrc = media_ssrc; }
+    void OnFullIntraRequest(uint32_t sender_ssrc, uint32_t media_ssrc, uint8_t sequence) override
+    {
+        fir_ssrc = media_ssrc;
+        fir_sequence = sequence;
+    }
+
+    int sender_reports = 0;
+    int receiver_reports = 0;
+    RtcpReport last_report;
+    std::string cname;
+    uint32_t bye_ssrc = 0;
+    std::vector<RtcpNack> nacks;
+    uint32_t pli_ssrc = 0;
+    uint32_t fir_ssrc = 0;
+    uint8_t fir_sequence = 0;
+};
+
+std::vector<uint8_t> BuildRtpPacket(uint16_t seq, uint8_t fill)
+{
+    std::vector<uint8_t> packet = {0x80, 0xE0, static_cast<uint8_t>(seq >> 8), static_cast<uint8_t>(seq)};
+    AppendU32(packet, 1000);
+    AppendU32(packet, 0x22222222);
+    packet.insert(packet.end(), 100, fill);
+    return packet;
+}
+
+} // namespace
+
+void test_rtcp_is_rtcp()
+{
+    auto buf = BuildCompound();
+    ASSERT_TRUE(RtcpParser::IsRtcp(buf.data(), buf.size()));
+
+    uint8_t rtp[12] = {0x80, 96, 0, 1};
+    ASSERT_FALSE(RtcpParser::IsRtcp(rtp, sizeof(rtp)));
+}
+
+void test_rtcp_parse_compound()
+{
+    auto buf = BuildCompound();
+    RecordingListener listener;
+    ASSERT_TRUE(RtcpParser::Parse(buf.data(), buf.size(), &listener));
+
+    ASSERT_EQ(1, listener.receiver_reports);
+    ASSERT_EQ(0x11111111u, listener.last_report.ssrc);
+    ASSERT_EQ(1, listener.last_report.report_count);
+
+    const RtcpReportBlock &block = listener.last_report.report_blocks[0];
+    ASSERT_EQ(0x22222222u, block.ssrc);
+    ASSERT_EQ(64, block.fraction_lost);
+    ASSERT_EQ(-2, block.cumulative_lost);
+    ASSERT_EQ(0x00010064u, block.extended_highest_seq);
+    ASSERT_EQ(120u, block.jitter);
+    ASSERT_EQ(0x12345678u, block.lsr);
+    ASSERT_EQ(0x00008000u, block.dlsr);
+
+    ASSERT_STR_EQ("abc", listener.cname);
+    ASSERT_EQ(0x11111111u, listener.bye_ssrc);
+}
+
+void test_rtcp_parse_truncated()
+{
+    auto buf = BuildCompound();
+    RecordingListener listener;
+
+    // Cut in the middle of the report block
+    ASSERT_FALSE(RtcpParser::Parse(buf.data(), 20, &listener));
+    ASSERT_EQ(0, listener.receiver_reports);
+
+    // Wrong version
+    buf[0] = 0x41;
+    ASSERT_FALSE(RtcpParser::Parse(buf.data(), buf.size(), &listener));
+}
+
+void test_rtcp_parse_nack()
+{
+    std::vector<uint8_t> buf;
+    AppendHeader(buf, kRtcpFmtGenericNack, 205, 4);
+    AppendU32(buf, 0x11111111);
+    AppendU32(buf, 0x22222222);
+    AppendU32(buf, (100u << 16) | 0x0005);
+    AppendU32(buf, (65535u << 16) | 0x0000);
+
+    RecordingListener listener;
+    ASSERT_TRUE(RtcpParser::Parse(buf.data(), buf.size(), &listener));
+    ASSERT_EQ(2u, listener.nacks.size());
+    ASSERT_EQ(0x11111111u, listener.nacks[0].sender_ssrc);
+    ASSERT_EQ(0x22222222u, listener.nacks[0].media_ssrc);
+    ASSERT_EQ(100, listener.nacks[0].pid);
+    ASSERT_EQ(0x0005, listener.nacks[0].blp);
+    ASSERT_EQ(65535, listener.nacks[1].pid);
+}
+
+void test_rtcp_parse_keyframe_requests()
+{
+    std::vector<uint8_t> buf;
+    AppendHeader(buf, kRtcpFmtPli, 206, 2);
+    AppendU32(buf, 0x11111111);
+    AppendU32(buf, 0x22222222);
+    AppendHeader(buf, kRtcpFmtFir, 206, 4);
+    AppendU32(buf, 0x11111111);
+    AppendU32(buf, 0);
+    AppendU32(buf, 0x33333333);
+    AppendU32(buf, 7u << 24);
+
+    RecordingListener listener;
+    ASSERT_TRUE(RtcpParser::Parse(buf.data(), buf.size(), &listener));
+    ASSERT_EQ(0x22222222u, listener.pli_ssrc);
+    ASSERT_EQ(0x33333333u, listener.fir_ssrc);
+    ASSERT_EQ(7, listener.fir_sequence);
+}
+
+void test_rtp_packet_history()
+{
+    RtpPacketHistory history(1000000, 500);
+    ASSERT_TRUE(history.Capacity() >= 64);
+    ASSERT_EQ(0u, history.Capacity() & (history.Capacity() - 1));
+
+    auto packet = BuildRtpPacket(65535, 0xAB);
+    history.Put(packet.data(), packet.size(), 1000);
+
+    uint8_t out[RtpPacketHistory::kMaxPacketSize];
+    ASSERT_EQ(packet.size(), history.GetForResend(65535, 1010, 20, out));
+    ASSERT_EQ(0xAB, out[packet.size() - 1]);
+
+    // Resent too recently, then allowed again once the interval has passed
+    ASSERT_EQ(0u, history.GetForResend(65535, 1020, 20, out));
+    ASSERT_EQ(packet.size(), history.GetForResend(65535, 1030, 20, out));
+
+    // Never sent, and aged out of the history window
+    ASSERT_EQ(0u, history.GetForResend(0, 1030, 20, out));
+    ASSERT_EQ(0u, history.GetForResend(65535, 1600, 20, out));
+
+    // A newer packet in the same slot replaces the old one
+    auto newer = BuildRtpPacket(static_cast<uint16_t>(65535 + history.Capacity()), 0xCD);
+    history.Put(newer.data(), newer.size(), 1700);
+    ASSERT_EQ(0u, history.GetForResend(65535, 1700, 20, out));
+}
+
+void test_rtcp_build_compound()
+{
+    RtcpSenderInfo info;
+    info.ntp_msw = 0xE0000000;
+    info.ntp_lsw = 0x80000000;
+    info.rtp_timestamp = 123456;
+    info.packet_count = 42;
+    info.octet_count = 4200;
+
+    RtcpReportBlock block;
+    block.ssrc = 0x22222222;
+    block.fraction_lost = 12;
+    block.cumulative_lost = -0x900000; // Saturates to the 24-bit minimum
+    block.extended_highest_seq = 0x00020010;
+
+    uint8_t buffer[128];
+    RtcpBuilder builder(buffer, sizeof(buffer));
+    ASSERT_TRUE(builder.AddSenderReport(0x11111111, info, &block, 1));
+    ASSERT_TRUE(builder.AddSourceDescription(0x11111111, "lmrtsp", 6));
+    ASSERT_TRUE(builder.AddBye(0x11111111));
+    ASSERT_EQ(52u + 20u + 8u, builder.Size());
+
+    RecordingListener listener;
+    ASSERT_TRUE(RtcpParser::Parse(builder.Data(), builder.Size(), &listener));
+    ASSERT_EQ(1, listener.sender_reports);
+    ASSERT_TRUE(listener.last_report.has_sender_info);
+    ASSERT_EQ(123456u, listener.last_report.sender_info.rtp_timestamp);
+    ASSERT_EQ(4200u, listener.last_report.sender_info.octet_count);
+    ASSERT_EQ(-0x800000, listener.last_report.report_blocks[0].cumulative_lost);
+    ASSERT_EQ(0x00020010u, listener.last_report.report_blocks[0].extended_highest_seq);
+    ASSERT_STR_EQ("lmrtsp", listener.cname);
+    ASSERT_EQ(0x11111111u, listener.bye_ssrc);
+
+    // A packet that does not fit leaves the buffer untouched
+    RtcpBuilder small(buffer, 40);
+    ASSERT_FALSE(small.AddSenderReport(0x11111111, info, &block, 1));
+    ASSERT_EQ(0u, small.Size());
+}
+
+void test_rtcp_compound_reader()
+{
+    auto buf = BuildCompound();
+    RtcpCompoundReader reader(buf.data(), buf.size());
+    RtcpPacketView packet;
+
+    uint8_t types[3] = {};
+    size_t packets = 0;
+    while (reader.Next(packet) && packets < 3) {
+        types[packets++] = packet.packet_type;
+    }
+    ASSERT_EQ(3u, packets);
+    ASSERT_EQ(201, types[0]);
+    ASSERT_EQ(202, types[1]);
+    ASSERT_EQ(203, types[2]);
+    ASSERT_FALSE(reader.Error());
+
+    RtcpCompoundReader truncated(buf.data(), buf.size() - 2);
+    while (truncated.Next(packet)) {
+    }
+    ASSERT_TRUE(truncated.Error());
+}
+
+void test_rtp_sequence_helpers()
+{
+    ASSERT_TRUE(IsNewerSequence(1, 65535));
+    ASSERT_FALSE(IsNewerSequence(65535, 1));
+    ASSERT_FALSE(IsNewerSequence(7, 7));
+    ASSERT_EQ(4, SequenceDelta(2, 65534));
+    ASSERT_EQ(-4, SequenceDelta(65534, 2));
+    ASSERT_TRUE(IsNewerTimestamp(10, 0xFFFFFFF0U));
+    ASSERT_EQ(1000u, ExtrapolateTimestamp(1000, 0, 90000));
+    ASSERT_EQ(1000u + 4500u, ExtrapolateTimestamp(1000, 50000, 90000));
+    ASSERT_EQ(48000u * 3 + 4u, ExtrapolateTimestamp(4, 3000000, 48000));
+    ASSERT_EQ(0x10u, ExtrapolateTimestamp(0xFFFFFFF0U, 1, 32000000)); // Wraps like the RTP clock
+
+    SequenceUnwrapper unwrapper;
+    ASSERT_EQ(65534u, unwrapper.Unwrap(65534));
+    ASSERT_EQ(65537u, unwrapper.Unwrap(1));
+    ASSERT_EQ(65535u, unwrapper.Unwrap(65535)); // Late packet from the previous cycle
+    ASSERT_EQ(65538u, unwrapper.Unwrap(2));
+    ASSERT_EQ(65538u, unwrapper.ExtendedHighest());
+}
+
+void test_rtp_jitter()
+{
+    JitterEstimator estimator;
+    // Packets 3000 ticks apart arriving on time: no jitter
+    for (uint32_t i = 0; i < 10; ++i) {
+        estimator.Update(i * 3000, 50000 + i * 3000);
+    }
+    ASSERT_EQ(0u, estimator.Jitter());
+
+    // Alternating 160-tick early/late arrivals converge towards 160
+    for (uint32_t i = 10; i < 200; ++i) {
+        estimator.Update(i * 3000, 50000 + i * 3000 + (i % 2 ? 160 : 0));
+    }
+    ASSERT_TRUE(estimator.Jitter() >= 150 && estimator.Jitter() <= 160);
+}
+
+void test_rtcp_ntp_compact()
+{
+    uint64_t ntp = 0x0123456789ABCDEFULL;
+    ASSERT_EQ(0x456789ABu, NtpToCompact(ntp));
+    ASSERT_TRUE((NtpNow() >> 32) > 2208988800ULL);
+}
+
+int main()
+{
+    TestSuite suite("RTCP Packet Tests");
+
+    suite.AddTest("RTCP Demultiplexing", test_rtcp_is_rtcp);
+    suite.AddTest("Compound Parsing", test_rtcp_parse_compound);
+    suite.AddTest("Malformed Parsing", test_rtcp_parse_truncated);
+    suite.AddTest("Generic NACK Parsing", test_rtcp_parse_nack);
+    suite.AddTest("PLI/FIR Parsing", test_rtcp_parse_keyframe_requests);
+    suite.AddTest("RTP Packet History", test_rtp_packet_history);
+    suite.AddTest("Compound Building", test_rtcp_build_compound);
+    suite.AddTest("Compound Reader", test_rtcp_compound_reader);
+    suite.AddTest("Sequence Helpers", test_rtp_sequence_helpers);
+    suite.AddTest("Interarrival Jitter", test_rtp_jitter);
+    suite.AddTest("NTP Compact Format", test_rtcp_ntp_compact);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -6,9 +6,14 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <stdexcept>
 #include <string>
 
+#include "lmrtsp/rtsp_header_map.h"
 #include "lmrtsp/rtsp_request.h"
+#include "lmrtsp/rtsp_request_metrics.h"
+#include "lmrtsp/rtsp_request_parser.h"
+#include "lmrtsp/rtsp_transport.h"
 #include "test_framework.h"
 
 using namespace test_framework;
@@ -278,6 +283,269 @@ void test_rtsp_request_malformed_parsing()
     ASSERT_STR_EQ(minimal_request.version_, "RTSP/1.0");
 }
 
+void test_rtsp_request_parser_incremental()
+{
+    const std::string message = "SET_PARAMETER rtsp://example.com/stream RTSP/1.0\r\n"
+                                "cseq: 9\r\n"
+                                "content-length: 12\r\n"
+                                "\r\n"
+                                "volume: 0.5\n";
+
+    // Feed one byte at a time, the parser must only complete on the last one
+    RTSPRequestParser parser;
+    std::string buffer;
+    for (size_t i = 0; i < message.size(); ++i) {
+        buffer.push_back(message[i]);
+        auto status = parser.Parse(buffer);
+        if (i + 1 < message.size()) {
+            ASSERT_TRUE(status == RTSPRequestParser::Status::INCOMPLETE);
+        } else {
+            ASSERT_TRUE(status == RTSPRequestParser::Status::COMPLETE);
+        }
+    }
+
+    ASSERT_EQ(message.size(), parser.MessageSize());
+    const RTSPHeaderField *cseq = parser.Request().Find(HeaderId::CSEQ);
+    ASSERT_TRUE(cseq != nullptr);
+    ASSERT_TRUE(cseq->value == "9");
+
+    // Header names are matched case-insensitively and stored with their canonical spelling
+    RTSPRequest request = parser.ToRequest();
+    ASSERT_STR_EQ(request.method_, "SET_PARAMETER");
+    ASSERT_STR_EQ(request.general_header_.at("CSeq"), "9");
+    ASSERT_STR_EQ(request.entity_header_.at("Content-Length"), "12");
+    ASSERT_STR_EQ(*request.message_body_, "volume: 0.5\n");
+}
+
+void test_rtsp_request_parser_pipelined()
+{
+    const std::string data = "OPTIONS * RTSP/1.0\r\nCSeq: 1\r\n\r\n"
+                             "GET_PARAMETER rtsp://example.com/stream RTSP/1.0\r\nCSeq: 2\r\n\r\n";
+
+    RTSPRequestParser parser;
+    ASSERT_TRUE(parser.Parse(data) == RTSPRequestParser::Status::COMPLETE);
+    ASSERT_TRUE(parser.Request().method == "OPTIONS");
+    ASSERT_TRUE(parser.Request().method_id == RTSPMethod::OPTIONS);
+    size_t first = parser.MessageSize();
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse(std::string_view(data).substr(first)) == RTSPRequestParser::Status::COMPLETE);
+    ASSERT_TRUE(parser.Request().method == "GET_PARAMETER");
+    ASSERT_TRUE(parser.Request().method_id == RTSPMethod::GET_PARAMETER);
+    ASSERT_EQ(data.size(), first + parser.MessageSize());
+}
+
+void test_rtsp_request_parser_errors()
+{
+    RTSPRequestParser parser;
+    ASSERT_TRUE(parser.Parse("OPTIONS * RTSP/1.0\r\nContent-Length: 12abc\r\n\r\n") ==
+                RTSPRequestParser::Status::ERROR);
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("OPTIONS * HTTP/1.1\r\n") == RTSPRequestParser::Status::ERROR);
+
+    static_assert(LookupHeader("cseq") == HeaderId::CSEQ);
+    static_assert(LookupHeader("TRANSPORT") == HeaderId::TRANSPORT);
+    static_assert(LookupHeader("X-Custom") == HeaderId::UNKNOWN);
+    ASSERT_TRUE(HeaderName(HeaderId::CONTENT_LENGTH) == "Content-Length");
+}
+
+void test_rtsp_request_parser_limits()
+{
+    // A header section that never terminates is cut off at the limit
+    RTSPRequestParser parser;
+    parser.SetLimits(64, 16);
+    std::string slow = "OPTIONS * RTSP/1.0\r\nX-Pad: ";
+    ASSERT_TRUE(parser.Parse(slow) == RTSPRequestParser::Status::INCOMPLETE);
+    slow.append(64, 'a');
+    ASSERT_TRUE(parser.Parse(slow) == RTSPRequestParser::Status::TOO_LARGE);
+
+    // The declared body size is checked before any of it arrives
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("ANNOUNCE * RTSP/1.0\r\nContent-Length: 17\r\n\r\n") ==
+                RTSPRequestParser::Status::TOO_LARGE);
+
+    parser.Reset();
+    ASSERT_TRUE(parser.Parse("ANNOUNCE * RTSP/1.0\r\nContent-Length: 16\r\n\r\n0123456789abcdef") ==
+                RTSPRequestParser::Status::COMPLETE);
+}
+
+void test_rtsp_request_numeric_fields()
+{
+    RTSPRequest request = RTSPRequest::FromString("SETUP rtsp://example.com/stream/track1 RTSP/1.0\r\n"
+                                                  "CSeq: 42\r\n"
+                                                  "Session: 12345678;timeout=60\r\n"
+                                                  "Transport: RTP/AVP;unicast;client_port=8000-8001\r\n"
+                                                  "Content-Length: 0\r\n"
+                                                  "\r\n");
+    ASSERT_EQ(42, request.cseq_);
+    ASSERT_STR_EQ(request.session_id_, "12345678");
+    ASSERT_EQ(8000, request.client_rtp_port_);
+    ASSERT_EQ(8001, request.client_rtcp_port_);
+    ASSERT_EQ(0u, request.content_length_);
+
+    // Garbage is reported as absent instead of throwing
+    RTSPRequest garbage = RTSPRequest::FromString("PLAY * RTSP/1.0\r\n"
+                                                  "CSeq: 7x\r\n"
+                                                  "Transport: RTP/AVP;client_port=99999-1\r\n"
+                                                  "\r\n");
+    ASSERT_EQ(-1, garbage.cseq_);
+    ASSERT_EQ(0, garbage.client_rtp_port_);
+    ASSERT_STR_EQ(garbage.general_header_.at("CSeq"), "7x");
+
+    RTSPRequest built = RTSPRequestFactory::CreateSetup(3, "rtsp://example.com/stream")
+                            .SetTransport("RTP/AVP;unicast;client_port=5000-5001")
+                            .SetSession("abcdef")
+                            .Build();
+    ASSERT_EQ(3, built.cseq_);
+    ASSERT_STR_EQ(built.session_id_, "abcdef");
+    ASSERT_EQ(5000, built.client_rtp_port_);
+}
+
+void test_rtsp_header_map()
+{
+    HeaderMap headers;
+    headers["transport"] = "RTP/AVP;unicast";
+    headers["CSeq"] = "1";
+    headers["X-Custom"] = "a";
+
+    // Known names are case-insensitive and keep the canonical spelling, unknown ones compare as text
+    ASSERT_TRUE(headers.find("TRANSPORT") != headers.end());
+    ASSERT_STR_EQ(headers.find(HeaderId::TRANSPORT)->first, "Transport");
+    ASSERT_STR_EQ(headers.at("x-custom"), "a");
+    ASSERT_EQ(0u, headers.count("X-Other"));
+
+    headers["cseq"] = "2";
+    ASSERT_EQ(3u, headers.size());
+    ASSERT_STR_EQ(headers.at("CSeq"), "2");
+
+    // Growing past the inline entries keeps insertion order
+    for (size_t i = 0; i < HeaderMap::kInlineCapacity * 2; ++i) {
+        headers["X-Extra-" + std::to_string(i)] = std::to_string(i);
+    }
+    ASSERT_EQ(3u + HeaderMap::kInlineCapacity * 2, headers.size());
+    ASSERT_STR_EQ(headers.begin()->first, "Transport");
+    ASSERT_STR_EQ(headers.at("x-extra-15"), "15");
+
+    ASSERT_EQ(1u, headers.erase("CSEQ"));
+    ASSERT_TRUE(headers.find(HeaderId::CSEQ) == headers.end());
+    ASSERT_STR_EQ((headers.begin() + 1)->first, "X-Custom");
+
+    bool threw = false;
+    try {
+        headers.at("CSeq");
+    } catch (const std::out_of_range &) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
+    RTSPRequest request = RTSPRequest::FromString("SETUP rtsp://example.com/stream RTSP/1.0\r\n"
+                                                  "cseq: 3\r\n"
+                                                  "transport: RTP/AVP;unicast;client_port=8000-8001\r\n"
+                                                  "\r\n");
+    ASSERT_TRUE(request.general_header_.find(TRANSPORT) != request.general_header_.end());
+}
+
+void test_rtsp_request_method_id()
+{
+    static_assert(LookupMethod("GET_PARAMETER") == RTSPMethod::GET_PARAMETER);
+    static_assert(LookupMethod("options") == RTSPMethod::UNKNOWN); // Methods are case-sensitive
+    static_assert(MethodName(RTSPMethod::TEARDOWN) == "TEARDOWN");
+
+    RTSPRequest parsed = RTSPRequest::FromString("PAUSE rtsp://example.com/stream RTSP/1.0\r\nCSeq: 5\r\n\r\n");
+    ASSERT_TRUE(parsed.method_id_ == RTSPMethod::PAUSE);
+
+    RTSPRequest built = RTSPRequestFactory::CreateRecord(1, "rtsp://example.com/stream").Build();
+    ASSERT_TRUE(built.method_id_ == RTSPMethod::RECORD);
+
+    RTSPRequest custom = RTSPRequestBuilder().SetMethod("FOO").SetUri("*").Build();
+    ASSERT_TRUE(custom.method_id_ == RTSPMethod::UNKNOWN);
+}
+
+void test_rtsp_request_metrics()
+{
+    using std::chrono::microseconds;
+
+    ASSERT_EQ(0u, RTSPRequestMetrics::LatencyBucket(std::chrono::nanoseconds(500)));
+    ASSERT_EQ(1u, RTSPRequestMetrics::LatencyBucket(microseconds(1)));
+    ASSERT_EQ(11u, RTSPRequestMetrics::LatencyBucket(microseconds(1500)));
+    ASSERT_EQ(RTSPRequestMetrics::kLatencyBuckets - 1, RTSPRequestMetrics::LatencyBucket(std::chrono::seconds(10)));
+
+    RTSPRequestMetrics metrics;
+    metrics.Record(RTSPMethod::SETUP, microseconds(3));
+    metrics.Record(RTSPMethod::SETUP, microseconds(3));
+    metrics.Record(RTSPMethod::PLAY, microseconds(100));
+
+    auto setup = metrics.Get(RTSPMethod::SETUP);
+    ASSERT_EQ(2u, setup.count);
+    ASSERT_EQ(2u, setup.latency[2]);
+    ASSERT_EQ(1u, metrics.Get(RTSPMethod::PLAY).count);
+    ASSERT_EQ(0u, metrics.Get(RTSPMethod::OPTIONS).count);
+
+    metrics.Reset();
+    ASSERT_EQ(0u, metrics.Get(RTSPMethod::SETUP).count);
+}
+
+void test_rtsp_transport_negotiation()
+{
+    TransportOffer offer;
+    ASSERT_TRUE(ParseTransport("RTP/AVP/TCP;unicast;interleaved=0-1, RTP/AVP;unicast;client_port=4588-4589;ssrc=1A2B3C4D, "
+                               "RTP/AVP;multicast;destination=232.0.0.1;port=5000-5001;ttl=16",
+                               offer));
+    ASSERT_EQ(3u, offer.count);
+    ASSERT_TRUE(offer.specs[0].interleaved);
+    ASSERT_EQ(1, offer.specs[0].rtcp_channel);
+    ASSERT_EQ(4589, offer.specs[1].client_rtcp_port);
+    ASSERT_EQ(0x1A2B3C4Du, offer.specs[1].ssrc);
+    ASSERT_FALSE(offer.specs[2].unicast);
+    ASSERT_EQ(16, offer.specs[2].ttl);
+
+    // Unicast UDP beats TCP; multicast wins only when enabled
+    TransportSupport support;
+    ASSERT_TRUE(SelectTransport(offer, support) == &offer.specs[1]);
+    support.multicast = true;
+    ASSERT_TRUE(SelectTransport(offer, support) == &offer.specs[2]);
+    support = TransportSupport();
+    support.udp = false;
+    ASSERT_TRUE(SelectTransport(offer, support) == &offer.specs[0]);
+
+    RTPTransportParams params;
+    MulticastGroup group;
+    group.address = "239.1.2.3";
+    group.rtp_port = 6000;
+    group.rtcp_port = 6001;
+    group.ttl = 4;
+    ApplyTransport(offer.specs[0], group, params);
+    ASSERT_TRUE(params.interleaved);
+    ASSERT_STR_EQ("RTP/AVP/TCP", params.transport_mode);
+
+    // Multicast goes to the server's group whatever destination, port and ttl the client asked for
+    ApplyTransport(offer.specs[2], group, params);
+    ASSERT_STR_EQ("239.1.2.3", params.multicast_ip);
+    ASSERT_EQ(6000, params.client_rtp_port);
+    ASSERT_EQ(6001, params.client_rtcp_port);
+    ASSERT_EQ(4, params.ttl);
+
+    std::string text;
+    AppendTransport(text, offer.specs[1]);
+    ASSERT_STR_EQ("RTP/AVP;unicast;client_port=4588-4589;ssrc=1a2b3c4d", text);
+    text.clear();
+    AppendTransport(text, offer.specs[2], group);
+    ASSERT_STR_EQ("RTP/AVP;multicast;destination=239.1.2.3;port=6000-6001;ttl=4", text);
+
+    // Single port implies RTCP on the next one, quoted mode is unquoted
+    ASSERT_TRUE(ParseTransport("RTP/AVPF/UDP;client_port=7000;mode=\"PLAY\"", offer));
+    ASSERT_EQ(7001, offer.specs[0].client_rtcp_port);
+    ASSERT_STR_EQ("PLAY", std::string(offer.specs[0].mode));
+
+    // SRTP needs explicit support, malformed specs are dropped
+    ASSERT_TRUE(ParseTransport("RTP/SAVP;client_port=7000-7001", offer));
+    ASSERT_TRUE(SelectTransport(offer, TransportSupport()) == nullptr);
+    ASSERT_FALSE(ParseTransport("RAW/RAW/UDP;client_port=7000", offer));
+    ASSERT_FALSE(ParseTransport("RTP/AVP;client_port=abc", offer));
+    ASSERT_FALSE(ParseTransport("", offer));
+}
+
 int main()
 {
     TestSuite suite("RTSP Request Builder Tests");
@@ -297,6 +565,15 @@ int main()
     suite.AddTest("Full Request Parsing", test_rtsp_request_full_parsing);
     suite.AddTest("Round-trip Parsing", test_rtsp_request_roundtrip);
     suite.AddTest("Malformed Request Parsing", test_rtsp_request_malformed_parsing);
+    suite.AddTest("Incremental Parser", test_rtsp_request_parser_incremental);
+    suite.AddTest("Pipelined Parser", test_rtsp_request_parser_pipelined);
+    suite.AddTest("Parser Errors", test_rtsp_request_parser_errors);
+    suite.AddTest("Parser Limits", test_rtsp_request_parser_limits);
+    suite.AddTest("Numeric Fields", test_rtsp_request_numeric_fields);
+    suite.AddTest("Header Map", test_rtsp_header_map);
+    suite.AddTest("Method Id", test_rtsp_request_method_id);
+    suite.AddTest("Request Metrics", test_rtsp_request_metrics);
+    suite.AddTest("Transport Negotiation", test_rtsp_transport_negotiation);
 
     bool success = suite.RunAll();
     return success ? 0 : 1;
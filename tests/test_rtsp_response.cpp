@@ -6,9 +6,14 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <sstream>
 #include <string>
 
 #include "lmrtsp/rtsp_response.h"
+#include "rtsp/rtsp_canned_response.h"
 #include "test_framework.h"
 
 using namespace test_framework;
@@ -340,6 +345,109 @@ void test_rtsp_response_malformed_parsing()
     ASSERT_EQ(static_cast<int>(minimal_response.status_), 200);
 }
 
+namespace {
+
+// The ostringstream serializer WriteTo replaced, kept as the reference for the benchmark
+std::string LegacyToString(const RTSPResponse &response)
+{
+    std::ostringstream oss;
+    oss << response.version_ << SP << static_cast<uint16_t>(response.status_) << SP
+        << GetReasonPhrase(response.status_) << CRLF;
+    for (const auto &[k, v] : response.general_header_) {
+        oss << k << COLON << SP << v << CRLF;
+    }
+    if (!response.response_header_.public_methods_.empty()) {
+        oss << PUBLIC << COLON << SP;
+        for (size_t i = 0; i < response.response_header_.public_methods_.size(); ++i) {
+            oss << response.response_header_.public_methods_[i];
+            if (i + 1 < response.response_header_.public_methods_.size()) {
+                oss << COMMA << SP;
+            }
+        }
+        oss << CRLF;
+    }
+    if (response.response_header_.server_) {
+        oss << SERVER << COLON << SP << *response.response_header_.server_ << CRLF;
+    }
+    for (const auto &[k, v] : response.entity_header_) {
+        oss << k << COLON << SP << v << CRLF;
+    }
+    oss << CRLF;
+    if (response.message_body_) {
+        oss << *response.message_body_;
+    }
+    return oss.str();
+}
+
+} // namespace
+
+void test_rtsp_response_serializer_benchmark()
+{
+    auto response = RTSPResponseFactory::CreateDescribeOK(42)
+                        .SetServer("RTSP Server/1.0")
+                        .SetSession("12345678")
+                        .SetSdp("v=0\r\no=- 0 0 IN IP4 127.0.0.1\r\ns=Stream\r\nt=0 0\r\nm=video 0 RTP/AVP 96\r\n")
+                        .Build();
+    auto options = RTSPResponseFactory::CreateOptionsOK(7).SetServer("RTSP Server/1.0").Build();
+
+    std::string buffer;
+    ASSERT_TRUE(response.WriteTo(buffer) == LegacyToString(response));
+    ASSERT_TRUE(options.WriteTo(buffer) == LegacyToString(options));
+
+    // A reused buffer stops allocating once it is large enough
+    buffer.reserve(1024);
+    const char *storage = buffer.data();
+    response.WriteTo(buffer);
+    ASSERT_TRUE(buffer.data() == storage);
+
+    constexpr int kIterations = 20000;
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        sink += LegacyToString(response).size();
+    }
+    auto legacy = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kIterations; ++i) {
+        sink += response.WriteTo(buffer).size();
+    }
+    auto reused = std::chrono::steady_clock::now() - start;
+
+    auto nsPerOp = [](std::chrono::steady_clock::duration d) {
+        return static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() / kIterations);
+    };
+    printf("\n    ostringstream: %lld ns/response, WriteTo: %lld ns/response (%zu bytes)\n", nsPerOp(legacy),
+           nsPerOp(reused), sink / (2 * kIterations));
+}
+
+void test_rtsp_canned_response_bytes()
+{
+    RTSPResponse options = RTSPResponseFactory::CreateOptionsOK(0).SetServer("RTSP Server/1.0").Build();
+    options.general_header_[CSEQ] = CannedResponse::kCSeqSlot;
+    CannedResponse cannedOptions(options);
+
+    RTSPResponse keepAlive = RTSPResponseFactory::CreateOK(0).Build();
+    keepAlive.general_header_[CSEQ] = CannedResponse::kCSeqSlot;
+    keepAlive.general_header_[SESSION] = CannedResponse::kSessionSlot;
+    CannedResponse cannedKeepAlive(keepAlive);
+
+    // Slot substitution must produce exactly what the builder would, whatever the lengths of the values
+    const std::string sessions[] = {"1", "0123456789abcdef", std::string(64, 'f')};
+    std::string out;
+    for (int cseq : {0, 1, 9, 10, 99, 12345, INT_MAX}) {
+        std::string built = RTSPResponseFactory::CreateOptionsOK(cseq).SetServer("RTSP Server/1.0").Build().ToString();
+        ASSERT_TRUE(cannedOptions.WriteTo(out, cseq) == built);
+        ASSERT_EQ(built.size(), out.size());
+
+        for (const auto &session : sessions) {
+            built = RTSPResponseFactory::CreateOK(cseq).SetSession(session).Build().ToString();
+            ASSERT_TRUE(cannedKeepAlive.WriteTo(out, cseq, session) == built);
+            ASSERT_EQ(built.size(), out.size());
+        }
+    }
+}
+
 int main()
 {
     TestSuite suite("RTSP Response Builder Tests");
@@ -360,6 +468,8 @@ int main()
     suite.AddTest("Round-trip Parsing", test_rtsp_response_roundtrip);
     suite.AddTest("Error Response Parsing", test_rtsp_response_error_parsing);
     suite.AddTest("Malformed Response Parsing", test_rtsp_response_malformed_parsing);
+    suite.AddTest("Serializer Benchmark", test_rtsp_response_serializer_benchmark);
+    suite.AddTest("Canned Response Bytes", test_rtsp_canned_response_bytes);
 
     bool success = suite.RunAll();
     return success ? 0 : 1;
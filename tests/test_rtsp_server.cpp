@@ -0,0 +1,794 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <lmcore/data_buffer.h>
+#include <lmnet/session.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lmrtsp/irtsp_server_callback.h"
+#include "lmrtsp/media_stream.h"
+#include "lmrtsp/media_stream_info.h"
+#include "lmrtsp/rtsp_request.h"
+#include "lmrtsp/rtsp_request_parser.h"
+#include "lmrtsp/rtsp_response.h"
+#include "lmrtsp/rtsp_server.h"
+#include "lmrtsp/rtsp_session.h"
+#include "rtsp/rtsp_server_listener.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+
+// Control connection that keeps everything the server sends
+class FakeSession : public lmshao::lmnet::Session {
+public:
+    explicit FakeSession(int socket = -1)
+    {
+        host = "127.0.0.1";
+        port = 50000;
+        fd = socket;
+    }
+
+    bool Send(std::shared_ptr<lmshao::lmcore::DataBuffer> buffer) const override
+    {
+        return Send(buffer->Data(), buffer->Size());
+    }
+    bool Send(const std::string &str) const override { return Send(str.data(), str.size()); }
+    bool Send(const void *data, size_t size) const override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        replies_.emplace_back(static_cast<const char *>(data), size);
+        return true;
+    }
+    std::string ClientInfo() const override { return host; }
+
+    std::vector<std::string> Replies() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return replies_;
+    }
+    std::string LastReply() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return replies_.empty() ? std::string() : replies_.back();
+    }
+
+private:
+    mutable std::mutex mutex_;
+    mutable std::vector<std::string> replies_;
+};
+
+RTSPRequest ParseRequest(const std::string &text)
+{
+    RTSPRequestParser parser;
+    parser.ParseMessage(text);
+    return parser.ToRequest();
+}
+
+std::string HeaderValue(const std::string &response, const std::string &name)
+{
+    size_t start = response.find("\r\n" + name + ": ");
+    if (start == std::string::npos) {
+        return "";
+    }
+    start += name.size() + 4;
+    return response.substr(start, response.find("\r\n", start) - start);
+}
+
+// Local UDP socket standing in for the client's RTP port
+class UdpReceiver {
+public:
+    UdpReceiver()
+    {
+        fd_ = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+        socklen_t length = sizeof(addr);
+        getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &length);
+        port_ = ntohs(addr.sin_port);
+    }
+    ~UdpReceiver() { close(fd_); }
+
+    uint16_t Port() const { return port_; }
+
+    // Size of the next datagram, 0 if none arrives in time
+    size_t Receive(uint8_t *buffer, size_t size, int timeout_ms)
+    {
+        pollfd pfd{fd_, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0) {
+            return 0;
+        }
+        ssize_t received = recv(fd_, buffer, size, 0);
+        return received > 0 ? static_cast<size_t>(received) : 0;
+    }
+
+private:
+    int fd_ = -1;
+    uint16_t port_ = 0;
+};
+
+std::shared_ptr<lmshao::lmcore::DataBuffer> MakeBuffer(const std::string &text)
+{
+    auto buffer = std::make_shared<lmshao::lmcore::DataBuffer>();
+    buffer->Assign(text.data(), text.size());
+    return buffer;
+}
+
+// True once the other end of a socket pair was shut down
+bool PeerClosed(int fd)
+{
+    char byte;
+    return recv(fd, &byte, 1, MSG_DONTWAIT) == 0;
+}
+
+// Counts keyframe requests that reach the application
+class KeyframeCounter : public IRTSPServerCallback {
+public:
+    void OnClientConnected(const std::string &, const std::string &) override {}
+    void OnClientDisconnected(const std::string &) override {}
+    void OnStreamRequested(const std::string &, const std::string &) override {}
+    void OnSetupReceived(const std::string &, const std::string &, const std::string &) override {}
+    void OnPlayReceived(const std::string &, const std::string &, const std::string &) override {}
+    void OnPauseReceived(const std::string &, const std::string &) override {}
+    void OnTeardownReceived(const std::string &, const std::string &) override {}
+    void OnKeyframeRequested(const std::string &, const std::string &) override { requests++; }
+
+    std::atomic<int> requests{0};
+};
+
+// Defers every SETUP and keeps the continuations
+class SetupDeferrer : public KeyframeCounter {
+public:
+    bool OnRequestDeferred(RTSPMethod method, const std::string &, const std::string &,
+                           std::shared_ptr<RTSPContinuation> continuation) override
+    {
+        if (method != RTSPMethod::SETUP) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        continuations_.push_back(std::move(continuation));
+        condition_.notify_all();
+        return true;
+    }
+
+    // Continuation of the nth deferred SETUP, nullptr if it does not arrive in time
+    std::shared_ptr<RTSPContinuation> Wait(size_t index)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait_for(lock, std::chrono::seconds(2), [&] { return continuations_.size() > index; });
+        return index < continuations_.size() ? continuations_[index] : nullptr;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    std::vector<std::shared_ptr<RTSPContinuation>> continuations_;
+};
+
+std::string SetupSession(RTSPServer &server, const std::shared_ptr<FakeSession> &client, const std::string &path,
+                         uint16_t client_port)
+{
+    server.HandleSessionRequest(client, ParseRequest("SETUP rtsp://127.0.0.1" + path + "/track1 RTSP/1.0\r\n"
+                                                     "CSeq: 1\r\n"
+                                                     "Transport: RTP/AVP;unicast;client_port=" +
+                                                     std::to_string(client_port) + "-" +
+                                                     std::to_string(client_port + 1) + "\r\n\r\n"));
+    std::string sessionId = HeaderValue(client->LastReply(), "Session");
+    return sessionId.substr(0, sessionId.find(';'));
+}
+
+std::shared_ptr<MediaStreamInfo> MakeStream(const std::string &path)
+{
+    auto info = std::make_shared<MediaStreamInfo>();
+    info->stream_path = path;
+    info->media_type = "video";
+    info->codec = "H264";
+    return info;
+}
+
+lmshao::lmrtp::MediaFrame MakeFrame()
+{
+    lmshao::lmrtp::MediaFrame frame;
+    frame.data = {0x00, 0x00, 0x00, 0x01, 0x65, 0x88, 0x84, 0x00, 0x33};
+    frame.timestamp = 3600;
+    frame.marker = true;
+    return frame;
+}
+
+} // namespace
+
+void test_server_push_frame_end_to_end()
+{
+    auto server = RTSPServer::GetInstance();
+    server->AddMediaStream("/e2e", MakeStream("/e2e"));
+    auto client = std::make_shared<FakeSession>();
+    UdpReceiver rtp;
+
+    // Nobody plays the stream yet
+    ASSERT_EQ(0u, server->PushFrame("/e2e", MakeFrame()));
+
+    std::string transport =
+        "RTP/AVP;unicast;client_port=" + std::to_string(rtp.Port()) + "-" + std::to_string(rtp.Port() + 1);
+    server->HandleSessionRequest(client, ParseRequest("SETUP rtsp://127.0.0.1/e2e/track1 RTSP/1.0\r\n"
+                                                      "CSeq: 1\r\n"
+                                                      "Transport: " +
+                                                      transport + "\r\n\r\n"));
+    std::string setup = client->LastReply();
+    ASSERT_STR_CONTAINS(setup, "RTSP/1.0 200 OK");
+    ASSERT_STR_CONTAINS(setup, "server_port=");
+    std::string sessionId = HeaderValue(setup, "Session");
+    sessionId = sessionId.substr(0, sessionId.find(';'));
+    ASSERT_FALSE(sessionId.empty());
+
+    // Set up but not playing: frames are not queued anywhere
+    ASSERT_EQ(0u, server->PushFrame("/e2e", MakeFrame()));
+
+    server->HandleSessionRequest(client, ParseRequest("PLAY rtsp://127.0.0.1/e2e RTSP/1.0\r\n"
+                                                      "CSeq: 2\r\n"
+                                                      "Session: " +
+                                                      sessionId + "\r\n\r\n"));
+    ASSERT_STR_CONTAINS(client->LastReply(), "RTSP/1.0 200 OK");
+
+    // The frame is queued on the session's RTP stream and reaches the client port
+    ASSERT_EQ(1u, server->PushFrame("/e2e", MakeFrame()));
+    uint8_t packet[2048];
+    size_t size = rtp.Receive(packet, sizeof(packet), 2000);
+    ASSERT_TRUE(size > 12);
+    ASSERT_EQ(2, packet[0] >> 6);
+    ASSERT_EQ(96, packet[1] & 0x7F);
+
+    auto session = server->GetSession(sessionId);
+    ASSERT_TRUE(session != nullptr);
+    ASSERT_EQ(1u, session->GetMediaStreams().size());
+    // Counted right after the send returned
+    for (int i = 0; i < 100 && session->GetRTPStatistics().packets_sent == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ASSERT_TRUE(session->GetRTPStatistics().packets_sent > 0);
+
+    server->HandleSessionRequest(client, ParseRequest("TEARDOWN rtsp://127.0.0.1/e2e RTSP/1.0\r\n"
+                                                      "CSeq: 3\r\n"
+                                                      "Session: " +
+                                                      sessionId + "\r\n\r\n"));
+    ASSERT_STR_CONTAINS(client->LastReply(), "RTSP/1.0 200 OK");
+    ASSERT_EQ(0u, server->PushFrame("/e2e", MakeFrame()));
+    server->RemoveSession(sessionId);
+    server->RemoveMediaStream("/e2e");
+}
+
+void test_server_closes_refused_connections()
+{
+    auto server = RTSPServer::GetInstance();
+    AdmissionLimits limits;
+    limits.max_connections = 1;
+    server->SetAdmissionLimits(limits);
+    auto listener = std::make_shared<RTSPServerListener>(server);
+
+    int admittedPair[2];
+    int refusedPair[2];
+    int idlePair[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, admittedPair));
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, refusedPair));
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, idlePair));
+    auto admitted = std::make_shared<FakeSession>(admittedPair[0]);
+    auto refused = std::make_shared<FakeSession>(refusedPair[0]);
+    auto idle = std::make_shared<FakeSession>(idlePair[0]);
+    listener->OnAccept(admitted);
+    listener->OnAccept(refused);
+    listener->OnAccept(idle);
+
+    // The first request of a refused connection is answered 503, then the socket is shut down
+    listener->OnReceive(refused, MakeBuffer("OPTIONS * RTSP/1.0\r\nCSeq: 1\r\n\r\n"));
+    ASSERT_STR_CONTAINS(refused->LastReply(), "RTSP/1.0 503");
+    ASSERT_STR_CONTAINS(refused->LastReply(), "Retry-After: ");
+    ASSERT_TRUE(PeerClosed(refusedPair[1]));
+    listener->OnReceive(refused, MakeBuffer("OPTIONS * RTSP/1.0\r\nCSeq: 2\r\n\r\n"));
+    ASSERT_EQ(1u, refused->Replies().size());
+
+    // A refused connection that stays silent is closed once its deadline passed
+    auto now = std::chrono::steady_clock::now();
+    listener->CloseRefused(now);
+    ASSERT_FALSE(PeerClosed(idlePair[1]));
+    listener->CloseRefused(now + RTSPServerListener::kRefusedGrace + std::chrono::milliseconds(1));
+    ASSERT_TRUE(PeerClosed(idlePair[1]));
+    ASSERT_TRUE(idle->Replies().empty());
+
+    // Admitted connections are left alone
+    listener->OnReceive(admitted, MakeBuffer("OPTIONS * RTSP/1.0\r\nCSeq: 1\r\n\r\n"));
+    ASSERT_STR_CONTAINS(admitted->LastReply(), "RTSP/1.0 200 OK");
+    ASSERT_FALSE(PeerClosed(admittedPair[1]));
+
+    // Once a refused connection closed, its socket number may go to an admitted one that must not be shut down
+    int reusedPair[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, reusedPair));
+    auto stale = std::make_shared<FakeSession>(reusedPair[0]);
+    listener->OnAccept(stale);
+    listener->OnClose(stale);
+    listener->OnClose(admitted);
+    auto fresh = std::make_shared<FakeSession>(reusedPair[0]);
+    listener->OnAccept(fresh);
+    listener->CloseRefused(now + RTSPServerListener::kRefusedGrace + std::chrono::milliseconds(1));
+    ASSERT_FALSE(PeerClosed(reusedPair[1]));
+
+    for (const auto &session : {refused, idle, fresh}) {
+        listener->OnClose(session);
+    }
+    for (int fd : {admittedPair[0], admittedPair[1], refusedPair[0], refusedPair[1], idlePair[0], idlePair[1],
+                   reusedPair[0], reusedPair[1]}) {
+        close(fd);
+    }
+    server->SetAdmissionLimits(AdmissionLimits());
+}
+
+void test_server_keyframe_feedback()
+{
+    auto server = RTSPServer::GetInstance();
+    auto info = MakeStream("/kf");
+    info->ssrc = 0x11223344;
+    info->keyframe_requests = true;
+    server->AddMediaStream("/kf", info);
+    auto callback = std::make_shared<KeyframeCounter>();
+    server->SetCallback(callback);
+    server->SetKeyframeRequestInterval(0);
+
+    std::string sdp = server->GenerateSDP("/kf", "127.0.0.1", 554);
+    ASSERT_STR_CONTAINS(sdp, "a=rtcp-fb:96 nack pli\r\n");
+    ASSERT_STR_CONTAINS(sdp, "a=rtcp-fb:96 ccm fir\r\n");
+
+    auto client = std::make_shared<FakeSession>();
+    UdpReceiver rtp;
+    std::string sessionId = SetupSession(*server, client, "/kf", rtp.Port());
+    auto session = server->GetSession(sessionId);
+    ASSERT_TRUE(session != nullptr);
+    ASSERT_EQ(1u, session->GetMediaStreams().size());
+    auto stream = std::dynamic_pointer_cast<RTPStream>(session->GetMediaStreams()[0]);
+    ASSERT_TRUE(stream != nullptr);
+
+    // Requests for another SSRC are dropped
+    stream->OnPictureLoss(0x5555, 0x99999999);
+    stream->OnFullIntraRequest(0x5555, 0x99999999, 1);
+    ASSERT_EQ(0, callback->requests.load());
+    stream->OnPictureLoss(0x5555, info->ssrc);
+    stream->OnFullIntraRequest(0x5555, info->ssrc, 2);
+    ASSERT_EQ(2, callback->requests.load());
+
+    server->SetCallback(nullptr);
+    server->SetKeyframeRequestInterval(500);
+    server->RemoveSession(sessionId);
+    server->RemoveMediaStream("/kf");
+
+    // By default streams neither take nor advertise keyframe requests
+    info = MakeStream("/kf");
+    server->AddMediaStream("/kf", info);
+    sdp = server->GenerateSDP("/kf", "127.0.0.1", 554);
+    ASSERT_TRUE(sdp.find("a=rtcp-fb:96 nack pli") == std::string::npos);
+    ASSERT_TRUE(sdp.find("a=rtcp-fb:96 ccm fir") == std::string::npos);
+    server->RemoveMediaStream("/kf");
+}
+
+void test_server_nack_retransmission()
+{
+    auto server = RTSPServer::GetInstance();
+    auto info = MakeStream("/rtx");
+    info->ssrc = 0x11223344;
+    info->nack_history_ms = 1000;
+    info->rtx_payload_type = 97;
+    info->rtx_ssrc = 0x55667788;
+    server->AddMediaStream("/rtx", info);
+
+    std::string sdp = server->GenerateSDP("/rtx", "127.0.0.1", 554);
+    ASSERT_STR_CONTAINS(sdp, "a=rtpmap:97 rtx/90000\r\n");
+    ASSERT_STR_CONTAINS(sdp, "a=ssrc-group:FID 287454020 1432778632\r\n");
+
+    auto client = std::make_shared<FakeSession>();
+    UdpReceiver rtp;
+    std::string sessionId = SetupSession(*server, client, "/rtx", rtp.Port());
+    server->HandleSessionRequest(client, ParseRequest("PLAY rtsp://127.0.0.1/rtx RTSP/1.0\r\n"
+                                                      "CSeq: 2\r\n"
+                                                      "Session: " +
+                                                      sessionId + "\r\n\r\n"));
+    ASSERT_EQ(1u, server->PushFrame("/rtx", MakeFrame()));
+    uint8_t packet[2048];
+    ASSERT_TRUE(rtp.Receive(packet, sizeof(packet), 2000) > 12);
+    uint16_t seq = static_cast<uint16_t>((packet[2] << 8) | packet[3]);
+
+    auto session = server->GetSession(sessionId);
+    ASSERT_TRUE(session != nullptr);
+    auto stream = std::dynamic_pointer_cast<RTPStream>(session->GetMediaStreams()[0]);
+    ASSERT_TRUE(stream != nullptr);
+
+    // A NACK for another SSRC leaves the history alone
+    lmshao::lmrtp::RtcpNack nack;
+    nack.sender_ssrc = 0x5555;
+    nack.media_ssrc = 0x99999999;
+    nack.pid = seq;
+    stream->OnNack(nack);
+    ASSERT_EQ(0u, rtp.Receive(packet, sizeof(packet), 100));
+
+    // The packet comes back as RTX with its own payload type and SSRC, the OSN in front of the payload
+    nack.media_ssrc = info->ssrc;
+    stream->OnNack(nack);
+    size_t size = rtp.Receive(packet, sizeof(packet), 2000);
+    ASSERT_TRUE(size > 14);
+    ASSERT_EQ(97, packet[1] & 0x7F);
+    uint32_t ssrc = static_cast<uint32_t>(packet[8]) << 24 | packet[9] << 16 | packet[10] << 8 | packet[11];
+    ASSERT_EQ(info->rtx_ssrc, ssrc);
+    ASSERT_EQ(seq, static_cast<uint16_t>((packet[12] << 8) | packet[13]));
+
+    server->RemoveSession(sessionId);
+    server->RemoveMediaStream("/rtx");
+
+    // Without an RTX SSRC the stream retransmits in band and offers no RTX
+    info = MakeStream("/rtx");
+    info->ssrc = 0x11223344;
+    info->nack_history_ms = 1000;
+    info->rtx_payload_type = 97;
+    server->AddMediaStream("/rtx", info);
+    sdp = server->GenerateSDP("/rtx", "127.0.0.1", 554);
+    ASSERT_STR_CONTAINS(sdp, "a=rtcp-fb:96 nack\r\n");
+    ASSERT_TRUE(sdp.find("rtx/90000") == std::string::npos);
+    ASSERT_TRUE(sdp.find("a=ssrc-group:FID") == std::string::npos);
+    server->RemoveMediaStream("/rtx");
+}
+
+void test_server_request_metrics()
+{
+    auto server = RTSPServer::GetInstance();
+    auto info = MakeStream("/metrics");
+    info->bitrate = 1000000;
+    server->AddMediaStream("/metrics", info);
+    auto &metrics = server->GetRequestMetrics();
+    auto client = std::make_shared<FakeSession>();
+
+    // Keep-alives are dispatched on the parsed view's method id
+    uint64_t options = metrics.Get(RTSPMethod::OPTIONS).count;
+    RTSPRequestParser parser;
+    parser.Parse("OPTIONS * RTSP/1.0\r\nCSeq: 7\r\n\r\n");
+    ASSERT_TRUE(server->HandleKeepAlive(client, parser.Request()));
+    ASSERT_STR_CONTAINS(client->LastReply(), "CSeq: 7\r\n");
+    ASSERT_EQ(options + 1, metrics.Get(RTSPMethod::OPTIONS).count);
+
+    // Not a keep-alive, nothing recorded until the full path handles it
+    uint64_t describes = metrics.Get(RTSPMethod::DESCRIBE).count;
+    parser.Reset();
+    parser.Parse("DESCRIBE rtsp://127.0.0.1/metrics RTSP/1.0\r\nCSeq: 8\r\n\r\n");
+    ASSERT_FALSE(server->HandleKeepAlive(client, parser.Request()));
+    ASSERT_EQ(describes, metrics.Get(RTSPMethod::DESCRIBE).count);
+    server->HandleStatelessRequest(client, parser.ToRequest());
+    ASSERT_STR_CONTAINS(client->LastReply(), "m=video ");
+    ASSERT_EQ(describes + 1, metrics.Get(RTSPMethod::DESCRIBE).count);
+
+    // A refused PLAY is recorded exactly once
+    UdpReceiver rtp;
+    std::string sessionId = SetupSession(*server, client, "/metrics", rtp.Port());
+    server->SetEgressCapacity(1000);
+    uint64_t plays = metrics.Get(RTSPMethod::PLAY).count;
+    server->HandleSessionRequest(client, ParseRequest("PLAY rtsp://127.0.0.1/metrics RTSP/1.0\r\n"
+                                                      "CSeq: 9\r\n"
+                                                      "Session: " +
+                                                      sessionId + "\r\n\r\n"));
+    ASSERT_STR_CONTAINS(client->LastReply(), "RTSP/1.0 453");
+    ASSERT_EQ(plays + 1, metrics.Get(RTSPMethod::PLAY).count);
+
+    server->SetEgressCapacity(0);
+    server->RemoveSession(sessionId);
+    server->RemoveMediaStream("/metrics");
+}
+
+void test_server_multicast_group()
+{
+    auto server = RTSPServer::GetInstance();
+    TransportSupport support;
+    support.multicast = true;
+    server->SetTransportSupport(support);
+    auto client = std::make_shared<FakeSession>();
+    const std::string setup = "SETUP rtsp://127.0.0.1/mc/track1 RTSP/1.0\r\n"
+                              "CSeq: 1\r\n"
+                              "Transport: RTP/AVP;multicast;destination=10.0.0.66;port=9000-9001;ttl=127\r\n\r\n";
+
+    // A stream without a configured group is not offered over multicast
+    server->AddMediaStream("/mc", MakeStream("/mc"));
+    server->HandleSessionRequest(client, ParseRequest(setup));
+    ASSERT_TRUE(client->LastReply().find("RTSP/1.0 200 OK") == std::string::npos);
+
+    // The client's destination, port and ttl are replaced by the stream's group
+    auto info = MakeStream("/mc");
+    info->multicast_ip = "239.9.9.9";
+    info->rtp_port = 7000;
+    info->ttl = 8;
+    server->AddMediaStream("/mc", info);
+    server->HandleSessionRequest(client, ParseRequest(setup));
+    std::string reply = client->LastReply();
+    ASSERT_STR_CONTAINS(reply, "RTSP/1.0 200 OK");
+    ASSERT_STR_CONTAINS(reply, "Transport: RTP/AVP;multicast;destination=239.9.9.9;port=7000-7001;ttl=8");
+    ASSERT_TRUE(reply.find("10.0.0.66") == std::string::npos);
+
+    std::string sessionId = HeaderValue(reply, "Session");
+    server->RemoveSession(sessionId.substr(0, sessionId.find(';')));
+    server->RemoveMediaStream("/mc");
+    server->SetTransportSupport(TransportSupport());
+}
+
+void test_server_sdp_invalidation()
+{
+    auto server = RTSPServer::GetInstance();
+    auto info = MakeStream("/sdp");
+    server->AddMediaStream("/sdp", info);
+    std::string sdp = server->GenerateSDP("/sdp", "10.0.0.1", 554);
+    ASSERT_STR_CONTAINS(sdp, "m=video 554 RTP/AVP 96\r\n");
+    ASSERT_STR_CONTAINS(sdp, "a=rtpmap:96 H264/90000\r\n");
+
+    // Replacing the stream renders the new description
+    auto replacement = MakeStream("/sdp");
+    replacement->codec = "H265";
+    server->AddMediaStream("/sdp", replacement);
+    sdp = server->GenerateSDP("/sdp", "10.0.0.1", 554);
+    ASSERT_STR_CONTAINS(sdp, "a=rtpmap:96 H265/90000\r\n");
+    ASSERT_TRUE(sdp.find("H264") == std::string::npos);
+
+    // A different server port re-renders the media line
+    sdp = server->GenerateSDP("/sdp", "10.0.0.1", 8554);
+    ASSERT_STR_CONTAINS(sdp, "m=video 8554 RTP/AVP 96\r\n");
+    ASSERT_TRUE(sdp.find("m=video 554 ") == std::string::npos);
+
+    // Changes made in place show up only after an explicit invalidation
+    replacement->codec = "MP4V-ES";
+    ASSERT_STR_CONTAINS(server->GenerateSDP("/sdp", "10.0.0.1", 8554), "a=rtpmap:96 H265/90000\r\n");
+    server->InvalidateSDP("/sdp");
+    sdp = server->GenerateSDP("/sdp", "10.0.0.1", 8554);
+    ASSERT_STR_CONTAINS(sdp, "a=rtpmap:96 MP4V-ES/90000\r\n");
+    ASSERT_TRUE(sdp.find("H265") == std::string::npos);
+
+    // A removed stream has no description, registering it again starts from the new info
+    server->RemoveMediaStream("/sdp");
+    ASSERT_TRUE(server->GenerateSDP("/sdp", "10.0.0.1", 8554).empty());
+    auto audio = MakeStream("/sdp");
+    audio->media_type = "audio";
+    audio->codec = "MPEG4-GENERIC";
+    audio->sample_rate = 48000;
+    server->AddMediaStream("/sdp", audio);
+    sdp = server->GenerateSDP("/sdp", "10.0.0.1", 8554);
+    ASSERT_STR_CONTAINS(sdp, "m=audio 8554 RTP/AVP 97\r\n");
+    ASSERT_STR_CONTAINS(sdp, "a=rtpmap:97 MPEG4-GENERIC/48000\r\n");
+    ASSERT_TRUE(sdp.find("m=video") == std::string::npos);
+
+    // Origin, connection and control lines follow each request around the cached media section
+    std::string first = server->GenerateSDP("rtsp://10.0.0.1/sdp", "10.0.0.1", 8554);
+    std::string second = server->GenerateSDP("rtsp://192.168.1.20/sdp", "192.168.1.20", 8554);
+    ASSERT_STR_CONTAINS(first, "o=- 0 0 IN IP4 10.0.0.1\r\n");
+    ASSERT_STR_CONTAINS(first, "c=IN IP4 10.0.0.1\r\n");
+    ASSERT_STR_CONTAINS(first, "a=control:rtsp://10.0.0.1/sdp\r\n");
+    ASSERT_STR_CONTAINS(second, "o=- 0 0 IN IP4 192.168.1.20\r\n");
+    ASSERT_STR_CONTAINS(second, "c=IN IP4 192.168.1.20\r\n");
+    ASSERT_STR_CONTAINS(second, "a=control:rtsp://192.168.1.20/sdp\r\n");
+    ASSERT_TRUE(first.find("192.168.1.20") == std::string::npos);
+    size_t media = first.find("t=0 0\r\n");
+    ASSERT_TRUE(media != std::string::npos);
+    std::string section = first.substr(media, first.find("a=control:") - media);
+    ASSERT_STR_CONTAINS(second, section);
+
+    server->RemoveMediaStream("/sdp");
+}
+
+void test_server_keep_alive_bytes()
+{
+    auto server = RTSPServer::GetInstance();
+    auto client = std::make_shared<FakeSession>();
+    UdpReceiver rtp;
+    server->AddMediaStream("/ka", MakeStream("/ka"));
+    std::string sessionId = SetupSession(*server, client, "/ka", rtp.Port());
+    ASSERT_FALSE(sessionId.empty());
+
+    RTSPRequestParser parser;
+    for (int cseq : {1, 42, 1000, 2147483647}) {
+        std::string cseqText = std::to_string(cseq);
+        parser.Reset();
+        parser.Parse("OPTIONS * RTSP/1.0\r\nCSeq: " + cseqText + "\r\n\r\n");
+        ASSERT_TRUE(server->HandleKeepAlive(client, parser.Request()));
+        ASSERT_TRUE(client->LastReply() ==
+                    RTSPResponseFactory::CreateOptionsOK(cseq).SetServer("RTSP Server/1.0").Build().ToString());
+
+        // The Session header of the request may carry a timeout, the reply echoes the id only
+        parser.Reset();
+        parser.Parse("GET_PARAMETER rtsp://127.0.0.1/ka RTSP/1.0\r\nCSeq: " + cseqText + "\r\nSession: " +
+                     sessionId + ";timeout=60\r\n\r\n");
+        ASSERT_TRUE(server->HandleKeepAlive(client, parser.Request()));
+        std::string built = RTSPResponseFactory::CreateOK(cseq).SetSession(sessionId).Build().ToString();
+        ASSERT_TRUE(client->LastReply() == built);
+    }
+
+    server->RemoveSession(sessionId);
+    server->RemoveMediaStream("/ka");
+}
+
+void test_server_reactor_ordering()
+{
+    auto server = RTSPServer::GetInstance();
+    server->AddMediaStream("/order", MakeStream("/order"));
+    auto listener = std::make_shared<RTSPServerListener>(server, 3);
+    listener->Start();
+
+    // Two connections on different reactors, each sending pipelined requests cut at arbitrary byte boundaries
+    constexpr int kRequests = 200;
+    std::vector<std::shared_ptr<FakeSession>> clients = {std::make_shared<FakeSession>(1000),
+                                                         std::make_shared<FakeSession>(1001)};
+    std::vector<std::string> streams(clients.size());
+    for (auto &stream : streams) {
+        for (int cseq = 1; cseq <= kRequests; ++cseq) {
+            stream += "OPTIONS * RTSP/1.0\r\nCSeq: " + std::to_string(cseq) + "\r\n\r\n";
+        }
+    }
+    for (const auto &client : clients) {
+        listener->OnAccept(client);
+    }
+    std::vector<size_t> offsets(clients.size(), 0);
+    size_t chunk = 7;
+    for (; offsets[0] < streams[0].size() || offsets[1] < streams[1].size(); chunk = chunk * 5 % 97 + 1) {
+        for (size_t i = 0; i < clients.size(); ++i) {
+            size_t size = std::min(chunk, streams[i].size() - offsets[i]);
+            if (size > 0) {
+                listener->OnReceive(clients[i], MakeBuffer(streams[i].substr(offsets[i], size)));
+                offsets[i] += size;
+            }
+        }
+    }
+
+    // A close queued behind pending requests runs after them: the session created by the SETUP is removed
+    UdpReceiver rtp;
+    auto closing = std::make_shared<FakeSession>(1002);
+    listener->OnAccept(closing);
+    std::string pending;
+    for (int cseq = 1; cseq <= 50; ++cseq) {
+        pending += "OPTIONS * RTSP/1.0\r\nCSeq: " + std::to_string(cseq) + "\r\n\r\n";
+    }
+    pending += "SETUP rtsp://127.0.0.1/order/track1 RTSP/1.0\r\nCSeq: 51\r\nTransport: RTP/AVP;unicast;client_port=" +
+               std::to_string(rtp.Port()) + "-" + std::to_string(rtp.Port() + 1) + "\r\n\r\n";
+    listener->OnReceive(closing, MakeBuffer(pending));
+    listener->OnClose(closing);
+
+    listener->Stop();
+    for (const auto &client : clients) {
+        auto replies = client->Replies();
+        ASSERT_EQ(static_cast<size_t>(kRequests), replies.size());
+        for (int cseq = 1; cseq <= kRequests; ++cseq) {
+            ASSERT_TRUE(HeaderValue(replies[cseq - 1], "CSeq") == std::to_string(cseq));
+        }
+        listener->OnClose(client);
+    }
+
+    auto replies = closing->Replies();
+    ASSERT_EQ(51u, replies.size());
+    ASSERT_TRUE(HeaderValue(replies.back(), "CSeq") == "51");
+    ASSERT_STR_CONTAINS(replies.back(), "RTSP/1.0 200 OK");
+    std::string sessionId = HeaderValue(replies.back(), "Session");
+    sessionId = sessionId.substr(0, sessionId.find(';'));
+    ASSERT_FALSE(sessionId.empty());
+    ASSERT_TRUE(server->GetSession(sessionId) == nullptr);
+
+    server->RemoveMediaStream("/order");
+}
+
+void test_server_deferred_request_resume()
+{
+    auto server = RTSPServer::GetInstance();
+    server->AddMediaStream("/defer", MakeStream("/defer"));
+    auto callback = std::make_shared<SetupDeferrer>();
+    server->SetCallback(callback);
+    auto listener = std::make_shared<RTSPServerListener>(server, 1);
+    listener->Start();
+
+    UdpReceiver rtp;
+    std::string setup = "SETUP rtsp://127.0.0.1/defer/track1 RTSP/1.0\r\nCSeq: 1\r\n"
+                        "Transport: RTP/AVP;unicast;client_port=" +
+                        std::to_string(rtp.Port()) + "-" + std::to_string(rtp.Port() + 1) + "\r\n\r\n";
+    size_t sessions = server->GetClientCount();
+
+    // Resumed after the connection closed and its socket went to another client: nobody gets a session
+    auto closed = std::make_shared<FakeSession>(1003);
+    listener->OnAccept(closed);
+    listener->OnReceive(closed, MakeBuffer(setup));
+    auto continuation = callback->Wait(0);
+    ASSERT_TRUE(continuation != nullptr);
+    listener->OnClose(closed);
+    auto reused = std::make_shared<FakeSession>(1003);
+    listener->OnAccept(reused);
+    listener->OnReceive(reused, MakeBuffer("OPTIONS * RTSP/1.0\r\nCSeq: 1\r\n\r\n"));
+    continuation->Resume();
+
+    // Resumed from another thread while the connection is open: answered after the requests before it
+    auto open = std::make_shared<FakeSession>(1004);
+    listener->OnAccept(open);
+    listener->OnReceive(open, MakeBuffer(setup + "OPTIONS * RTSP/1.0\r\nCSeq: 2\r\n\r\n"));
+    continuation = callback->Wait(1);
+    ASSERT_TRUE(continuation != nullptr);
+    std::thread([continuation] { continuation->Resume(); }).join();
+
+    listener->Stop();
+    ASSERT_TRUE(closed->Replies().empty());
+    ASSERT_EQ(1u, reused->Replies().size());
+    ASSERT_EQ(sessions + 1, server->GetClientCount());
+    auto replies = open->Replies();
+    ASSERT_EQ(2u, replies.size());
+    ASSERT_TRUE(HeaderValue(replies[0], "CSeq") == "2");
+    ASSERT_TRUE(HeaderValue(replies[1], "CSeq") == "1");
+    ASSERT_STR_CONTAINS(replies[1], "RTSP/1.0 200 OK");
+
+    listener->OnClose(reused);
+    listener->OnClose(open);
+    ASSERT_EQ(sessions, server->GetClientCount());
+    server->SetCallback(nullptr);
+    server->RemoveMediaStream("/defer");
+}
+
+void test_server_session_timeout_capped()
+{
+    auto server = RTSPServer::GetInstance();
+    server->AddMediaStream("/timeout", MakeStream("/timeout"));
+    server->SetSessionTimeout(30);
+    auto client = std::make_shared<FakeSession>();
+    UdpReceiver rtp;
+    std::string sessionId = SetupSession(*server, client, "/timeout", rtp.Port());
+    auto session = server->GetSession(sessionId);
+    ASSERT_TRUE(session != nullptr);
+    ASSERT_EQ(30u, session->GetTimeout());
+
+    // A client may shorten its timeout but not hold the session longer than the server allows
+    auto request = [&](uint32_t timeout) {
+        return ParseRequest("OPTIONS rtsp://127.0.0.1/timeout RTSP/1.0\r\nCSeq: 2\r\nSession: " + sessionId +
+                            ";timeout=" + std::to_string(timeout) + "\r\n\r\n");
+    };
+    session->ProcessRequest(request(3600));
+    ASSERT_EQ(30u, session->GetTimeout());
+    session->ProcessRequest(request(20));
+    ASSERT_EQ(20u, session->GetTimeout());
+    session->ProcessRequest(request(25));
+    ASSERT_EQ(25u, session->GetTimeout());
+
+    server->SetSessionTimeout(RTSPSession::kDefaultTimeout);
+    server->RemoveSession(sessionId);
+    server->RemoveMediaStream("/timeout");
+}
+
+int main()
+{
+    TestSuite suite("RTSP Server Tests");
+
+    suite.AddTest("Push Frame End To End", test_server_push_frame_end_to_end);
+    suite.AddTest("Closes Refused Connections", test_server_closes_refused_connections);
+    suite.AddTest("Keyframe Feedback", test_server_keyframe_feedback);
+    suite.AddTest("NACK Retransmission", test_server_nack_retransmission);
+    suite.AddTest("Request Metrics", test_server_request_metrics);
+    suite.AddTest("Multicast Group", test_server_multicast_group);
+    suite.AddTest("SDP Invalidation", test_server_sdp_invalidation);
+    suite.AddTest("Keep-Alive Bytes", test_server_keep_alive_bytes);
+    suite.AddTest("Reactor Ordering", test_server_reactor_ordering);
+    suite.AddTest("Deferred Request Resume", test_server_deferred_request_resume);
+    suite.AddTest("Session Timeout Capped", test_server_session_timeout_capped);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
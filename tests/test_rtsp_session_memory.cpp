@@ -0,0 +1,118 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "lmrtsp/media_stream_registry.h"
+#include "lmrtsp/rtsp_session.h"
+#include "lmrtsp/session_id.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+// Count every heap byte the library asks for
+static std::atomic<size_t> g_allocated{0};
+
+void *operator new(size_t size)
+{
+    g_allocated.fetch_add(size, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+constexpr size_t kSessions = 1000;
+// Heap budget of a session that has not described or set up any media yet
+constexpr size_t kIdleSessionBudget = 256;
+
+void test_idle_session_footprint()
+{
+    std::vector<std::shared_ptr<RTSPSession>> sessions;
+    sessions.reserve(kSessions);
+
+    size_t before = g_allocated.load();
+    for (size_t i = 0; i < kSessions; ++i) {
+        sessions.push_back(std::make_shared<RTSPSession>(nullptr));
+    }
+    size_t perSession = (g_allocated.load() - before) / kSessions;
+
+    std::printf("  idle RTSPSession: %zu bytes heap, %zu bytes object\n", perSession, sizeof(RTSPSession));
+    ASSERT_TRUE(perSession <= kIdleSessionBudget);
+}
+
+void test_media_state_on_demand()
+{
+    auto session = std::make_shared<RTSPSession>(nullptr);
+    ASSERT_TRUE(session->GetMediaStreams().empty());
+    ASSERT_TRUE(session->GetTransportInfo().empty());
+    ASSERT_FALSE(session->HasValidTransport());
+    ASSERT_TRUE(session->GetMediaStreamInfo() == nullptr);
+
+    size_t before = g_allocated.load();
+    session->SetTransportInfo("RTP/AVP;unicast;client_port=5000-5001");
+    ASSERT_TRUE(g_allocated.load() > before);
+    ASSERT_TRUE(session->GetTransportInfo() == "RTP/AVP;unicast;client_port=5000-5001");
+}
+
+void test_session_key_matches_id()
+{
+    auto session = std::make_shared<RTSPSession>(nullptr);
+    uint64_t key = 0;
+    ASSERT_TRUE(SessionId::Parse(session->GetSessionId(), key));
+    ASSERT_EQ(session->GetSessionKey(), key);
+}
+
+void test_stream_path_interned()
+{
+    MediaStreamRegistry registry;
+    registry.Add("/live", std::make_shared<MediaStreamInfo>());
+    auto entry = registry.Find("/live");
+    ASSERT_TRUE(entry != nullptr);
+    ASSERT_TRUE(*entry->path == "/live");
+
+    // Sessions hold the registry's copy of the path
+    auto session = std::make_shared<RTSPSession>(nullptr);
+    long owners = entry->path.use_count();
+    session->SetStreamPath(entry->path);
+    ASSERT_EQ(entry->path.use_count(), owners + 1);
+    ASSERT_TRUE(session->GetStreamPath() == "/live");
+
+    // Re-registering the stream keeps the interned path
+    registry.Add("/live", std::make_shared<MediaStreamInfo>());
+    ASSERT_TRUE(registry.Find("/live")->path == entry->path);
+}
+
+int main()
+{
+    TestSuite suite("RTSP Session Memory Tests");
+
+    suite.AddTest("Idle Session Footprint", test_idle_session_footprint);
+    suite.AddTest("Media State On Demand", test_media_state_on_demand);
+    suite.AddTest("Session Key Matches Id", test_session_key_matches_id);
+    suite.AddTest("Stream Path Interned", test_stream_path_interned);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lmrtsp/rtsp_session.h"
+#include "rtsp/rtsp_session_table.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+namespace {
+
+std::shared_ptr<RTSPSession> MakeSession()
+{
+    return std::make_shared<RTSPSession>(nullptr);
+}
+
+} // namespace
+
+void test_session_table_insert_find_remove()
+{
+    RTSPSessionTable table;
+    auto session = MakeSession();
+    table.Insert(42, session, 7, "10.0.0.1");
+
+    ASSERT_TRUE(table.Find(42) == session);
+    ASSERT_TRUE(table.Find(43) == nullptr);
+    ASSERT_EQ(1u, table.Size());
+
+    // TryInsert never displaces a stored session
+    ASSERT_FALSE(table.TryInsert(42, MakeSession(), 8, "10.0.0.2"));
+    ASSERT_TRUE(table.Find(42) == session);
+    ASSERT_TRUE(table.RemoveConnection(8).empty());
+    ASSERT_EQ(1u, table.Size());
+
+    ASSERT_TRUE(table.Remove(42) == session);
+    ASSERT_TRUE(table.Remove(42) == nullptr);
+    ASSERT_EQ(0u, table.Size());
+    ASSERT_TRUE(table.RemoveConnection(7).empty());
+    ASSERT_TRUE(table.Clients().empty());
+}
+
+void test_session_table_indexes()
+{
+    RTSPSessionTable table;
+    table.Insert(1, MakeSession(), 10, "10.0.0.1");
+    table.Insert(2, MakeSession(), 10, "10.0.0.1");
+    table.Insert(3, MakeSession(), 11, "10.0.0.1");
+    table.Insert(4, MakeSession(), 12, "10.0.0.2");
+    ASSERT_EQ(4u, table.Clients().size());
+    ASSERT_EQ(3u, table.CountClient("10.0.0.1"));
+    ASSERT_EQ(0u, table.CountClient("10.0.0.9"));
+
+    // Closing a connection removes only its sessions
+    ASSERT_EQ(2u, table.RemoveConnection(10).size());
+    ASSERT_EQ(1u, table.CountClient("10.0.0.1"));
+    ASSERT_TRUE(table.Find(1) == nullptr);
+    ASSERT_TRUE(table.Find(3) != nullptr);
+
+    // Disconnecting a client covers all of its connections
+    ASSERT_EQ(1u, table.RemoveClient("10.0.0.1").size());
+    ASSERT_TRUE(table.RemoveClient("10.0.0.1").empty());
+    ASSERT_EQ(1u, table.Size());
+
+    // Re-inserting an id moves it to the new connection
+    table.Insert(4, MakeSession(), 13, "10.0.0.3");
+    ASSERT_TRUE(table.RemoveConnection(12).empty());
+    ASSERT_EQ(1u, table.RemoveConnection(13).size());
+
+    table.Insert(5, MakeSession(), 14, "10.0.0.4");
+    table.Clear();
+    ASSERT_EQ(0u, table.Size());
+    ASSERT_TRUE(table.RemoveClient("10.0.0.4").empty());
+}
+
+void test_session_table_concurrent()
+{
+    RTSPSessionTable table;
+    const int threads = 4;
+    const int perThread = 500;
+    auto session = MakeSession();
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < perThread; ++i) {
+                uint64_t id = static_cast<uint64_t>(t) * perThread + i;
+                table.Insert(id, session, t, "10.0.0." + std::to_string(t));
+                if (i % 2 == 0) {
+                    table.Remove(id);
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    ASSERT_EQ(static_cast<size_t>(threads * perThread / 2), table.Size());
+    size_t visited = 0;
+    table.ForEach([&](uint64_t id, const std::shared_ptr<RTSPSession> &) {
+        ASSERT_EQ(1u, id % 2);
+        ++visited;
+    });
+    ASSERT_EQ(table.Size(), visited);
+    ASSERT_EQ(static_cast<size_t>(perThread / 2), table.RemoveConnection(0).size());
+}
+
+void test_session_table_remove_racing_insert()
+{
+    RTSPSessionTable table;
+    const int pairs = 4;
+    const uint64_t perPair = 2000;
+    auto session = MakeSession();
+
+    // Each id is removed as soon as it shows up, possibly while its insert is still in progress
+    std::vector<std::thread> workers;
+    for (int p = 0; p < pairs; ++p) {
+        uint64_t first = p * perPair + 1;
+        workers.emplace_back([&, first] {
+            for (uint64_t id = first; id < first + perPair; ++id) {
+                table.TryInsert(id, session, 5, "10.0.0.5");
+            }
+        });
+        workers.emplace_back([&, first] {
+            for (uint64_t id = first; id < first + perPair; ++id) {
+                while (!table.Remove(id)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+
+    // No id is left behind in the indexes, where it would count against the client's session limit
+    ASSERT_EQ(0u, table.Size());
+    ASSERT_EQ(0u, table.CountClient("10.0.0.5"));
+    ASSERT_TRUE(table.Clients().empty());
+    ASSERT_TRUE(table.RemoveConnection(5).empty());
+}
+
+int main()
+{
+    TestSuite suite("RTSP Session Table Tests");
+
+    suite.AddTest("Insert Find Remove", test_session_table_insert_find_remove);
+    suite.AddTest("Connection And Client Indexes", test_session_table_indexes);
+    suite.AddTest("Concurrent Updates", test_session_table_concurrent);
+    suite.AddTest("Remove Racing Insert", test_session_table_remove_racing_insert);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
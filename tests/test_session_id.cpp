@@ -0,0 +1,111 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "lmrtsp/session_id.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+void test_session_id_format()
+{
+    ASSERT_TRUE(SessionId::Format(1) == "0000000000000001");
+    ASSERT_TRUE(SessionId::Format(0x0123456789abcdefULL) == "0123456789abcdef");
+    ASSERT_TRUE(SessionId::Format(UINT64_MAX) == "ffffffffffffffff");
+
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQ(SessionId::kLength, SessionId::Format(SessionId::Generate()).size());
+    }
+}
+
+void test_session_id_parse()
+{
+    uint64_t key = 0;
+    ASSERT_TRUE(SessionId::Parse("0123456789abcdef", key));
+    ASSERT_EQ(0x0123456789abcdefULL, key);
+    ASSERT_TRUE(SessionId::Parse("FFFFFFFFFFFFFFFF", key));
+    ASSERT_EQ(UINT64_MAX, key);
+
+    key = 7;
+    ASSERT_FALSE(SessionId::Parse("", key));
+    ASSERT_FALSE(SessionId::Parse("123456", key));
+    ASSERT_FALSE(SessionId::Parse("0123456789abcdef0", key));
+    ASSERT_FALSE(SessionId::Parse("0123456789abcdeg", key));
+    ASSERT_FALSE(SessionId::Parse("0000000000000000", key));
+    ASSERT_EQ(7u, key);
+
+    for (int i = 0; i < 100; ++i) {
+        uint64_t generated = SessionId::Generate();
+        ASSERT_TRUE(SessionId::Parse(SessionId::Format(generated), key));
+        ASSERT_EQ(generated, key);
+    }
+}
+
+void test_session_id_unique_across_threads()
+{
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 50000;
+
+    std::mutex mutex;
+    std::unordered_set<uint64_t> seen;
+    size_t duplicates = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&] {
+            std::vector<uint64_t> keys;
+            keys.reserve(kPerThread);
+            for (int i = 0; i < kPerThread; ++i) {
+                keys.push_back(SessionId::Generate());
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            for (uint64_t key : keys) {
+                duplicates += key == 0 || !seen.insert(key).second;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    ASSERT_EQ(0u, duplicates);
+    ASSERT_EQ(static_cast<size_t>(kThreads * kPerThread), seen.size());
+}
+
+void test_session_id_bits_balanced()
+{
+    // Every bit of the key is set in roughly half of the draws
+    constexpr int kDraws = 20000;
+    int ones[64] = {};
+    for (int i = 0; i < kDraws; ++i) {
+        uint64_t key = SessionId::Generate();
+        for (int bit = 0; bit < 64; ++bit) {
+            ones[bit] += (key >> bit) & 1;
+        }
+    }
+    for (int bit = 0; bit < 64; ++bit) {
+        ASSERT_TRUE(ones[bit] > kDraws * 45 / 100 && ones[bit] < kDraws * 55 / 100);
+    }
+}
+
+int main()
+{
+    TestSuite suite("Session Id Tests");
+
+    suite.AddTest("Format", test_session_id_format);
+    suite.AddTest("Parse", test_session_id_parse);
+    suite.AddTest("Unique Across Threads", test_session_id_unique_across_threads);
+    suite.AddTest("Bits Balanced", test_session_id_bits_balanced);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+/**
+ * @author SHAO Liming <lmshao@163.com>
+ * @copyright Copyright (c) 2025 SHAO Liming
+ * @license MIT
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "rtsp/timer_wheel.h"
+#include "test_framework.h"
+
+using namespace test_framework;
+using namespace lmshao::lmrtsp;
+
+void test_timer_wheel_near_deadlines()
+{
+    TimerWheel wheel(1000);
+    wheel.Schedule(1, 1005);
+    wheel.Schedule(2, 1005);
+    wheel.Schedule(3, 1010);
+    wheel.Schedule(4, 900); // Already passed
+    ASSERT_EQ(4u, wheel.Size());
+
+    std::vector<uint64_t> expired;
+    wheel.Advance(1001, expired);
+    ASSERT_EQ(1u, expired.size());
+    ASSERT_EQ(4u, expired[0]);
+
+    expired.clear();
+    wheel.Advance(1004, expired);
+    ASSERT_TRUE(expired.empty());
+    wheel.Advance(1005, expired);
+    ASSERT_EQ(2u, expired.size());
+
+    expired.clear();
+    wheel.Advance(2000, expired);
+    ASSERT_EQ(1u, expired.size());
+    ASSERT_EQ(3u, expired[0]);
+    ASSERT_EQ(0u, wheel.Size());
+}
+
+void test_timer_wheel_cascade()
+{
+    // Deadlines on every level, each must fire exactly on its tick
+    const uint64_t start = 123456;
+    const std::vector<uint64_t> delays = {1, 63, 64, 65, 100, 4095, 4096, 4097, 70000, 262143, 300000};
+    TimerWheel wheel(start);
+    for (size_t i = 0; i < delays.size(); ++i) {
+        wheel.Schedule(i, start + delays[i]);
+    }
+
+    std::vector<uint64_t> expired;
+    for (size_t i = 0; i < delays.size(); ++i) {
+        wheel.Advance(start + delays[i] - 1, expired);
+        ASSERT_TRUE(expired.empty());
+        wheel.Advance(start + delays[i], expired);
+        ASSERT_EQ(1u, expired.size());
+        ASSERT_EQ(i, expired[0]);
+        expired.clear();
+    }
+    ASSERT_EQ(0u, wheel.Size());
+}
+
+void test_timer_wheel_jumps_and_reset()
+{
+    TimerWheel wheel(0);
+    std::vector<uint64_t> expired;
+
+    // An empty wheel moves to any time at once
+    wheel.Advance(1ULL << 40, expired);
+    ASSERT_EQ(1ULL << 40, wheel.Now());
+
+    // Deadlines beyond the wheel range are clamped, the owner re-schedules them when they fire
+    wheel.Schedule(7, wheel.Now() + TimerWheel::kMaxDelay + 1000);
+    wheel.Advance(wheel.Now() + TimerWheel::kMaxDelay, expired);
+    ASSERT_EQ(1u, expired.size());
+
+    wheel.Schedule(8, wheel.Now() + 10);
+    wheel.Reset(5);
+    ASSERT_EQ(0u, wheel.Size());
+    ASSERT_EQ(5u, wheel.Now());
+}
+
+int main()
+{
+    TestSuite suite("Timer Wheel Tests");
+
+    suite.AddTest("Near Deadlines", test_timer_wheel_near_deadlines);
+    suite.AddTest("Cascading Levels", test_timer_wheel_cascade);
+    suite.AddTest("Jumps And Reset", test_timer_wheel_jumps_and_reset);
+
+    bool success = suite.RunAll();
+    return success ? 0 : 1;
+}